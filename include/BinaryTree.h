@@ -85,6 +85,7 @@ struct Node {
     NodeData     data;
     Node*        left;
     Node*       right;
+    int          line; ///< line of the program text (tokens and statements, 0 if it is unknown)
 };
 
 /// @brief Structure binary tree
@@ -0,0 +1,69 @@
+/*!
+    \file
+    File with the SPU bytecode emitter (IR with allocated registers -> SPU commands in memory)
+*/
+
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include <stdio.h>
+
+#include "IR.h"
+#include "RegAlloc.h"
+#include "Executable.h"
+
+/// @brief Enum with return codes of the code generator
+enum CodeGenReturnCode {
+    CODEGEN_SUCCESS      =  0,
+    CODEGEN_MEMORY_ERROR = -1,
+    CODEGEN_LABEL_ERROR  = -2,
+    CODEGEN_SIZE_ERROR   = -3,
+    CODEGEN_VALUE_ERROR  = -4,
+};
+
+/// @brief Structure with SPU bytecode
+struct Bytecode {
+    int*                   code;
+    size_t                 size;
+    size_t             capacity;
+    SpuExeSymbol*       symbols; ///< address of every function
+    size_t        symbols_count;
+    SpuExeLine*           lines; ///< line of the program text of every statement
+    size_t          lines_count;
+    size_t       lines_capacity;
+};
+
+/*!
+    @brief Function that emits SPU bytecode for the module (the entry function goes first, its return halts)
+    \param  [in]   module - pointer on the module in the out of SSA form
+    \param  [in]   allocs - allocations of the module functions
+    \param [out] bytecode - pointer on the bytecode (it is freed with BytecodeDtor)
+    @return The status of the function (return code)
+*/
+CodeGenReturnCode CodeGenModule(const IRModule* module, RegAllocation* const* allocs, Bytecode* bytecode);
+
+/*!
+    @brief Function that frees the bytecode memory
+    \param [out] bytecode - pointer on the bytecode
+*/
+void BytecodeDtor(Bytecode* bytecode);
+
+/*!
+    @brief Function that loads the bytecode into a new SPU and runs it
+    \param [in] bytecode - pointer on the bytecode
+    \param [in]  use_jit - 1 to run the native code of the JIT (CPUWork is used if it can not compile the code)
+    \param [in]   config - memory parameters of the SPU (NULL for the defaults)
+    @return The status of the function (return code)
+*/
+CodeGenReturnCode RunBytecode(const Bytecode* bytecode, int use_jit, const SpuConfig* config);
+
+/*!
+    @brief Function that writes the bytecode as the SPU executable (the entry is the address 0)
+    \param [in] bytecode - pointer on the bytecode
+    \param [in] filename - name of the file
+    \param [in] ram_size - size of RAM in words written to the header (0 for the default size)
+    @return The status of the function (return code)
+*/
+SpuExeReturnCode WriteBytecode(const Bytecode* bytecode, const char* filename, size_t ram_size);
+
+#endif // CODEGEN_H
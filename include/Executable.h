@@ -0,0 +1,132 @@
+/*!
+    \file
+    File with the binary SPU executable: header, code, initial RAM and symbols, loaded by mmap and run in place
+*/
+
+#ifndef EXECUTABLE_H
+#define EXECUTABLE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "SpuMethods.h"
+
+/// @brief Constant for the magic of the SPU executable ("SPUX")
+static const uint32_t SPU_EXE_MAGIC   = 0x58555053;
+
+/// @brief Constant for the version of the format
+static const uint32_t SPU_EXE_VERSION = 1;
+
+/// @brief Constant for the maximum symbol length (with '\0')
+static const size_t SPU_EXE_NAME_LEN  = 32;
+
+/// @brief Enum with return codes of the executable functions
+enum SpuExeReturnCode {
+    SPU_EXE_SUCCESS      =  0,
+    SPU_EXE_FILE_ERROR   = -1,
+    SPU_EXE_FORMAT_ERROR = -2,
+    SPU_EXE_MEMORY_ERROR = -3,
+};
+
+/// @brief Structure with the header of the file, sections are arrays of 4 byte words at the given offsets
+struct SpuExeHeader {
+    uint32_t          magic;
+    uint32_t        version;
+    uint32_t          entry; ///< address of the first command
+    uint32_t    code_offset;
+    uint32_t      code_size; ///< in words
+    uint32_t    data_offset;
+    uint32_t      data_size; ///< in words, copied to the beginning of RAM
+    uint32_t symbols_offset;
+    uint32_t  symbols_count;
+    uint32_t       ram_size; ///< in words, 0 is the default size (the older files have 0 here)
+};
+
+/// @brief Structure with the symbol: name of the code address
+struct SpuExeSymbol {
+    int32_t                  address;
+    char   name[SPU_EXE_NAME_LEN];
+};
+
+/// @brief Structure with the line of the program text that starts at the address (until the next one)
+struct SpuExeLine {
+    int32_t address;
+    int32_t    line;
+};
+
+/// @brief Structure with the debug information of the running code, the arrays are not owned
+struct SpuDebugInfo {
+    const SpuExeSymbol* symbols; ///< names of the functions (the labels of the assembler)
+    size_t        symbols_count;
+    const SpuExeLine*     lines; ///< sorted by the address (NULL if the lines are unknown)
+    size_t          lines_count;
+};
+
+/// @brief Structure with the loaded executable, all pointers point into the mapping of the file
+struct SpuExe {
+    void*                 mapping;
+    size_t           mapping_size;
+    const SpuExeHeader*    header;
+    const int*               code;
+    const int*               data;
+    const SpuExeSymbol*   symbols;
+};
+
+/*!
+    @brief Function that writes the executable
+    \param [in]      filename - name of the file
+    \param [in]          code - commands
+    \param [in]     code_size - count of the words in code
+    \param [in]          data - initial RAM (can be NULL if data_size is 0)
+    \param [in]     data_size - count of the words in data
+    \param [in]         entry - address of the first command
+    \param [in]       symbols - symbol table (can be NULL if symbols_count is 0)
+    \param [in] symbols_count - count of the symbols
+    \param [in]      ram_size - size of RAM in words (0 for the default size)
+    @return The status of the function (return code)
+*/
+SpuExeReturnCode WriteSpuExe(const char* filename, const int* code, size_t code_size, const int* data, size_t data_size,
+                             int entry, const SpuExeSymbol* symbols, size_t symbols_count, size_t ram_size);
+
+/*!
+    @brief Function that maps the executable and checks its header and sections
+    \param [in]  filename - name of the file
+    \param [out]      exe - pointer on the executable (it is freed with SpuExeDtor)
+    @return The status of the function (return code)
+*/
+SpuExeReturnCode LoadSpuExe(const char* filename, SpuExe* exe);
+
+/*!
+    @brief Function that unmaps the executable
+    \param [out] exe - pointer on the executable
+*/
+void SpuExeDtor(SpuExe* exe);
+
+/*!
+    @brief Function that runs the code of the executable in place (the JIT is used if it is allowed and possible)
+    \param [in]     exe - pointer on the executable
+    \param [in] use_jit - 1 to try the JIT
+    \param [in]  config - memory parameters, the size of RAM in it overrides the one of the header (NULL for the defaults)
+    @return The status of the function (return code)
+*/
+SpuExeReturnCode RunSpuExe(const SpuExe* exe, int use_jit, const SpuConfig* config);
+
+/*!
+    @brief Function that finds the symbol of the address
+    \param [in] debug_info - pointer on the debug information (can be NULL)
+    \param [in]    address - the code address
+    \param [in]  is_inside - 1 to take the nearest symbol before the address if there is no one at it
+    @return The pointer on the symbol (NULL if there is no one)
+*/
+const SpuExeSymbol* SpuDebugFindSymbol(const SpuDebugInfo* debug_info, int address, int is_inside);
+
+/*!
+    @brief Function that finds the line of the program text of the address
+    \param [in] debug_info - pointer on the debug information (can be NULL)
+    \param [in]    address - the code address
+    \param [in]   function - address of its function, the lines before it belong to the other functions
+    @return The line (0 if it is unknown)
+*/
+int SpuDebugFindLine(const SpuDebugInfo* debug_info, int address, int function);
+
+#endif // EXECUTABLE_H
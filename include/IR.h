@@ -0,0 +1,239 @@
+/*!
+    \file
+    File with the SSA intermediate representation (IR) between the AST and the back ends
+*/
+
+#ifndef IR_H
+#define IR_H
+
+#include <stdio.h>
+
+#include "Tools.h"
+
+//* IR.h must not include BinaryTree.h or LanguageSyntaxis.h: back ends include it together with
+//* ReturnCodes.h, whose enums (SUCCESS, ADD, SUB...) clash with the front end ones
+struct Tree;
+struct NameTable;
+
+/// @brief Enum with return codes of the IR functions
+enum IRReturnCode {
+    IR_SUCCESS        =  0,
+    IR_MEMORY_ERROR   = -1,
+    IR_SEMANTIC_ERROR = -2,
+    IR_FILE_ERROR     = -3,
+};
+
+/// @brief Enum with IR instructions
+enum IROpcode {
+    IR_CONST      =  0, ///< value = constant (fixed point, multiplied by CALC_ACCURACY)
+    IR_PARAM      =  1, ///< value = number of the function parameter
+    IR_PHI        =  2, ///< args  = one value per block predecessor
+    IR_COPY       =  3, ///< value = destination, args = source (propagated away in SSA, phis become copies)
+    IR_ADD        =  4,
+    IR_SUB        =  5,
+    IR_MUL        =  6,
+    IR_DIV        =  7,
+    IR_SQRT       =  8,
+    IR_LESS       =  9,
+    IR_MORE       = 10,
+    IR_LESS_EQUAL = 11,
+    IR_MORE_EQUAL = 12,
+    IR_EQUAL      = 13,
+    IR_NOT_EQUAL  = 14,
+    IR_TRUNC      = 15, ///< drops the fractional part (assignment to a variable)
+    IR_CALL       = 16, ///< value = callee function index, args = arguments
+    IR_SCAN       = 17,
+    IR_PRINT      = 18,
+    IR_JMP        = 19, ///< targets[0]
+    IR_BRANCH     = 20, ///< args[0] != 0 ? targets[0] : targets[1]
+    IR_RET        = 21,
+};
+
+/// @brief Growing array of ints (instruction, block and value indexes)
+struct IRIntArray {
+    int*       data;
+    size_t     size;
+    size_t capacity;
+};
+
+/// @brief Structure with IR instruction, the instruction index is the number of the value it defines
+struct IRInstr {
+    IROpcode       opcode;
+    int             block; ///< owning block, -1 if the instruction was removed
+    int             value; ///< constant, parameter number or callee (depends on opcode)
+    int               var; ///< local variable defined by the instruction or -1
+    int        targets[2];
+    IRIntArray       args;
+    int              line; ///< line of the statement it was lowered from (0 if it is unknown)
+};
+
+/// @brief Structure with IR basic block
+struct IRBlock {
+    IRIntArray           instrs; ///< phis first, terminator last
+    IRIntArray            preds;
+    IRIntArray  incomplete_phis; ///< phis waiting for the block to be sealed
+    int*                   defs; ///< current SSA value of every local (construction only)
+    int                  sealed;
+    int                    dead;
+};
+
+/// @brief Structure with IR function
+struct IRFunction {
+    const char*           name;
+    int             name_index; ///< index in the nametable, -1 for the entry function
+    IRInstr*            instrs;
+    size_t        instrs_count;
+    size_t     instrs_capacity;
+    IRBlock*            blocks;
+    size_t        blocks_count;
+    size_t     blocks_capacity;
+    int*                locals; ///< nametable index of every local variable
+    size_t        locals_count;
+    int           params_count;
+    int                  undef; ///< constant 0 read by the uninitialized variables
+    int                   line; ///< line of the new instructions (the statement that is lowered now)
+};
+
+/// @brief Structure with the whole program in IR
+struct IRModule {
+    IRFunction**       functions;
+    size_t       functions_count;
+    int                    entry;
+    const NameTable*   nametable;
+};
+
+/*!
+    @brief Function that adds value in the end of the array
+    \param [out] array - pointer on the array
+    \param  [in] value - new value
+    @return The status of the function (return code)
+*/
+IRReturnCode IRIntArrayPush(IRIntArray* array, int value);
+
+/*!
+    @brief Function that frees the array memory
+    \param [out] array - pointer on the array
+*/
+void IRIntArrayDtor(IRIntArray* array);
+
+/*!
+    @brief Function that lowers AST to IR in SSA form
+    \param [in] ast - pointer on the AST
+    @return The pointer on the IR module (NULL on error)
+*/
+IRModule* IRBuild(const Tree* ast);
+
+/*!
+    @brief Function that deletes IR module
+    \param [out] module - pointer on the module
+*/
+void IRModuleDtor(IRModule* module);
+
+/*!
+    @brief Function that runs SSA optimizations (SCCP, GVN, dead code elimination) on every function
+    \param [out] module - pointer on the module
+    @return The status of the function (return code)
+*/
+IRReturnCode IROptimize(IRModule* module);
+
+/*!
+    @brief Function that replaces phis with copies in the predecessors (critical edges are split)
+    \param [out] module - pointer on the module
+    @return The status of the function (return code)
+    @note After this no SSA optimization may run: phi values get several definitions
+*/
+IRReturnCode IRLeaveSSA(IRModule* module);
+
+/*!
+    @brief Function that writes one IR instruction in text form (without the new line)
+    \param [in] filename - pointer on the file
+    \param [in]   module - pointer on the module
+    \param [in]     func - pointer on the function
+    \param [in]    index - instruction index
+*/
+void IRDumpInstr(FILE* filename, const IRModule* module, const IRFunction* func, int index);
+
+/*!
+    @brief Function that writes IR in text form
+    \param [in] filename - pointer on the file
+    \param [in]   module - pointer on the module
+    @return The status of the function (return code)
+*/
+IRReturnCode IRDump(FILE* filename, const IRModule* module);
+
+/*!
+    @brief Function that writes IR to IR_FILENAME
+    \param [in] module - pointer on the module
+    @return The status of the function (return code)
+*/
+IRReturnCode WriteIR(const IRModule* module);
+
+/*!
+    @brief Function that evaluates IR operation with constant operands (fixed point arithmetic)
+           Results that overflow int wrap around as the SPU registers do
+    \param  [in] opcode - operation
+    \param  [in]   left - first operand
+    \param  [in]  right - second operand (ignored for unary operations)
+    \param [out] result - result of the operation
+    @return 1 if the operation was evaluated, 0 if it must be left to run time (division by zero etc.)
+*/
+int IRFold(IROpcode opcode, int left, int right, int* result);
+
+/*!
+    @brief Function that finds the values without fractional part
+    \param  [in]     func - pointer on the function
+    \param [out] integral - array with instrs_count places (1 - integer value, 0 - may have fraction)
+*/
+void IRComputeIntegral(const IRFunction* func, int* integral);
+
+/*!
+    @brief Function that gets the value written by the instruction
+    \param [in]  func - pointer on the function
+    \param [in] index - instruction index
+    @return The value index (the instruction itself, copy destination) or -1
+*/
+int IRDefinedValue(const IRFunction* func, int index);
+
+/*!
+    @brief Function that checks if IR instruction ends a block
+    \param [in] opcode - operation
+*/
+int IRIsTerminator(IROpcode opcode);
+
+/*!
+    @brief Function that checks if IR instruction has no side effects
+    \param [in] opcode - operation
+*/
+int IRIsPure(IROpcode opcode);
+
+/*!
+    @brief Function that checks if IR instruction is a comparison
+    \param [in] opcode - operation
+*/
+int IRIsCompare(IROpcode opcode);
+
+/*!
+    @brief Function that gets successors of the block
+    \param  [in]  func - pointer on the function
+    \param  [in] block - block index
+    \param [out] succs - array with two places for successors
+    @return The number of successors
+*/
+int IRBlockSuccs(const IRFunction* func, int block, int* succs);
+
+/*!
+    @brief Function that computes reverse postorder of the reachable blocks
+    \param  [in] func - pointer on the function
+    \param [out]  rpo - array with blocks_count places
+    @return The number of reachable blocks
+*/
+size_t IRComputeRPO(const IRFunction* func, int* rpo);
+
+/*!
+    @brief Function that computes immediate dominators (Cooper, Harvey, Kennedy)
+    \param  [in] func - pointer on the function
+    \param [out] idom - array with blocks_count places (-1 for unreachable blocks)
+*/
+void IRComputeDominators(const IRFunction* func, int* idom);
+
+#endif // IR_H
@@ -0,0 +1,92 @@
+/*!
+    \file
+    File with the tree-walking interpreter (AST is run without code generation)
+*/
+
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include <stdio.h>
+
+#include "BinaryTree.h"
+
+/// @brief Enum with return codes of the interpreter
+enum InterpReturnCode {
+    INTERP_SUCCESS        =  0,
+    INTERP_MEMORY_ERROR   = -1,
+    INTERP_SEMANTIC_ERROR = -2,
+    INTERP_RUNTIME_ERROR  = -3,
+};
+
+/// @brief Enum with kinds of the resolved nodes
+enum ExecKind {
+    EXEC_NUMBER = 0, ///< value = constant (fixed point)
+    EXEC_LOCAL  = 1, ///< value = frame slot
+    EXEC_CALL   = 2, ///< value = function index, items = arguments
+    EXEC_BINARY = 3, ///< value = IROpcode, first and second = operands
+    EXEC_SQRT   = 4, ///< first = operand
+    EXEC_ASSIGN = 5, ///< value = frame slot, first = expression
+    EXEC_IF     = 6, ///< first = condition, second = then, third = else or -1
+    EXEC_WHILE  = 7, ///< first = condition, second = body
+    EXEC_RETURN = 8, ///< first = expression
+    EXEC_PRINT  = 9, ///< first = expression
+    EXEC_SCAN   = 10, ///< value = frame slot
+    EXEC_BLOCK  = 11, ///< items = statements
+};
+
+/// @brief Structure with the node with resolved names, nodes refer to each other by indexes in the pool
+struct ExecNode {
+    ExecKind       kind;
+    int           value;
+    int           first;
+    int          second;
+    int           third;
+    int           items; ///< first index in the items pool
+    int     items_count;
+};
+
+/// @brief Structure with the resolved function
+struct ExecFunction {
+    const char*         name;
+    int                 body;
+    int         params_count;
+    int          slots_count;
+};
+
+/// @brief Structure with the program ready to run
+struct ExecProgram {
+    ExecNode*            nodes;
+    size_t         nodes_count;
+    size_t      nodes_capacity;
+    int*                 items;
+    size_t         items_count;
+    size_t      items_capacity;
+    ExecFunction*    functions;
+    size_t     functions_count;
+    int                  entry;
+};
+
+/*!
+    @brief Function that resolves names of the AST to frame slots and function indexes
+    \param [in] ast - pointer on the AST
+    @return The pointer on the program (NULL on error)
+*/
+ExecProgram* InterpBuild(const Tree* ast);
+
+/*!
+    @brief Function that deletes the program
+    \param [out] program - pointer on the program
+*/
+void InterpDtor(ExecProgram* program);
+
+/*!
+    @brief Function that runs the program (the same fixed point arithmetic as the SPU)
+           Every operation matches the SPU until a value overflows int. After that the results may
+           differ from the compiled program: the SPU keeps variables unscaled in registers and RAM
+           and the optimizer reorders the operations, so the values wrap at other points
+    \param [in] program - pointer on the program
+    @return The status of the function (return code)
+*/
+InterpReturnCode InterpRun(const ExecProgram* program);
+
+#endif // INTERPRETER_H
@@ -0,0 +1,62 @@
+/*!
+    \file
+    File with the x86-64 JIT compiler of the SPU bytecode (native code in the executable buffer)
+*/
+
+#ifndef JIT_H
+#define JIT_H
+
+#include <stdio.h>
+
+#include "SpuMethods.h"
+
+/// @brief Constant for the size of the JIT data stack (in elements)
+static const size_t JIT_STACK_SIZE = 1 << 20;
+
+/// @brief Constant for the maximum depth of the SPU calls in the JIT code
+static const int JIT_CALL_DEPTH = 1 << 16;
+
+/// @brief Enum with return codes of the JIT
+enum JitReturnCode {
+    JIT_SUCCESS       =  0,
+    JIT_MEMORY_ERROR  = -1,
+    JIT_RUNTIME_ERROR = -2,
+};
+
+/// @brief Structure with the compiled SPU program
+struct JitCode {
+    unsigned char*   code; ///< executable buffer (mmap'd)
+    size_t           size;
+    int*            stack; ///< data stack of the SPU
+    long        saved_rsp; ///< native stack pointer of the entry, HLT and errors return to it
+};
+
+/*!
+    @brief Function that translates the SPU commands into native code
+    \param [in]       spu - pointer on the SPU (its regs and ram are used by the native code directly, spu->ip is the entry)
+    \param [in] code_size - count of the words in spu->cmds
+    @return The pointer on the compiled program (NULL if the code can not be compiled, run CPUWork then)
+*/
+JitCode* JitCompile(SPU* spu, size_t code_size);
+
+/*!
+    @brief Function that runs the compiled program
+    \param [in] jit - pointer on the compiled program
+    @return The status of the function (return code)
+*/
+JitReturnCode JitRun(JitCode* jit);
+
+/*!
+    @brief Function that deletes the compiled program
+    \param [out] jit - pointer on the compiled program
+*/
+void JitDtor(JitCode* jit);
+
+/*!
+    @brief Function that runs the code of the SPU: natively if the JIT can compile it, by CPUWork otherwise
+    \param [in]     spu - pointer on the SPU with the loaded code
+    \param [in] use_jit - 1 to try the JIT
+*/
+void SpuRun(SPU* spu, int use_jit);
+
+#endif // JIT_H
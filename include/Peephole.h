@@ -0,0 +1,33 @@
+/*!
+    \file
+    File with the peephole optimizer of the SPU bytecode (decoded commands, window rules, jump targets are fixed up)
+*/
+
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include <stdio.h>
+
+#include "CodeGen.h"
+
+/// @brief Constant for the maximum count of the passes over the commands
+static const int PEEPHOLE_MAX_PASSES = 32;
+
+/// @brief Enum with return codes of the peephole optimizer
+enum PeepholeReturnCode {
+    PEEPHOLE_SUCCESS      =  0,
+    PEEPHOLE_MEMORY_ERROR = -1,
+    PEEPHOLE_SKIPPED      = -2, ///< the code has unknown commands or jumps into the commands, it is not changed
+};
+
+/*!
+    @brief Function that optimizes the bytecode of the code generator in place:
+           removes PUSH x; POP x, scaling round trips and unreachable commands, folds constants,
+           fuses JE, JNE, JGE with the drops of the compared pair (JEP, JNEP, JGEP), threads jumps to jumps.
+           regs[XX] is the scratch register of the operands, its value is not kept
+    \param [out] bytecode - pointer on the bytecode (the entry is the address 0, symbols are moved with the code)
+    @return The status of the function (return code)
+*/
+PeepholeReturnCode PeepholeBytecode(Bytecode* bytecode);
+
+#endif // PEEPHOLE_H
@@ -0,0 +1,103 @@
+/*!
+    \file
+    File with the linear scan register allocator of IR values onto the SPU registers
+*/
+
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+#include <stdio.h>
+
+#include "IR.h"
+
+/// @brief Constant for the count of allocatable registers: AX..HX (IX is the frame pointer, XX is scratch)
+static const int ALLOC_REGS_COUNT = 8;
+
+/// @brief Enum with return codes of the register allocator
+enum RegAllocReturnCode {
+    REGALLOC_SUCCESS      =  0,
+    REGALLOC_MEMORY_ERROR = -1,
+    REGALLOC_FILE_ERROR   = -2,
+};
+
+/// @brief Enum with the places where IR value lives
+enum LocationType {
+    LOCATION_NONE  = 0, ///< value is never read (result is dropped)
+    LOCATION_REG   = 1, ///< index = register (AX + index)
+    LOCATION_SLOT  = 2, ///< index = RAM cell [IX + index] of the function frame
+    LOCATION_CONST = 3, ///< constant is pushed where it is used
+    LOCATION_FUSED = 4, ///< comparison is fused into the conditional jump of the next branch
+};
+
+/// @brief Structure with the place of IR value
+struct Location {
+    LocationType type;
+    int         index;
+};
+
+/// @brief Structure with the allocation of one IR function
+struct RegAllocation {
+    Location*  locations; ///< one per value (instruction index)
+    int*       positions; ///< linear position of every instruction, -1 for removed ones
+    int*          starts; ///< live interval of every value, -1 if the value has no interval
+    int*            ends;
+    int*         weights; ///< uses and definitions weighted by the loop depth
+    size_t  values_count;
+    int*           order; ///< blocks in the layout order
+    size_t   order_count;
+    int       frame_size; ///< count of RAM cells used by the spilled values
+};
+
+/*!
+    @brief Function that allocates registers for the function in the out of SSA form
+    \param [in] func - pointer on the function
+    @return The pointer on the allocation (NULL on error)
+*/
+RegAllocation* RegAllocFunction(const IRFunction* func);
+
+/*!
+    @brief Function that allocates registers for every function of the module
+    \param [out] module - pointer on the module (it is taken out of SSA form)
+    @return The array of functions_count allocations (NULL on error)
+*/
+RegAllocation** RegAllocModule(IRModule* module);
+
+/*!
+    @brief Function that deletes the allocation
+    \param [out] alloc - pointer on the allocation
+*/
+void RegAllocationDtor(RegAllocation* alloc);
+
+/*!
+    @brief Function that deletes the allocations of the module
+    \param [out] allocs - array of allocations
+    \param  [in]  count - count of the allocations
+*/
+void RegAllocModuleDtor(RegAllocation** allocs, size_t count);
+
+/*!
+    @brief Function that finds the registers holding values which are live across the instruction (call)
+    \param  [in] alloc - pointer on the allocation
+    \param  [in] instr - instruction index
+    \param [out]  regs - array with ALLOC_REGS_COUNT places
+    @return The count of the registers
+*/
+int RegAllocLiveAcross(const RegAllocation* alloc, int instr, int* regs);
+
+/*!
+    @brief Function that writes the allocated program in text form
+    \param [in] filename - pointer on the file
+    \param [in]   module - pointer on the module
+    \param [in]   allocs - allocations of the module functions
+*/
+void RegAllocDump(FILE* filename, const IRModule* module, RegAllocation* const* allocs);
+
+/*!
+    @brief Function that writes the allocated program to REGALLOC_FILENAME
+    \param [in] module - pointer on the module
+    \param [in] allocs - allocations of the module functions
+    @return The status of the function (return code)
+*/
+RegAllocReturnCode WriteRegAlloc(const IRModule* module, RegAllocation* const* allocs);
+
+#endif // REGALLOC_H
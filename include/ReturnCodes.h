@@ -9,19 +9,6 @@
 #include <stdio.h>
 
 #include "Tools.h"
-#include "Stack.h"
-
-/// @brief Constant for the maximum label's name
-static const size_t LABEL_NAME_LEN = 50;
-
-/// @brief Constant for the labels count
-static const size_t LABELS_COUNT   = 50;
-
-/// @brief Structure with Labels
-struct Label {
-    char label_name[LABEL_NAME_LEN];
-    int  label_number = -1;
-};
 
 /// @brief Enum with return functions codes
 enum FuncReturn {
@@ -62,6 +49,9 @@ enum Comands {
     IDIV  = 21,
     JGE   = 22,
     DRAW  = 23,
+    JEP   = 24, ///< JE  that pops both values (made by the peephole optimizer)
+    JNEP  = 25, ///< JNE that pops both values
+    JGEP  = 26, ///< JGE that pops both values
     HLT   = -1,
 };
 
@@ -7,25 +7,170 @@
 #define SPUMETHODS_H
 
 #include <stdio.h>
+#include <limits.h>
 
 #include "Stack.h"
 #include "Tools.h"
 
+/// @brief Constant for the register bit
+static const int REG_BIT      = 1;
+
+/// @brief Constant for the memory bit
+static const int MEMORY_BIT   = 4;
+
+/// @brief Constant for the constant bit
+static const int CONSTANT_BIT = 2;
+
+//* with DEBUG or SPU_GUARDED_STACK the stacks of CPUWork are the checked Stack, otherwise they are flat arrays
+#if defined(DEBUG) || defined(SPU_GUARDED_STACK)
+    #define SPU_CHECKED_STACKS
+#endif
+
+/// @brief Constant for the size of the operand stack of CPUWork (in elements)
+static const size_t SPU_STACK_SIZE = 1 << 20;
+
+/// @brief Constant for the maximum depth of the calls of CPUWork
+static const size_t SPU_CALL_DEPTH = 1 << 16;
+
+/// @brief Constants for the flat stacks that are kept in the SPU, the deeper ones move to the heap
+static const size_t SPU_INLINE_STACK_SIZE = 256;
+static const size_t SPU_INLINE_CALL_DEPTH = 64;
+
+/// @brief Constant for the maximum size of RAM (in words), every address fits in a register
+static const size_t SPU_MAX_RAM_SIZE = (size_t) 1 << 30;
+
+/// @brief Constant for the default side of the DRAW picture (the square of the default RAM)
+static const size_t SPU_DRAW_SIDE = 30;
+
+/// @brief Constant for the size of the huge page
+static const size_t SPU_HUGE_PAGE_SIZE = (size_t) 2 << 20;
+
+/// @brief Constant for the budget of CPUResume that is never spent
+static const long SPU_NO_BUDGET = LONG_MAX;
+
+/// @brief Enum with the states of the SPU after CPUResume
+enum SpuStatus {
+    SPU_STATUS_HALTED = 0,  ///< HLT
+    SPU_STATUS_ERROR  = -1, ///< the error is printed to the output of the SPU
+    SPU_STATUS_BUDGET = 1,  ///< the budget is spent, CPUResume continues the program
+    SPU_STATUS_INPUT  = 2,  ///< IN waits for the input queue, CPUResume runs IN again
+};
+
+/// @brief Structure with the numbers for IN of the SPU that is resumed (the green thread)
+struct SpuInputQueue {
+    int*         values;
+    size_t        count;
+    size_t         next; ///< the first number that is not read
+    size_t     capacity;
+    int         is_used; ///< 1 if IN reads the queue (and waits for it) instead of the input stream
+    int       is_closed; ///< 1 if no numbers will come, IN gets 0 then
+};
+
+/// @brief Constant for the size of the output buffer of the raw I/O (it is flushed when it is full)
+static const size_t SPU_OUTPUT_BUFFER_SIZE = 1 << 16;
+
+/// @brief Constant for the maximal count of the fraction digits that OUT prints in the raw I/O
+static const int SPU_OUTPUT_FRACTION_DIGITS = 6;
+
+/// @brief Constant for the bound of the bytes of one cell of the DRAW frame (the cursor moves and the colors included)
+static const size_t SPU_FRAME_CELL_SIZE = 32;
+
+/// @brief Structure with the memory parameters of the SPU, the zero fields are the defaults
+struct SpuConfig {
+    size_t    ram_size; ///< in words (RAM_SIZE)
+    size_t  draw_width; ///< DRAW shows RAM from the address 0 as draw_height lines of draw_width words (SPU_DRAW_SIDE)
+    size_t draw_height; ///< (SPU_DRAW_SIDE, it is cut to RAM)
+    int     huge_pages; ///< 1 to back RAM by huge pages (transparent ones if the system has no reserved pages)
+    int         raw_io; ///< 1 for the non-interactive I/O: the input is read at once, the output is buffered, no prompts
+};
+
+/// @brief Enum with the decoded commands, PUSH and POP are split by the operand mode (POP_XX is POP to a number),
+///        the commands after DRAW are superinstructions of the frequent sequences
+enum SpuOp {
+    #define DEF_SPU_OP_(name) SPU_OP_##name,
+    #include "spu_ops.h"
+    #undef DEF_SPU_OP_
+};
+
+/// @brief Constant for the count of the decoded commands
+static const int SPU_OPS_COUNT = 0
+    #define DEF_SPU_OP_(name) + 1
+    #include "spu_ops.h"
+    #undef DEF_SPU_OP_
+    ;
+
+/// @brief Names of the decoded commands (for the reports)
+static const char* const SPU_OP_NAMES[SPU_OPS_COUNT] = {
+    #define DEF_SPU_OP_(name) #name,
+    #include "spu_ops.h"
+    #undef DEF_SPU_OP_
+};
+
+/// @brief Structure with the decoded command
+struct SpuInstr {
+    SpuOp       op;
+    int     length; ///< in words
+    int        reg; ///< register of the operand
+    int      value; ///< constant of the operand (the second register of the REG_REG superinstructions)
+    int     target; ///< target of the jump
+    int       need; ///< stack elements needed by the commands from here to the next jump (the run)
+    int       grow; ///< maximum growth of the stack on the run
+};
+
+struct SpuProfile;
+struct SpuTrace;
+struct SpuDebugInfo;
+
+/// @brief Stack of CPUWork with SPU_CHECKED_STACKS, the checked stack keeps its first STACK_START_CAPACITY elements
+///        in the SPU (the release SPU does not use it, so it has no inline buffer there)
+typedef Stack<int, StackDefaultPolicy, StackIsChecked<StackDefaultPolicy>() ? STACK_START_CAPACITY : 0> SpuDebugStack;
+
 /// @brief Structure with SPU
 struct SPU {
     int ip = 0;
-    Stack* st = NULL;
-    Stack* stFunc = NULL;
-    int cmds[CMDS_SIZE] = {};
+    SpuDebugStack st; ///< operand stack of CPUWork with SPU_CHECKED_STACKS
+    SpuDebugStack stFunc; ///< call stack of CPUWork with SPU_CHECKED_STACKS
+    const int* cmds = NULL; ///< code of the program, it is not owned by the SPU
+    size_t cmds_size = 0;
+    SpuInstr* decoded = NULL; ///< cmds decoded at every address by CPUWork (cmds_size + 1 elements, the last one is UNKNOWN)
+    int decoded_shared = 0; ///< 1 if decoded belongs to the code image of the pool, it is not freed then
+    int* vm_stack = NULL; ///< flat operand stack of CPUWork without SPU_CHECKED_STACKS (up to SPU_STACK_SIZE elements)
+    int* vm_calls = NULL; ///< flat call stack of CPUWork without SPU_CHECKED_STACKS (up to SPU_CALL_DEPTH elements)
+    size_t vm_stack_size = 0; ///< elements of vm_stack, it starts in vm_inline_stack
+    size_t vm_calls_size = 0; ///< elements of vm_calls, it starts in vm_inline_calls
+    int* vm_top = NULL; ///< saved stack state of CPUResume when it yields (NULL is the empty stacks)
+    int vm_tos = 0;
+    int* vm_calls_top = NULL;
+#ifndef SPU_CHECKED_STACKS
+    int vm_inline_stack[SPU_INLINE_STACK_SIZE] = {}; ///< the short-lived SPU runs without allocating the stacks
+    int vm_inline_calls[SPU_INLINE_CALL_DEPTH] = {};
+#endif
     int regs[REGS_SIZE] = {};
-    int ram[RAM_SIZE] = {};
+    int* ram = NULL; ///< mmap'd, the pages are committed and zeroed by the system on the first access
+    size_t ram_size = 0; ///< in words
+    size_t ram_mapping_size = 0; ///< in bytes
+    size_t draw_width = 0;
+    size_t draw_height = 0;
+    FILE* input = NULL; ///< stream of IN (stdin after SpuInit)
+    FILE* output = NULL; ///< stream of OUT, DRAW and the errors of CPUWork (stdout after SpuInit)
+    SpuInputQueue in_queue = {};
+    int raw_io = 0; ///< 1 if IN reads the whole input to in_queue at once and OUT writes plain numbers to out_buffer
+    char* out_buffer = NULL; ///< SPU_OUTPUT_BUFFER_SIZE bytes, written to output by SpuFlushOutput
+    size_t out_size = 0;
+    int* frame_cells = NULL; ///< RAM cells shown by the last DRAW (draw_width * draw_height)
+    char* frame_text = NULL; ///< the frame is composed here and written by one call
+    int frame_valid = 0; ///< 1 if the last frame is right above the cursor, the next DRAW writes the changed cells only
+    SpuProfile* profile = NULL; ///< counted by CPUWork built with -DSPU_PROFILE, it is written on HLT
+    SpuTrace* trace = NULL; ///< recorded by CPUWork built with -DSPU_TRACE, it is dumped on HLT and on the errors
+    const SpuDebugInfo* debug_info = NULL; ///< names of the addresses for the profile (not owned, can be NULL)
 };
 
 /*!
     @brief Function that initialize and create SPU struct
-    \param [out] spu - the pointer on SPU struct
+    \param [in] config - memory parameters (NULL for the defaults)
+    @return The pointer on SPU struct (NULL if there is no memory or the parameters are wrong)
 */
-SPU* SpuInit();
+SPU* SpuInit(const SpuConfig* config);
 
 /*!
     @brief Function that determinate SPU structer
@@ -33,4 +178,61 @@ SPU* SpuInit();
 */
 void SpuDtor(SPU* spu);
 
+/*!
+    @brief Function that makes the SPU ready for the next run: zero registers, RAM and ip, empty stacks
+    \param [out] spu - the pointer on SPU struct
+*/
+void SpuReset(SPU* spu);
+
+/*!
+    @brief Function that adds the numbers to the input queue of the SPU (IN reads the queue after it)
+    \param [out]    spu - the pointer on SPU struct
+    \param [in]  values - numbers (not scaled)
+    \param [in]   count - count of the numbers
+    @return 1 if the numbers are added, 0 if there is no memory
+*/
+int SpuQueueInput(SPU* spu, const int* values, size_t count);
+
+/*!
+    @brief Function that checks that IN can run without waiting
+    \param [in] spu - the pointer on SPU struct
+    @return 1 if the input stream is used or the queue has a number or it is closed
+*/
+int SpuInputReady(const SPU* spu);
+
+/*!
+    @brief Function that reads a number for the IN command (from the input queue if it is used)
+    \param [in] spu - the pointer on SPU struct
+    @return The number (not scaled)
+*/
+int SpuIn(SPU* spu);
+
+/*!
+    @brief Function that prints the value for the OUT command
+    \param [in]   spu - the pointer on SPU struct
+    \param [in] value - fixed point value from the stack
+*/
+void SpuOut(SPU* spu, int value);
+
+/*!
+    @brief Function that draws RAM for the DRAW command, the frame is written at once: the whole one first,
+           then only the changed cells if the output is a terminal and nothing was printed after the last frame
+    \param [in] spu - the pointer on SPU struct
+*/
+void SpuDraw(SPU* spu);
+
+/*!
+    @brief Function that writes the buffered output of the raw I/O to the output stream and flushes it
+    \param [out] spu - the pointer on SPU struct
+*/
+void SpuFlushOutput(SPU* spu);
+
+/*!
+    @brief Function that gives the output stream for the messages of the processor, the buffered output
+           is written before them to keep the order
+    \param [out] spu - the pointer on SPU struct
+    @return The output stream
+*/
+FILE* SpuMessageStream(SPU* spu);
+
 #endif // SPUMETHODS_H
\ No newline at end of file
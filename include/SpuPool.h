@@ -0,0 +1,89 @@
+/*!
+    \file
+    File with the pool of SPUs: one decoded code image is run by many SPU contexts on the worker threads
+*/
+
+#ifndef SPUPOOL_H
+#define SPUPOOL_H
+
+#include <stdio.h>
+
+#include "SpuMethods.h"
+
+/// @brief Enum with return codes of the pool
+enum SpuPoolReturnCode {
+    SPU_POOL_SUCCESS      =  0,
+    SPU_POOL_MEMORY_ERROR = -1,
+    SPU_POOL_THREAD_ERROR = -2,
+    SPU_POOL_FILE_ERROR   = -3,
+    SPU_POOL_DATA_ERROR   = -4,
+};
+
+/// @brief Structure with the code shared by the SPUs of the pool, it is read only after SpuImageInit
+struct SpuImage {
+    const int*      cmds; ///< not owned
+    size_t     cmds_size;
+    int            entry; ///< address of the first command
+    const int*      data; ///< copied to the beginning of RAM before every job (not owned)
+    size_t     data_size; ///< in words
+    SpuConfig     config; ///< ram_size is resolved (it is never 0)
+    SpuInstr*    decoded; ///< the code decoded once for all SPUs
+};
+
+/// @brief Structure with the job: one run of the image with its own streams
+struct SpuJob {
+    FILE*             input; ///< stream of IN (if it is NULL, input_name is opened by the worker or stdin is used)
+    FILE*            output; ///< stream of OUT, DRAW and errors (if it is NULL, output_name is opened or stdout is used)
+    const char*  input_name;
+    const char* output_name;
+};
+
+/*!
+    @brief Function that decodes the code for the pool
+    \param [out]     image - pointer on the image (it is freed with SpuImageDtor)
+    \param [in]       cmds - commands (they must live until SpuImageDtor)
+    \param [in]  cmds_size - count of the words in cmds
+    \param [in]      entry - address of the first command
+    \param [in]       data - initial RAM (can be NULL if data_size is 0)
+    \param [in]  data_size - count of the words in data
+    \param [in]     config - memory parameters of the SPUs (NULL for the defaults)
+    @return The status of the function (return code)
+*/
+SpuPoolReturnCode SpuImageInit(SpuImage* image, const int* cmds, size_t cmds_size, int entry,
+                               const int* data, size_t data_size, const SpuConfig* config);
+
+/*!
+    @brief Function that frees the decoded code of the image
+    \param [out] image - pointer on the image
+*/
+void SpuImageDtor(SpuImage* image);
+
+/*!
+    @brief Function that runs every job on its own SPU context (registers, RAM and stacks are private),
+           a worker takes the jobs of its range first and steals from the ranges of the others then
+    \param [in]         image - pointer on the image
+    \param [in]          jobs - jobs
+    \param [in]    jobs_count - count of the jobs
+    \param [in] threads_count - count of the workers (0 for the count of the online processors)
+    @return The status of the function (return code): SPU_POOL_FILE_ERROR if the streams of some job
+            can not be opened, SPU_POOL_MEMORY_ERROR if some worker can not make its SPU
+*/
+SpuPoolReturnCode SpuPoolRun(const SpuImage* image, const SpuJob* jobs, size_t jobs_count, size_t threads_count);
+
+/*!
+    @brief Function that runs the image for every input file of the list, the output of the job is "<input>.out"
+    \param [in]         image - pointer on the image
+    \param [in] list_filename - name of the file with the input filenames (one on the line)
+    \param [in] threads_count - count of the workers (0 for the count of the online processors)
+    @return The status of the function (return code), SPU_POOL_FILE_ERROR if some input can not be read
+*/
+SpuPoolReturnCode SpuPoolRunList(const SpuImage* image, const char* list_filename, size_t threads_count);
+
+/*!
+    @brief Function that reads the whole file of the batch list
+    \param [in] filename - name of the file
+    @return The text terminated by '\0' (it is freed by the caller, NULL if there is an error)
+*/
+char* SpuReadList(const char* filename);
+
+#endif // SPUPOOL_H
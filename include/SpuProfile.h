@@ -0,0 +1,164 @@
+/*!
+    \file
+    File with the execution profile of the SPU: the counts of the decoded commands and the addresses,
+    the cycles of the sampled commands, the targets of CALL and the sampled call stacks named by the functions
+    of the program. It is counted by CPUWork built with -DSPU_PROFILE
+*/
+
+#ifndef SPUPROFILE_H
+#define SPUPROFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+#include "SpuMethods.h"
+
+/// @brief Constant for the period of the cycle samples: every such command is measured by rdtsc
+static const size_t SPU_PROFILE_SAMPLE_PERIOD = 16;
+
+/// @brief Constant for the period of the call stack samples (prime, so the samples do not follow the loops)
+static const size_t SPU_PROFILE_STACK_PERIOD = 997;
+
+/// @brief Constant for the depth of the sampled stack, the outer frames of the deeper stacks are cut
+static const size_t SPU_PROFILE_STACK_DEPTH = 128;
+
+/// @brief Constant for the count of the ranges and the addresses in the text report (JSON has all of them)
+static const size_t SPU_PROFILE_TOP = 20;
+
+/// @brief Names of the reports that are written on HLT
+static const char* const SPU_PROFILE_TEXT_FILENAME = "profile.txt";
+static const char* const SPU_PROFILE_JSON_FILENAME = "profile.json";
+static const char* const SPU_PROFILE_FOLDED_FILENAME = "profile.folded";
+
+/// @brief Enum with return codes of the profile
+enum SpuProfileReturnCode {
+    SPU_PROFILE_SUCCESS      =  0,
+    SPU_PROFILE_MEMORY_ERROR = -1,
+    SPU_PROFILE_FILE_ERROR   = -2,
+};
+
+/// @brief Structure with the folded call stack and the count of its samples
+struct SpuProfileStack {
+    char*  text; ///< "ROOT;CALLEE;LEAF:line" (NULL in the empty slot)
+    size_t hash;
+    size_t count;
+};
+
+/// @brief Structure with the profile of one SPU
+struct SpuProfile {
+    size_t          cmds_size;
+    size_t*         ip_counts; ///< executions of the command at the address (cmds_size + 1, the last one is out of the code)
+    size_t*       call_counts; ///< CALLs to the address (cmds_size + 1)
+    size_t    op_counts [SPU_OPS_COUNT];
+    uint64_t   op_cycles[SPU_OPS_COUNT]; ///< cycles of the sampled commands
+    size_t   op_samples [SPU_OPS_COUNT];
+    size_t      countdown; ///< commands until the next sample
+    int        sampled_op; ///< the command that is measured now (-1 if there is no one)
+    uint64_t   sample_tsc;
+    uint64_t tsc_overhead; ///< cycles of the measurement itself, they are subtracted from the samples
+    size_t  stack_countdown; ///< commands until the next call stack sample
+    SpuProfileStack* stacks; ///< hash table of the folded stacks (open addressing)
+    size_t     stacks_count;
+    size_t  stacks_capacity; ///< power of 2
+};
+
+/// @brief Reads the time stamp counter (0 if the processor has no one, the cycles are not measured then)
+static inline uint64_t SpuProfileTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*!
+    @brief Function that counts the command before it runs, the sampled command is measured until the next one
+    \param [out] profile - pointer on the profile
+    \param [in]       op - the decoded command
+    \param [in]       ip - its address
+    @return 1 if the call stack must be sampled now by SpuProfileSampleStack
+*/
+static inline int SpuProfileCount(SpuProfile* profile, SpuOp op, int ip) {
+    if (profile->sampled_op >= 0) {
+        uint64_t cycles = SpuProfileTsc() - profile->sample_tsc;
+        profile->op_cycles [profile->sampled_op] += cycles > profile->tsc_overhead ? cycles - profile->tsc_overhead : 0;
+        profile->op_samples[profile->sampled_op]++;
+        profile->sampled_op = -1;
+    }
+
+    profile->op_counts[op]++;
+    profile->ip_counts[((size_t) ip < profile->cmds_size) ? (size_t) ip : profile->cmds_size]++;
+
+    if (--profile->countdown == 0) {
+        profile->countdown  = SPU_PROFILE_SAMPLE_PERIOD;
+        profile->sampled_op = op;
+        profile->sample_tsc = SpuProfileTsc();
+    }
+
+    if (--profile->stack_countdown == 0) {
+        profile->stack_countdown = SPU_PROFILE_STACK_PERIOD;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+    @brief Function that counts the target of CALL
+    \param [out] profile - pointer on the profile
+    \param [in]   target - address of the function
+*/
+static inline void SpuProfileCall(SpuProfile* profile, int target) {
+    profile->call_counts[((size_t) target < profile->cmds_size) ? (size_t) target : profile->cmds_size]++;
+}
+
+/*!
+    @brief Function that counts the call stack of the SPU as the folded stack: the callees are named by the symbols
+           of spu->debug_info at the targets of CALL, the leaf gets the line of spu->ip (the sample is lost
+           if there is no memory)
+    \param [out]     profile - pointer on the profile
+    \param [in]          spu - the pointer on SPU struct
+    \param [in]        calls - the return addresses, the outer one is the first
+    \param [in]  calls_count - count of the return addresses
+*/
+void SpuProfileSampleStack(SpuProfile* profile, const SPU* spu, const int* calls, size_t calls_count);
+
+/*!
+    @brief Function that creates the empty profile
+    \param [in] cmds_size - count of the words of the code
+    @return The pointer on the profile (NULL if there is no memory)
+*/
+SpuProfile* SpuProfileCreate(size_t cmds_size);
+
+/*!
+    @brief Function that deletes the profile
+    \param [out] profile - pointer on the profile (can be NULL)
+*/
+void SpuProfileDtor(SpuProfile* profile);
+
+/*!
+    @brief Function that writes the report: the opcode mix, the hot ranges (the commands that follow each other
+           with the same count), the hot addresses, the sequences (the pairs and the triples of the commands
+           that run one after another, see SPU_NO_SUPERINSTRUCTIONS) and the CALL targets as text and as JSON
+    \param [in]       profile - pointer on the profile
+    \param [in]       decoded - the decoded code (cmds_size + 1 commands)
+    \param [in] text_filename - name of the text report
+    \param [in] json_filename - name of the JSON report
+    @return The status of the function (return code)
+*/
+SpuProfileReturnCode SpuProfileReport(const SpuProfile* profile, const SpuInstr* decoded,
+                                      const char* text_filename, const char* json_filename);
+
+/*!
+    @brief Function that writes the sampled stacks in the folded format of the flame graphs ("ROOT;CALLEE;LEAF:line count")
+    \param [in]  profile - pointer on the profile
+    \param [in] filename - name of the file
+    @return The status of the function (return code)
+*/
+SpuProfileReturnCode SpuProfileWriteFolded(const SpuProfile* profile, const char* filename);
+
+#endif // SPUPROFILE_H
@@ -0,0 +1,118 @@
+/*!
+    \file
+    File with the cooperative scheduler of the SPUs (green threads): many SPUs of one image are resumed in turn
+    on one OS thread, an SPU yields when its budget is spent or IN has no input yet
+*/
+
+#ifndef SPUSCHEDULER_H
+#define SPUSCHEDULER_H
+
+#include <stdio.h>
+
+#include "SpuMethods.h"
+#include "SpuPool.h"
+
+/// @brief Constant for the default budget of the task (in runs, the commands between the jumps)
+static const long SPU_SCHED_BUDGET = 1 << 12;
+
+/// @brief Constant for the size of the chunk that is read from the input descriptor at once
+static const size_t SPU_SCHED_CHUNK = 4096;
+
+/// @brief Constant for the descriptors below RLIMIT_NOFILE that are left to the rest of the program
+static const size_t SPU_SCHED_RESERVED_FDS = 64;
+
+/// @brief Constant for the wait before the next open when the process has no free descriptors (in ms)
+static const int SPU_SCHED_RETRY_MS = 10;
+
+/// @brief Enum with return codes of the scheduler
+enum SpuSchedReturnCode {
+    SPU_SCHED_SUCCESS      =  0,
+    SPU_SCHED_MEMORY_ERROR = -1,
+    SPU_SCHED_FILE_ERROR   = -2,
+    SPU_SCHED_TASK_ERROR   = -3,
+};
+
+/// @brief Structure with the green thread
+struct SpuTask {
+    SPU*               spu;
+    SpuStatus       status; ///< result of the last CPUResume
+    int           is_ready; ///< 1 if the task is in the ready queue
+    int           input_fd; ///< descriptor that the input queue is filled from (-1 if it is fed by SpuSchedulerFeed)
+    const char* input_name; ///< file that is opened as input_fd when IN waits for the first time (can be NULL)
+    int        input_error; ///< errno of the failed open of input_name, the task is stopped with the error then
+    char*             text; ///< the end of the read input that is not a whole number yet
+    size_t       text_size;
+};
+
+/// @brief Structure with the scheduler
+struct SpuScheduler {
+    const SpuImage*   image; ///< code of all tasks
+    long             budget;
+    SpuTask*          tasks;
+    size_t      tasks_count;
+    size_t   tasks_capacity;
+    size_t*           ready; ///< ring of the indexes of the ready tasks (its capacity is tasks_capacity)
+    size_t       ready_head;
+    size_t      ready_count;
+    size_t       open_limit; ///< input files that are open at once (the others wait for their turn)
+};
+
+/*!
+    @brief Function that creates the scheduler
+    \param [out] sched - pointer on the scheduler (it is freed with SpuSchedulerDtor)
+    \param [in]  image - the code of the tasks (it must live until SpuSchedulerDtor)
+    \param [in] budget - budget of the task in runs (0 for SPU_SCHED_BUDGET)
+*/
+void SpuSchedulerInit(SpuScheduler* sched, const SpuImage* image, long budget);
+
+/*!
+    @brief Function that deletes the tasks and the scheduler (the outputs of the tasks are not closed)
+    \param [out] sched - pointer on the scheduler
+*/
+void SpuSchedulerDtor(SpuScheduler* sched);
+
+/*!
+    @brief Function that adds the ready task
+    \param [out]      sched - pointer on the scheduler
+    \param [in]    input_fd - descriptor of the input (-1 if it is input_name or it is fed by SpuSchedulerFeed)
+    \param [in]  input_name - file of the input, it is opened when the task needs it (can be NULL)
+    \param [in]      output - stream of the output of the task (stdout if it is NULL)
+    \param [out]         id - index of the task (can be NULL)
+    @return The status of the function (return code)
+*/
+SpuSchedReturnCode SpuSchedulerSpawn(SpuScheduler* sched, int input_fd, const char* input_name, FILE* output, size_t* id);
+
+/*!
+    @brief Function that gives the numbers to IN of the task, the waiting task becomes ready
+    \param [out]    sched - pointer on the scheduler
+    \param [in]        id - index of the task
+    \param [in]    values - numbers (not scaled)
+    \param [in]     count - count of the numbers
+    \param [in] is_closed - 1 if there will be no more numbers (IN gets 0 then)
+    @return The status of the function (return code)
+*/
+SpuSchedReturnCode SpuSchedulerFeed(SpuScheduler* sched, size_t id, const int* values, size_t count, int is_closed);
+
+/*!
+    @brief Function that runs the ready tasks in turn, the tasks that wait for their descriptors are polled
+           when nothing is ready. At most open_limit input files are open, the others are opened when
+           the open ones are read to the end
+    \param [out] sched - pointer on the scheduler
+    @return Count of the tasks that wait for SpuSchedulerFeed (the others are finished)
+*/
+size_t SpuSchedulerRun(SpuScheduler* sched);
+
+/*!
+    @brief Function that runs the image for every input file of the list as the green threads,
+           the list is split between the schedulers on threads_count OS threads, the output of the task is "<input>.out"
+           (there is no output for the input that can not be opened)
+    \param [in]         image - pointer on the image
+    \param [in] list_filename - name of the file with the input filenames (one on the line)
+    \param [in]        budget - budget of the task in runs (0 for SPU_SCHED_BUDGET)
+    \param [in] threads_count - count of the schedulers (0 for the count of the online processors)
+    @return The status of the function (return code), SPU_SCHED_FILE_ERROR if any input can not be opened
+*/
+SpuSchedReturnCode SpuSchedulerRunList(const SpuImage* image, const char* list_filename, long budget,
+                                       size_t threads_count);
+
+#endif // SPUSCHEDULER_H
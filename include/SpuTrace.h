@@ -0,0 +1,105 @@
+/*!
+    \file
+    File with the execution trace of the SPU: the last commands (ip, decoded command, top of the stack) are kept
+    in the ring buffer by CPUWork built with -DSPU_TRACE, the ring is dumped to the binary file on HLT, on an error
+    and on the signal, the viewer decodes the file with the symbols of the program
+*/
+
+#ifndef SPUTRACE_H
+#define SPUTRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "SpuMethods.h"
+
+/// @brief Constant for the count of the events in the ring (power of 2)
+static const size_t SPU_TRACE_SIZE = 1 << 16;
+
+/// @brief Constant for the magic of the trace file ("SPUT")
+static const uint32_t SPU_TRACE_MAGIC   = 0x54555053;
+
+/// @brief Constant for the version of the format
+static const uint32_t SPU_TRACE_VERSION = 1;
+
+/// @brief Name of the file that the ring is dumped to
+static const char* const SPU_TRACE_FILENAME = "trace.bin";
+
+/// @brief Enum with return codes of the trace
+enum SpuTraceReturnCode {
+    SPU_TRACE_SUCCESS      =  0,
+    SPU_TRACE_MEMORY_ERROR = -1,
+    SPU_TRACE_FILE_ERROR   = -2,
+    SPU_TRACE_FORMAT_ERROR = -3,
+};
+
+/// @brief Structure with the event: the command before it runs
+struct SpuTraceEvent {
+    int32_t   ip;
+    int32_t  tos; ///< top of the operand stack (0 if it is empty)
+    uint32_t  op; ///< the decoded command (SpuOp)
+};
+
+/// @brief Structure with the header of the file, the events follow it from the oldest one
+struct SpuTraceHeader {
+    uint32_t      magic;
+    uint32_t    version;
+    uint32_t event_size; ///< sizeof(SpuTraceEvent)
+    uint32_t      count; ///< events in the file
+    uint64_t      total; ///< events recorded by the run (the older ones are overwritten)
+};
+
+/// @brief Structure with the ring of one SPU, it is written by its thread only (no locks)
+struct SpuTrace {
+    SpuTraceEvent* events; ///< SPU_TRACE_SIZE elements
+    size_t           head; ///< count of the recorded events, the next one goes to head % SPU_TRACE_SIZE
+};
+
+/*!
+    @brief Function that records the command before it runs
+    \param [out] trace - pointer on the trace
+    \param [in]     ip - address of the command
+    \param [in]     op - the decoded command
+    \param [in]    tos - top of the operand stack
+*/
+static inline void SpuTraceRecord(SpuTrace* trace, int ip, SpuOp op, int tos) {
+    SpuTraceEvent* event = &trace->events[trace->head & (SPU_TRACE_SIZE - 1)];
+
+    event->ip  = ip;
+    event->tos = tos;
+    event->op  = (uint32_t) op;
+
+    trace->head++;
+}
+
+/*!
+    @brief Function that creates the empty trace, the last created one is dumped on SIGINT, SIGTERM and SIGUSR1
+           (the program continues after SIGUSR1)
+    @return The pointer on the trace (NULL if there is no memory)
+*/
+SpuTrace* SpuTraceCreate();
+
+/*!
+    @brief Function that deletes the trace
+    \param [out] trace - pointer on the trace (can be NULL)
+*/
+void SpuTraceDtor(SpuTrace* trace);
+
+/*!
+    @brief Function that writes the ring to the file (only the system calls are used, it is called by the signal too)
+    \param [in]    trace - pointer on the trace
+    \param [in] filename - name of the file
+    @return The status of the function (return code)
+*/
+SpuTraceReturnCode SpuTraceDump(const SpuTrace* trace, const char* filename);
+
+/*!
+    @brief Function that prints the events of the trace file with the functions and the lines of the program
+    \param [in]   filename - name of the trace file
+    \param [in] debug_info - the symbols and the lines of the traced program (can be NULL)
+    \param [in]     output - stream of the listing
+    @return The status of the function (return code)
+*/
+SpuTraceReturnCode SpuTraceView(const char* filename, const SpuDebugInfo* debug_info, FILE* output);
+
+#endif // SPUTRACE_H
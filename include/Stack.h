@@ -1,35 +1,574 @@
 /*!
     \file
-    File with the stack structure
+    File with the stack template: Stack<T, Policy, INLINE_CAPACITY> is the growing array of T, the checks of the policy
+    (canaries, poisoning, hashing and dumping) are compile-time constants, the disabled ones leave no fields
+    and no code, so the release policy is the bare vector. The hash is updated by push and pop in O(1),
+    the whole data is verified by StackVerify and once in VERIFY_PERIOD calls (but not more often than once
+    in capacity calls, so the verification is O(1) per call on average)
 */
 
 #ifndef STACK
 #define STACK
 
+#include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <type_traits>
 
-/// @brief Type of elements in stack
-typedef int StackElem_t;
+#include "Tools.h"
 
-/// @brief Structure with debug info (use in DEBUG mode)
+/// @brief Constant for the capacity of the new stack
+static const size_t STACK_START_CAPACITY = 64;
+
+/// @brief Constant for the canary of the structure and of the both ends of the data
+static const uint64_t STACK_KANARY = 0xDEFEC8EDBAADF00D;
+
+/// @brief Constant for the byte of the poisoned (free) elements
+static const unsigned char STACK_POISON = 0xDD;
+
+/// @brief Name of the log of the dumps
+static const char* const STACK_LOG_FILENAME = "log.txt";
+
+/// @brief Enum with the errors of the stack (bits)
+enum StackError {
+    STACK_SUCCESS        = 0,
+    STACK_BAD_PTR        = 1 << 0,
+    STACK_BAD_SIZE       = 1 << 1,
+    STACK_EMPTY          = 1 << 2,
+    STACK_KANARY_DAMAGED = 1 << 3,
+    STACK_HASH_ERROR     = 1 << 4,
+    STACK_POISON_DAMAGED = 1 << 5,
+    STACK_MEMORY_ERROR   = 1 << 6,
+};
+
+//* ================================== policies ================================
+
+/// @brief Policy with all checks: every call verifies the whole stack and is written to STACK_LOG_FILENAME
+struct StackDebugPolicy {
+    static const bool KANARY = true; ///< canaries before the structure and around the data
+    static const bool POISON = true; ///< the free elements are filled with STACK_POISON and checked
+    static const bool HASH   = true; ///< the hash of the structure and the elements is checked on every call
+    static const bool DUMP   = true; ///< every call is dumped to the log (the errors are dumped by any checked policy)
+    static const size_t VERIFY_PERIOD = 0; ///< calls between the verifications of all elements (0 - every call)
+};
+
+/// @brief Policy for the production: all guards, the calls are O(1) on average
+struct StackGuardedPolicy {
+    static const bool KANARY = true;
+    static const bool POISON = true;
+    static const bool HASH   = true;
+    static const bool DUMP   = false;
+    static const size_t VERIFY_PERIOD = 1024;
+};
+
+/// @brief Policy without checks: the stack is the data, the size and the capacity only
+struct StackReleasePolicy {
+    static const bool KANARY = false;
+    static const bool POISON = false;
+    static const bool HASH   = false;
+    static const bool DUMP   = false;
+    static const size_t VERIFY_PERIOD = 0;
+};
+
+/// @brief Calls until the next verification of the whole stack
+template <typename Policy>
+inline size_t StackVerifyPeriod(size_t capacity) {
+    if (Policy::VERIFY_PERIOD == 0) return 1;
+
+    return Policy::VERIFY_PERIOD > capacity ? Policy::VERIFY_PERIOD : capacity;
+}
+
+//* -DSPU_GUARDED_STACK keeps the guards in the optimized build: make release SPU_FLAGS=-DSPU_GUARDED_STACK
+#if defined(DEBUG)
+    typedef StackDebugPolicy   StackDefaultPolicy;
+#elif defined(SPU_GUARDED_STACK)
+    typedef StackGuardedPolicy StackDefaultPolicy;
+#else
+    typedef StackReleasePolicy StackDefaultPolicy;
+#endif
+
+/// @brief 1 if the policy has any check (the stack keeps its debug info then)
+template <typename Policy>
+constexpr bool StackIsChecked() {
+    return Policy::KANARY || Policy::POISON || Policy::HASH || Policy::DUMP;
+}
+
+//* =================================== fields =================================
+
+/// @brief Bytes before the elements in the data allocation
+template <typename Policy>
+constexpr size_t StackHeadSize() {
+    return Policy::KANARY ? sizeof(STACK_KANARY) : 0;
+}
+
+/// @brief Bytes of the data allocation: the elements and the canaries around them
+template <typename T, typename Policy>
+constexpr size_t StackAllocSize(size_t capacity) {
+    return capacity * sizeof(T) + 2 * StackHeadSize<Policy>();
+}
+
+/// @brief Structure with debug info (the place of the initialization and the found errors)
 struct DebugInfo {
     const char* filename;
     const char*     func;
     const char* var_name;
     int             line;
-    int         err_bits;
+    int         err_bits; ///< StackError bits
 };
 
-/// @brief Structure stack with all information about it
-struct Stack {
-    long int    RightKanary;
-    DebugInfo*   debug_info;
-    size_t            hash1;
-    StackElem_t*       data;
-    size_t             size;
-    size_t         capacity;
-    size_t            hash2;
-    long int     LeftKanary;
+/// @brief The fields of the checks, the disabled check is the empty base
+template <bool IS_ENABLED> struct StackKanaryField { uint64_t     kanary; };
+template <>                struct StackKanaryField<false> {};
+template <bool IS_ENABLED> struct StackInfoField   { DebugInfo debug_info; size_t verify_countdown; };
+template <>                struct StackInfoField<false> {};
+template <bool IS_ENABLED> struct StackHashField   { uint64_t elems_hash; uint64_t hash; };
+template <>                struct StackHashField<false> {};
+
+/// @brief The buffer of the first INLINE_CAPACITY elements with their canaries (there is no one if it is 0)
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+struct StackInlineField { alignas(T) alignas(uint64_t) char inline_raw[StackAllocSize<T, Policy>(INLINE_CAPACITY)]; };
+template <typename T, typename Policy>
+struct StackInlineField<T, Policy, 0> {};
+
+/*!
+    @brief Structure with the stack of T (T is moved by memcpy and realloc). The stack with INLINE_CAPACITY keeps
+           that many elements in itself and allocates the data only when it grows further, such stack must not be
+           copied (data can point into it), it is created in place by STACK_CREATE
+*/
+template <typename T, typename Policy = StackDefaultPolicy, size_t INLINE_CAPACITY = 0>
+struct Stack : StackKanaryField<Policy::KANARY>, StackInfoField<StackIsChecked<Policy>()>, StackHashField<Policy::HASH>,
+               StackInlineField<T, Policy, INLINE_CAPACITY> {
+    T*         data;
+    size_t     size;
+    size_t capacity;
 };
 
-#endif // STACK
\ No newline at end of file
+static_assert(sizeof(Stack<int, StackReleasePolicy>) == sizeof(int*) + 2 * sizeof(size_t),
+              "The release stack must have no fields of the checks");
+
+//* =================================== helpers ================================
+
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline char* StackRawData(const Stack<T, Policy, INLINE_CAPACITY>* st) {
+    return (char*) st->data - StackHeadSize<Policy>();
+}
+
+/// @brief 1 if the elements are in the inline buffer of the stack
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline int StackIsInline(const Stack<T, Policy, INLINE_CAPACITY>* st) {
+    if constexpr (INLINE_CAPACITY > 0) return StackRawData(st) == st->inline_raw;
+    else                               return 0;
+}
+
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline void StackSetKanaries(Stack<T, Policy, INLINE_CAPACITY>* st) {
+    if constexpr (Policy::KANARY) {
+        memcpy(StackRawData(st), &STACK_KANARY, sizeof(STACK_KANARY));
+        memcpy(st->data + st->capacity, &STACK_KANARY, sizeof(STACK_KANARY));
+    }
+}
+
+//* the hash of the elements is the sum of the mixed hashes of the element and its index,
+//* so push adds the term of the new top and pop subtracts it (the index catches the swapped elements)
+
+/// @brief Mixes the bits of the value (the finalizer of splitmix64)
+inline uint64_t StackMix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+/// @brief The term of the element at the index in the hash of the elements
+template <typename T>
+inline uint64_t StackElemHash(const T& elem, size_t index) {
+    uint64_t hash = 14695981039346656037ull;
+
+    const unsigned char* bytes = (const unsigned char*) &elem;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return StackMix(hash + (index + 1) * 0x9E3779B97F4A7C15ull);
+}
+
+/// @brief The hash of all elements counted again (O(size), it is compared with the kept one)
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline uint64_t StackElemsHash(const Stack<T, Policy, INLINE_CAPACITY>* st) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < st->size; i++) hash += StackElemHash(st->data[i], i);
+
+    return hash;
+}
+
+/// @brief The hash of the structure: the kept hash of the elements, the size, the capacity and the address of the data
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline uint64_t StackHash(const Stack<T, Policy, INLINE_CAPACITY>* st) {
+    uint64_t hash = StackMix(st->elems_hash ^ st->size);
+    hash = StackMix(hash ^ st->capacity);
+    hash = StackMix(hash ^ (uintptr_t) st->data);
+
+    return hash;
+}
+
+/// @brief Prints the element to the dump (the types without the overload are printed as bytes)
+template <typename T>
+inline void StackPrintElem(FILE* file, const T& elem) {
+    const unsigned char* bytes = (const unsigned char*) &elem;
+    for (size_t i = 0; i < sizeof(T); i++) fprintf(file, "%02x", bytes[i]);
+}
+
+inline void StackPrintElem(FILE* file, const int& elem) {
+    fprintf(file, "%d", elem);
+}
+
+//* ==================================== checks ================================
+
+/// @brief 1 if all bytes are STACK_POISON
+inline int StackIsPoisoned(const void* memory, size_t size) {
+    const unsigned char* bytes = (const unsigned char*) memory;
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != STACK_POISON) return 0;
+    }
+
+    return 1;
+}
+
+/*!
+    @brief Function that checks the stack by its policy in O(1): the canaries, the hash of the structure
+           and the poison of the next free element
+    \param [in] st - the pointer on Stack structer
+    @return StackError bits of the found errors (STACK_SUCCESS if there are none)
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline int StackVerifyFast(const Stack<T, Policy, INLINE_CAPACITY>* st) {
+    if (!st || !st->data) return STACK_BAD_PTR;
+    if (st->size > st->capacity) return STACK_BAD_SIZE;
+
+    int error = STACK_SUCCESS;
+
+    if constexpr (Policy::KANARY) {
+        if (st->kanary != STACK_KANARY ||
+            memcmp(StackRawData(st), &STACK_KANARY, sizeof(STACK_KANARY)) ||
+            memcmp(st->data + st->capacity, &STACK_KANARY, sizeof(STACK_KANARY))) error |= STACK_KANARY_DAMAGED;
+    }
+
+    if constexpr (Policy::HASH) {
+        if (st->hash != StackHash(st)) error |= STACK_HASH_ERROR;
+    }
+
+    if constexpr (Policy::POISON) {
+        if (st->size < st->capacity && !StackIsPoisoned(st->data + st->size, sizeof(T))) error |= STACK_POISON_DAMAGED;
+    }
+
+    return error;
+}
+
+/*!
+    @brief Function that checks the whole stack by its policy: the elements are hashed again and all free elements
+           are checked for the poison (O(capacity))
+    \param [in] st - the pointer on Stack structer
+    @return StackError bits of the found errors (STACK_SUCCESS if there are none)
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline int StackVerify(const Stack<T, Policy, INLINE_CAPACITY>* st) {
+    int error = StackVerifyFast(st);
+    if (error & (STACK_BAD_PTR | STACK_BAD_SIZE)) return error;
+
+    if constexpr (Policy::HASH) {
+        if (st->elems_hash != StackElemsHash(st)) error |= STACK_HASH_ERROR;
+    }
+
+    if constexpr (Policy::POISON) {
+        if (!StackIsPoisoned(st->data + st->size, (st->capacity - st->size) * sizeof(T))) error |= STACK_POISON_DAMAGED;
+    }
+
+    return error;
+}
+
+/*!
+    @brief Function that writes the stack to STACK_LOG_FILENAME (it is empty for the policies without checks)
+    \param [in]   st - the pointer on Stack structer
+    \param [in] func - the function of the stack that dumps it
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline void StackDump(const Stack<T, Policy, INLINE_CAPACITY>* st, const char* func) {
+    if constexpr (StackIsChecked<Policy>()) {
+        FILE* log_file = fopen(STACK_LOG_FILENAME, "a");
+        if (!log_file) {
+            fprintf(stderr, RED("Error occured while opening the stack log!\n"));
+            return;
+        }
+
+        time_t time_now = time(NULL);
+        struct tm tm = *localtime(&time_now);
+
+        const DebugInfo* info = &st->debug_info;
+        fprintf(log_file, "DUMPED %d-%02d-%02d %02d:%02d:%02d\n",
+                tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+        fprintf(log_file, "Stack [%p] {%s} %s: %d (%s), from %s {\n",
+                (const void*) st, info->var_name, info->filename, info->line, info->func, func);
+
+        for (int bit = 1; bit <= STACK_MEMORY_ERROR; bit <<= 1) {
+            if (info->err_bits & bit) fprintf(log_file, "\t>>> ERROR %d\n", bit);
+        }
+
+        fprintf(log_file, "\tsize = %lu,\n\tcapacity = %lu,\n\tdata [%p] {\n", st->size, st->capacity, (void*) st->data);
+        for (size_t i = 0; st->data && i < st->capacity; i++) {
+            fprintf(log_file, "\t\t%c [%lu] ", i < st->size ? '*' : ' ', i);
+            StackPrintElem(log_file, st->data[i]);
+            fputs(i < st->size ? "\n" : " (POISON)\n", log_file);
+        }
+        fprintf(log_file, "\t}\n}\n\n");
+
+        fclose(log_file);
+    }
+}
+
+/// @brief Dumps the damaged stack and stops the program
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline void StackFail(Stack<T, Policy, INLINE_CAPACITY>* st, int error, const char* func) {
+    if constexpr (StackIsChecked<Policy>()) {
+        st->debug_info.err_bits |= error;
+        StackDump(st, func);
+        fprintf(stderr, RED("STACK %s IS DAMAGED IN %s (see %s)!\n"), st->debug_info.var_name, func, STACK_LOG_FILENAME);
+        assert(0);
+    }
+}
+
+/// @brief Checks the stack before the call, the whole stack is checked once in StackVerifyPeriod calls
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline void StackCheck(Stack<T, Policy, INLINE_CAPACITY>* st, const char* func) {
+    if constexpr (StackIsChecked<Policy>()) {
+        int error = StackVerifyFast(st);
+
+        if (!error && --st->verify_countdown == 0) {
+            st->verify_countdown = StackVerifyPeriod<Policy>(st->capacity);
+            error = StackVerify(st);
+        }
+
+        if (error) StackFail(st, error, func);
+    }
+}
+
+/// @brief Updates the hash of the structure after the change and dumps the call
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline void StackSeal(Stack<T, Policy, INLINE_CAPACITY>* st, const char* func) {
+    if constexpr (Policy::HASH) st->hash = StackHash(st);
+    if constexpr (Policy::DUMP) StackDump(st, func);
+}
+
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline int StackResize(Stack<T, Policy, INLINE_CAPACITY>* st, size_t capacity) {
+    char* raw = NULL;
+
+    //* the inline buffer is left for the heap: the elements, the poison and the canary before them are copied
+    if (StackIsInline(st)) {
+        raw = (char*) malloc(StackAllocSize<T, Policy>(capacity));
+        if (raw) memcpy(raw, StackRawData(st), StackHeadSize<Policy>() + st->capacity * sizeof(T));
+    }
+    else raw = (char*) realloc(StackRawData(st), StackAllocSize<T, Policy>(capacity));
+
+    if (!raw) return STACK_MEMORY_ERROR;
+
+    st->data = (T*) (raw + StackHeadSize<Policy>());
+    if constexpr (Policy::POISON) {
+        if (capacity > st->capacity) memset(st->data + st->capacity, STACK_POISON, (capacity - st->capacity) * sizeof(T));
+    }
+    st->capacity = capacity;
+    StackSetKanaries(st);
+
+    return STACK_SUCCESS;
+}
+
+//* ================================== functions ===============================
+
+/*!
+    @brief Function that creates the empty stack, the data is not allocated if the capacity fits the inline buffer
+           (the elements are not touched then without the poison, so the creation is O(1))
+    \param [out]      st - the pointer on Stack structer
+    \param [in] capacity - the capacity of the data
+    @return The status of the function (StackError)
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline int StackCtor(Stack<T, Policy, INLINE_CAPACITY>* st, size_t capacity) {
+    static_assert(std::is_trivially_copyable<T>::value, "The elements of the stack are moved by memcpy");
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (capacity == 0) capacity = 1;
+
+    char* raw = NULL;
+    if constexpr (INLINE_CAPACITY > 0) {
+        if (capacity <= INLINE_CAPACITY) {
+            raw      = st->inline_raw;
+            capacity = INLINE_CAPACITY;
+        }
+    }
+
+    if (!raw) raw = (char*) malloc(StackAllocSize<T, Policy>(capacity));
+    if (!raw) return STACK_MEMORY_ERROR;
+
+    st->data     = (T*) (raw + StackHeadSize<Policy>());
+    st->size     = 0;
+    st->capacity = capacity;
+
+    if constexpr (Policy::KANARY) st->kanary = STACK_KANARY;
+    if constexpr (Policy::POISON) memset(st->data, STACK_POISON, capacity * sizeof(T));
+    if constexpr (Policy::HASH)   st->elems_hash = 0;
+    if constexpr (StackIsChecked<Policy>()) st->verify_countdown = StackVerifyPeriod<Policy>(capacity);
+    StackSetKanaries(st);
+    StackSeal(st, __func__);
+
+    return STACK_SUCCESS;
+}
+
+/*!
+    @brief Function that creates the stack in place (the stack of the structure or of the function), the stack
+           with the inline buffer starts in it, the place of the call is kept for the dumps
+    \param [out]      st - the pointer on Stack structer
+    \param [in]     file - file in which was called function
+    \param [in]     func - function in which was called function
+    \param [in]     line - line in which was called function
+    \param [in] var_name - the name of variable with stack
+    @return The status of the function (StackError)
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline int StackCreate(Stack<T, Policy, INLINE_CAPACITY>* st, const char* file, const char* func, int line,
+                       const char* var_name) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if constexpr (StackIsChecked<Policy>()) st->debug_info = {file, func, var_name, line, STACK_SUCCESS};
+
+    return StackCtor(st, INLINE_CAPACITY > 0 ? INLINE_CAPACITY : STACK_START_CAPACITY);
+}
+
+/// @brief Macros for the creation of the stack in place: the stack variable is created
+#define STACK_CREATE(st) StackCreate(&(st), __FILE__, __func__, __LINE__, #st)
+
+/*!
+    @brief Function that allocates and creates the stack, the place of the call is kept for the dumps
+    \param [out]      st - the pointer on the pointer on the stack, it gets the new stack
+    \param [in]     file - file in which was called function
+    \param [in]     func - function in which was called function
+    \param [in]     line - line in which was called function
+    \param [in] var_name - the name of variable with stack
+    @return The new stack (NULL if there is no memory)
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline Stack<T, Policy, INLINE_CAPACITY>* StackInit(Stack<T, Policy, INLINE_CAPACITY>** st, const char* file,
+                                                    const char* func, int line, const char* var_name) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    *st = (Stack<T, Policy, INLINE_CAPACITY>*) calloc(1, sizeof(Stack<T, Policy, INLINE_CAPACITY>));
+    if (!*st) return NULL;
+
+    if (StackCreate(*st, file, func, line, var_name) != STACK_SUCCESS) FREE(*st);
+
+    return *st;
+}
+
+/// @brief Macros for stack initialization: the stack variable gets the new stack
+#define STACK_INIT(st) StackInit(&(st), __FILE__, __func__, __LINE__, #st)
+
+/*!
+    @brief Function that destroys the stack created in place (its data is freed unless it is inline)
+    \param [in] st - the pointer on Stack structer
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline void StackDestroy(Stack<T, Policy, INLINE_CAPACITY>* st) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!st->data) return;
+
+    StackCheck(st, __func__);
+
+    if (!StackIsInline(st)) free(StackRawData(st));
+    st->data     = NULL;
+    st->size     = 0;
+    st->capacity = 0;
+}
+
+/*!
+    @brief Function that destroys the stack and frees it
+    \param [in] st - the pointer on Stack structer (can be NULL)
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline void StackDtor(Stack<T, Policy, INLINE_CAPACITY>* st) {
+    if (!st) return;
+
+    StackDestroy(st);
+    free(st);
+}
+
+/*!
+    @brief Function that pushs new value in end of stack
+    \param [in] st    - the pointer on Stack structer
+    \param [in] value - the value which will push in last place in stack
+    @return The status of the function (StackError)
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline int StackPush(Stack<T, Policy, INLINE_CAPACITY>* st, const T& value) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+    StackCheck(st, __func__);
+
+    if (st->size == st->capacity) {
+        int error = StackResize(st, st->capacity * 2);
+        if (error) return error;
+    }
+
+    if constexpr (Policy::HASH) st->elems_hash += StackElemHash(value, st->size);
+    st->data[st->size++] = value;
+
+    StackSeal(st, __func__);
+
+    return STACK_SUCCESS;
+}
+
+/*!
+    @brief Function that gets last element in stack (the empty stack is the error of the caller,
+           it is caught by the checked policies)
+    \param [in] st - the pointer on Stack structer
+    @return The last element
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline T StackPop(Stack<T, Policy, INLINE_CAPACITY>* st) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+    StackCheck(st, __func__);
+
+    if constexpr (StackIsChecked<Policy>()) {
+        if (st->size == 0) {
+            StackFail(st, STACK_EMPTY, __func__);
+            return T();
+        }
+    }
+    ASSERT(st->size > 0, "THE STACK IS EMPTY!\n");
+
+    T value = st->data[--st->size];
+
+    if constexpr (Policy::HASH)   st->elems_hash -= StackElemHash(value, st->size);
+    if constexpr (Policy::POISON) memset(st->data + st->size, STACK_POISON, sizeof(T));
+    StackSeal(st, __func__);
+
+    return value;
+}
+
+/*!
+    @brief Function that cleans the stack
+    \param [in] st - the pointer on Stack structer
+*/
+template <typename T, typename Policy, size_t INLINE_CAPACITY>
+inline void StackClean(Stack<T, Policy, INLINE_CAPACITY>* st) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+    StackCheck(st, __func__);
+
+    if constexpr (Policy::POISON) memset(st->data, STACK_POISON, st->size * sizeof(T));
+    if constexpr (Policy::HASH)   st->elems_hash = 0;
+    st->size = 0;
+
+    StackSeal(st, __func__);
+}
+
+#endif // STACK
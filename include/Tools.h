@@ -14,6 +14,9 @@ static const size_t MAXLINE   = 50;
 static const size_t FUNC_STACK_SIZE = 20;
 static const size_t RAM_SIZE = 900;
 
+/// @brief Constant for calculation accuracy (fixed point scale of the values on the SPU stack)
+static const int CALC_ACCURACY = 2;
+
 #define END         "\033[0;0m"
 #define BLACK_CLR   "\033[1;30m"
 #define RED_CLR     "\033[1;31m"
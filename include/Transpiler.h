@@ -0,0 +1,36 @@
+/*!
+    \file
+    File with the ahead-of-time back end: the resolved program is written as a C source file
+*/
+
+#ifndef TRANSPILER_H
+#define TRANSPILER_H
+
+#include <stdio.h>
+
+#include "Interpreter.h"
+
+/// @brief Enum with return codes of the transpiler
+enum TranspileReturnCode {
+    TRANSPILE_SUCCESS        =  0,
+    TRANSPILE_FILE_ERROR     = -1,
+    TRANSPILE_SEMANTIC_ERROR = -2,
+};
+
+/*!
+    @brief Function that writes the program as C code with the fixed point arithmetic of the SPU
+    \param [in] program - pointer on the program with resolved names (InterpBuild)
+    \param [in]     out - pointer on the output file
+    @return The status of the function (return code)
+*/
+TranspileReturnCode TranspileToC(const ExecProgram* program, FILE* out);
+
+/*!
+    @brief Function that writes the program as C code to the file
+    \param [in]  program - pointer on the program with resolved names (InterpBuild)
+    \param [in] filename - name of the C file
+    @return The status of the function (return code)
+*/
+TranspileReturnCode WriteC(const ExecProgram* program, const char* filename);
+
+#endif // TRANSPILER_H
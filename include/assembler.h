@@ -9,74 +9,48 @@
 #include <stdio.h>
 
 #include "Tools.h"
-#include "ReturnCodes.h"
+#include "CodeGen.h"
 
-/// @brief Constant for the input filename
-static const char* INPUT_FILENAME  = "/home/yan/projects/processor/tests/program.asm";
-
-/// @brief Constant for thу output filename
-static const char* OUTPUT_FILENAME = "/home/yan/projects/processor/tests/assembler_code.txt";
+/// @brief Enum with return codes of the assembler
+enum AsmReturnCode {
+    ASM_SUCCESS      =  0,
+    ASM_MEMORY_ERROR = -1,
+    ASM_FILE_ERROR   = -2,
+    ASM_SYNTAX_ERROR = -3,
+    ASM_LABEL_ERROR  = -4,
+};
 
 /*!
     @brief Function that get register value from argument of command
-    \param [in] cmd - command
-*/
-Reg GetRegValue(char* cmd);
-
-/*!
-    @brief Function that skip comments in assembler code
-    \param [out] curr_line - current line
-*/
-FuncReturn SkipAsmComments(char* curr_line);
-
-/*!
-    @brief Function that get arguments from the command line
-    \param [in] argc - argument count
-    \param [in] argv - argument values
-*/
-FuncReturn GetCommandsArgs(int argc,  char* argv[]);
-
-/*!
-    @brief Function that fill the argument type with bits if necessary
-    \param [in]  arg      - command argument
-    \param [out] arg_type - type of argument
-*/
-FuncReturn FillArgType(char* arg, int* arg_type);
-
-/*!
-    @brief Function that that generates arguments for Push and Pop
-    \param [in]  cmds - array with commands
-    \param [out] ip   - instruction pointer
-    \param [in]  arg  - argument
-*/
-FuncReturn PushPopFill(int* cmds, int* ip, char* arg);
-
-/*!
-    @brief Function that search a constant in command argument
-    \param [out] str     - argument
-    \param [in]  str_len - length of the argument
+    \param [in]    name - name of the register (not null-terminated)
+    \param [in]  length - length of the name
+    @return The register (-1 if it is not a register)
 */
-char* SearchConstPtr(char* str, size_t str_len);
+int GetRegValue(const char* name, size_t length);
 
 /*!
-    @brief Function that formats the text command to code type
-    \param [in]  cmd          - command
-    \param [out] machine_code - future formatted machine code
+    @brief Function that formats the text command to code type (mnemonics are hashed, the case is ignored)
+    \param [in]    name - mnemonic (not null-terminated)
+    \param [in]  length - length of the mnemonic
+    @return The code of the command (0 if it is not a command)
 */
-void FromTextToCode(char* cmd, int* machine_code);
+int FromTextToCode(const char* name, size_t length);
 
 /*!
-    @brief Assembler function
-    \param [in] input_file  - input filename
-    \param [in] output_file - output filename
+    @brief Function that assembles the source in one pass, jumps to the labels below are patched at the end
+    \param  [in]      source - text of the program
+    \param  [in] source_size - length of the text
+    \param [out]    bytecode - pointer on the code and the labels as symbols (it is freed with BytecodeDtor)
+    @return The status of the function (return code)
 */
-void Assembler(FILE* input_file, FILE* output_file);
+AsmReturnCode Assemble(const char* source, size_t source_size, Bytecode* bytecode);
 
 /*!
-    @brief Function that formats the received argument
-    \param [in] push_arg_unformated - unformatted argument
-    \param [in] push_arg            - future formatted argument
+    @brief Assembler function: reads the whole file and assembles it
+    \param  [in] input_filename - input filename
+    \param [out]       bytecode - pointer on the code and the labels as symbols (it is freed with BytecodeDtor)
+    @return The status of the function (return code)
 */
-FuncReturn FormateArg(char* push_arg_unformated, char* push_arg);
+AsmReturnCode Assembler(const char* input_filename, Bytecode* bytecode);
 
-#endif // ASSEMBLER_H
\ No newline at end of file
+#endif // ASSEMBLER_H
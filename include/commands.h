@@ -19,4 +19,7 @@ DEF_COMMAND_(MOD)
 DEF_COMMAND_(IDIV)
 DEF_COMMAND_(SQR)
 DEF_COMMAND_(JGE)
-DEF_COMMAND_(DRAW)
\ No newline at end of file
+DEF_COMMAND_(DRAW)
+DEF_COMMAND_(JEP)
+DEF_COMMAND_(JNEP)
+DEF_COMMAND_(JGEP)
\ No newline at end of file
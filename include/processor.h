@@ -7,8 +7,8 @@
 
 #include "SpuMethods.h"
 
-/// @brief Constant for the input filename
-static const char* INPUT_FILENAME  = "/home/yan/projects/processor/tests/assembler_code.txt";
+/// @brief Input filename (defined in main.cpp, shared with the front end)
+extern const char* INPUT_FILENAME;
 
 /*!
     @brief Function that get arguments from the command line
@@ -17,14 +17,39 @@ static const char* INPUT_FILENAME  = "/home/yan/projects/processor/tests/assembl
 */
 void GetCommandsArgs(int argc,  char* argv[]);
 
+/*!
+    @brief Function that decodes the code of the SPU at every address, the result is kept in spu->decoded
+    \param [out] spu - the pointer on the spu struct
+    @return 1 if the code is decoded, 0 if there is no memory
+*/
+int SpuDecode(SPU* spu);
+
+/*!
+    @brief Function that tells if the command ends the run: the next command is not the following word
+           (or GetArg decides it)
+    \param [in] op - the decoded command
+    @return 1 if the command ends the run
+*/
+int SpuIsRunEnd(SpuOp op);
+
 /*!
     @brief Function that launched processor
     \param [in] spu - the pointer on SPU struct
 */
 void CPUWork(SPU* spu);
 
+/*!
+    @brief Function that runs the processor from spu->ip until HLT, an error, the end of the budget or IN
+           that waits for the input queue (the stacks are kept in the SPU then and the next call continues)
+    \param [in]    spu - the pointer on SPU struct
+    \param [in] budget - count of the runs (the commands between the jumps) before the yield
+    @return The state of the SPU
+*/
+SpuStatus CPUResume(SPU* spu, long budget);
+
 /*!
     @brief Function that get argument for the processor commands
     \param [in] spu- the pointer on the spu struct
+    @return The pointer on the argument (NULL if the address is out of RAM or there is no argument, it is printed)
 */
 int* GetArg (SPU* spu);
\ No newline at end of file
@@ -0,0 +1,51 @@
+DEF_SPU_OP_(UNKNOWN)
+DEF_SPU_OP_(HLT)
+DEF_SPU_OP_(PUSH_REG)
+DEF_SPU_OP_(PUSH_CONST)
+DEF_SPU_OP_(PUSH_REG_CONST)
+DEF_SPU_OP_(PUSH_MEM_REG)
+DEF_SPU_OP_(PUSH_MEM_CONST)
+DEF_SPU_OP_(PUSH_MEM_REG_CONST)
+DEF_SPU_OP_(PUSH_ARG)
+DEF_SPU_OP_(POP_REG)
+DEF_SPU_OP_(POP_XX)
+DEF_SPU_OP_(POP_MEM_REG)
+DEF_SPU_OP_(POP_MEM_CONST)
+DEF_SPU_OP_(POP_MEM_REG_CONST)
+DEF_SPU_OP_(POP_ARG)
+DEF_SPU_OP_(ADD)
+DEF_SPU_OP_(SUB)
+DEF_SPU_OP_(DIV)
+DEF_SPU_OP_(MUL)
+DEF_SPU_OP_(IN)
+DEF_SPU_OP_(OUT)
+DEF_SPU_OP_(JMP)
+DEF_SPU_OP_(CALL)
+DEF_SPU_OP_(RET)
+DEF_SPU_OP_(SQRT)
+DEF_SPU_OP_(SQR)
+DEF_SPU_OP_(MOD)
+DEF_SPU_OP_(IDIV)
+DEF_SPU_OP_(JNE)
+DEF_SPU_OP_(JGE)
+DEF_SPU_OP_(JE)
+DEF_SPU_OP_(JLZ)
+DEF_SPU_OP_(JGZ)
+DEF_SPU_OP_(JEP)
+DEF_SPU_OP_(JNEP)
+DEF_SPU_OP_(JGEP)
+DEF_SPU_OP_(DRAW)
+DEF_SPU_OP_(POP_PUSH_REG)
+DEF_SPU_OP_(PUSH_REG_REG)
+DEF_SPU_OP_(ADD_REG_CONST)
+DEF_SPU_OP_(SUB_REG_CONST)
+DEF_SPU_OP_(MUL_REG_CONST)
+DEF_SPU_OP_(ADD_REG_REG)
+DEF_SPU_OP_(SUB_REG_REG)
+DEF_SPU_OP_(MUL_REG_REG)
+DEF_SPU_OP_(JEP_REG)
+DEF_SPU_OP_(JNEP_REG)
+DEF_SPU_OP_(JGEP_REG)
+DEF_SPU_OP_(JEP_CONST)
+DEF_SPU_OP_(JNEP_CONST)
+DEF_SPU_OP_(JGEP_CONST)
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define CALC_ACCURACY 2
+
+static inline void lang_error(const char* message) {
+    printf("%s", message);
+    exit(1);
+}
+
+static inline int lang_trunc(int value) {
+    return value / CALC_ACCURACY * CALC_ACCURACY;
+}
+
+static inline int lang_div(int left, int right) {
+    if (right == 0) lang_error("\033[1;31mERROR! DIVISION BY ZERO!!!\n\033[0;0m");
+    return CALC_ACCURACY * left / right;
+}
+
+static inline int lang_sqrt(int value) {
+    if (value / CALC_ACCURACY < 0) lang_error("\033[1;31mSQRT ERROR!\n\033[0;0m");
+    return (int) sqrt(value / CALC_ACCURACY) * CALC_ACCURACY;
+}
+
+static inline void lang_print(int value) {
+    printf("\033[1;32mRESULT: %lg\n\033[0;0m", (double) value / CALC_ACCURACY);
+}
+
+static inline int lang_scan(void) {
+    int value = 0;
+    printf("\033[1;33mEnter a number: \033[0;0m"); if (scanf("%d", &value) != 1) value = 0;
+    return value * CALC_ACCURACY;
+}
+
+static int f0(void);
+static int f1(void);
+
+/* ЛЕКЦИЯ */
+static int f0(void) {
+    int s0 = 0;
+    int s1 = 0;
+    s0 = lang_trunc(0);
+    s1 = lang_trunc(2);
+    s0 = lang_scan();
+    while (1) {
+        int t0 = (s0 > 0) * CALC_ACCURACY;
+        if (t0 == 0) break;
+        int t1 = s1 * s0 / CALC_ACCURACY;
+        s1 = lang_trunc(t1);
+        int t2 = s0 - 2;
+        s0 = lang_trunc(t2);
+    }
+    lang_print(s1);
+    return 0;
+}
+
+/* main */
+static int f1(void) {
+    int t0 = f0();
+    (void) t0;
+    return 0;
+}
+
+int main(void) {
+    f1();
+    return 0;
+}
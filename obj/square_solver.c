@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define CALC_ACCURACY 2
+
+static inline void lang_error(const char* message) {
+    printf("%s", message);
+    exit(1);
+}
+
+static inline int lang_trunc(int value) {
+    return value / CALC_ACCURACY * CALC_ACCURACY;
+}
+
+static inline int lang_div(int left, int right) {
+    if (right == 0) lang_error("\033[1;31mERROR! DIVISION BY ZERO!!!\n\033[0;0m");
+    return CALC_ACCURACY * left / right;
+}
+
+static inline int lang_sqrt(int value) {
+    if (value / CALC_ACCURACY < 0) lang_error("\033[1;31mSQRT ERROR!\n\033[0;0m");
+    return (int) sqrt(value / CALC_ACCURACY) * CALC_ACCURACY;
+}
+
+static inline void lang_print(int value) {
+    printf("\033[1;32mRESULT: %lg\n\033[0;0m", (double) value / CALC_ACCURACY);
+}
+
+static inline int lang_scan(void) {
+    int value = 0;
+    printf("\033[1;33mEnter a number: \033[0;0m"); if (scanf("%d", &value) != 1) value = 0;
+    return value * CALC_ACCURACY;
+}
+
+static int f0(int s0, int s1, int s2);
+static int f1(void);
+static int f2(void);
+
+/* ДИСКРИМИНАНТ */
+static int f0(int s0, int s1, int s2) {
+    int t0 = s1 * s1 / CALC_ACCURACY;
+    int t1 = 8 * s0 / CALC_ACCURACY;
+    int t2 = t1 * s2 / CALC_ACCURACY;
+    int t3 = t0 - t2;
+    return t3;
+    return 0;
+}
+
+/* КВАДРАТКА */
+static int f1(void) {
+    int s0 = 0;
+    int s1 = 0;
+    int s2 = 0;
+    int s3 = 0;
+    int s4 = 0;
+    s0 = lang_trunc(0);
+    s1 = lang_trunc(0);
+    s2 = lang_trunc(0);
+    s0 = lang_scan();
+    s1 = lang_scan();
+    s2 = lang_scan();
+    int t0 = (s0 == 0) * CALC_ACCURACY;
+    if (t0 != 0) {
+        int t1 = (s1 == 0) * CALC_ACCURACY;
+        if (t1 != 0) {
+            int t2 = (s2 == 0) * CALC_ACCURACY;
+            if (t2 != 0) {
+                lang_print(666);
+            }
+            int t3 = (s2 != 0) * CALC_ACCURACY;
+            if (t3 != 0) {
+                lang_print(0);
+            }
+        }
+        int t4 = (s1 != 0) * CALC_ACCURACY;
+        if (t4 != 0) {
+            lang_print(2);
+            int t5 = 0 - s2;
+            int t6 = lang_div(t5, s1);
+            lang_print(t6);
+        }
+    }
+    int t7 = (s0 != 0) * CALC_ACCURACY;
+    if (t7 != 0) {
+        int t8 = lang_trunc(s0);
+        int t9 = lang_trunc(s1);
+        int t10 = lang_trunc(s2);
+        int t11 = f0(t8, t9, t10);
+        s3 = lang_trunc(t11);
+        int t12 = (s3 < 0) * CALC_ACCURACY;
+        if (t12 != 0) {
+            lang_print(0);
+        }
+        int t13 = (s3 == 0) * CALC_ACCURACY;
+        if (t13 != 0) {
+            lang_print(2);
+            int t14 = 0 - s1;
+            int t15 = 4 * s0 / CALC_ACCURACY;
+            int t16 = lang_div(t14, t15);
+            lang_print(t16);
+        }
+        int t17 = (s3 > 0) * CALC_ACCURACY;
+        if (t17 != 0) {
+            int t18 = lang_sqrt(s3);
+            s4 = lang_trunc(t18);
+            lang_print(4);
+            int t19 = 0 - s1;
+            int t20 = t19 - s4;
+            int t21 = 4 * s0 / CALC_ACCURACY;
+            int t22 = lang_div(t20, t21);
+            lang_print(t22);
+            int t23 = 0 - s1;
+            int t24 = t23 + s4;
+            int t25 = 4 * s0 / CALC_ACCURACY;
+            int t26 = lang_div(t24, t25);
+            lang_print(t26);
+        }
+    }
+    return 0;
+}
+
+/* main */
+static int f2(void) {
+    int t0 = f1();
+    (void) t0;
+    return 0;
+}
+
+int main(void) {
+    f2();
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define CALC_ACCURACY 2
+
+static inline void lang_error(const char* message) {
+    printf("%s", message);
+    exit(1);
+}
+
+static inline int lang_trunc(int value) {
+    return value / CALC_ACCURACY * CALC_ACCURACY;
+}
+
+static inline int lang_div(int left, int right) {
+    if (right == 0) lang_error("\033[1;31mERROR! DIVISION BY ZERO!!!\n\033[0;0m");
+    return CALC_ACCURACY * left / right;
+}
+
+static inline int lang_sqrt(int value) {
+    if (value / CALC_ACCURACY < 0) lang_error("\033[1;31mSQRT ERROR!\n\033[0;0m");
+    return (int) sqrt(value / CALC_ACCURACY) * CALC_ACCURACY;
+}
+
+static inline void lang_print(int value) {
+    printf("\033[1;32mRESULT: %lg\n\033[0;0m", (double) value / CALC_ACCURACY);
+}
+
+static inline int lang_scan(void) {
+    int value = 0;
+    printf("\033[1;33mEnter a number: \033[0;0m"); if (scanf("%d", &value) != 1) value = 0;
+    return value * CALC_ACCURACY;
+}
+
+static int f0(int s0, int s1, int s2);
+static int f1(int s0);
+static int f2(void);
+
+/* ЛЕКЦИЯ */
+static int f0(int s0, int s1, int s2) {
+    int s3 = 0;
+    int s4 = 0;
+    int t0 = (162 != 2) * CALC_ACCURACY;
+    if (t0 != 0) {
+        lang_print(456);
+    }
+    s3 = lang_trunc(40);
+    int t1 = s3 + 20;
+    s3 = lang_trunc(t1);
+    s4 = lang_trunc(0);
+    lang_print(s3);
+    return 220;
+    return 0;
+}
+
+/* ФУНЦКИЯ */
+static int f1(int s0) {
+    lang_print(221778);
+    return 0;
+}
+
+/* main */
+static int f2(void) {
+    int t0 = lang_trunc(0);
+    int t1 = f1(t0);
+    (void) t1;
+    return 0;
+}
+
+int main(void) {
+    f2();
+    return 0;
+}
@@ -0,0 +1,674 @@
+/*!
+    \file
+    File with the SPU bytecode emitter: IR with allocated registers -> SPU commands in memory
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CodeGen.h"
+#include "Jit.h"
+#include "ReturnCodes.h"
+#include "SpuMethods.h"
+#include "processor.h"
+
+/// @brief Structure with label: resolved address or chain of the operand words waiting for it
+struct CodeLabel {
+    int address; ///< -1 while the label is not bound
+    int   chain; ///< last operand word referring to the label, every word keeps the previous one (-1 ends)
+};
+
+/// @brief Structure with the state of the code generation
+struct CodeGen {
+    Bytecode*           bytecode;
+    CodeLabel*            labels;
+    size_t          labels_count;
+    size_t       labels_capacity;
+    const IRModule*       module;
+    const IRFunction*       func;
+    const RegAllocation*   alloc;
+    int*                integral; ///< representation of every value: 1 - integer cell, 0 - fixed point cell
+    int               block_base; ///< label of the block 0 of the current function
+    int               next_block; ///< block placed right after the current one or -1
+    int               frame_size;
+    int                 is_entry;
+};
+
+/// @brief Structure with the way comparison is done by the SPU conditional jump
+struct JumpForm {
+    int      first; ///< value pushed first
+    int     second; ///< value pushed second
+    Comands    jcc;
+    int    if_true; ///< 1 if the jump is taken when the comparison is true
+};
+
+//* ================================== code buffer =================================
+
+void BytecodeDtor(Bytecode* bytecode) {
+    ASSERT(bytecode != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FREE(bytecode->code);
+    FREE(bytecode->symbols);
+    FREE(bytecode->lines);
+    bytecode->size           = 0;
+    bytecode->capacity       = 0;
+    bytecode->symbols_count  = 0;
+    bytecode->lines_count    = 0;
+    bytecode->lines_capacity = 0;
+}
+
+static CodeGenReturnCode EmitWord(CodeGen* cg, int word) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    Bytecode* bytecode = cg->bytecode;
+
+    if (bytecode->size >= bytecode->capacity) {
+        size_t new_capacity = bytecode->capacity ? bytecode->capacity * 2 : 256;
+
+        int* new_code = (int*) realloc(bytecode->code, new_capacity * sizeof(int));
+        if (!new_code) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return CODEGEN_MEMORY_ERROR;
+        }
+
+        bytecode->code     = new_code;
+        bytecode->capacity = new_capacity;
+    }
+
+    bytecode->code[bytecode->size++] = word;
+
+    return CODEGEN_SUCCESS;
+}
+
+/// @brief Marks the start of the line at the current address (the same line is not repeated)
+static CodeGenReturnCode AddLine(CodeGen* cg, int line) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    Bytecode* bytecode = cg->bytecode;
+    int address = int(bytecode->size);
+
+    if (line <= 0) return CODEGEN_SUCCESS;
+
+    if (bytecode->lines_count) {
+        SpuExeLine* last = &bytecode->lines[bytecode->lines_count - 1];
+        if (last->line == line) return CODEGEN_SUCCESS;
+        if (last->address == address) {
+            last->line = line;
+            return CODEGEN_SUCCESS;
+        }
+    }
+
+    if (bytecode->lines_count >= bytecode->lines_capacity) {
+        size_t new_capacity = bytecode->lines_capacity ? bytecode->lines_capacity * 2 : 64;
+
+        SpuExeLine* new_lines = (SpuExeLine*) realloc(bytecode->lines, new_capacity * sizeof(SpuExeLine));
+        if (!new_lines) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return CODEGEN_MEMORY_ERROR;
+        }
+
+        bytecode->lines          = new_lines;
+        bytecode->lines_capacity = new_capacity;
+    }
+
+    bytecode->lines[bytecode->lines_count++] = {address, line};
+
+    return CODEGEN_SUCCESS;
+}
+
+static int NewLabel(CodeGen* cg) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (cg->labels_count >= cg->labels_capacity) {
+        size_t new_capacity = cg->labels_capacity ? cg->labels_capacity * 2 : 64;
+
+        CodeLabel* new_labels = (CodeLabel*) realloc(cg->labels, new_capacity * sizeof(CodeLabel));
+        if (!new_labels) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return -1;
+        }
+
+        cg->labels          = new_labels;
+        cg->labels_capacity = new_capacity;
+    }
+
+    cg->labels[cg->labels_count] = {-1, -1};
+
+    return int(cg->labels_count++);
+}
+
+/// @brief Emits the address of the label, unknown addresses are patched when the label is bound
+static CodeGenReturnCode EmitLabel(CodeGen* cg, int label) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    CodeLabel* code_label = &cg->labels[label];
+    if (code_label->address != -1) return EmitWord(cg, code_label->address);
+
+    int position = int(cg->bytecode->size);
+    if (EmitWord(cg, code_label->chain) != CODEGEN_SUCCESS) return CODEGEN_MEMORY_ERROR;
+
+    cg->labels[label].chain = position;
+
+    return CODEGEN_SUCCESS;
+}
+
+static void BindLabel(CodeGen* cg, int label) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    CodeLabel* code_label = &cg->labels[label];
+    code_label->address = int(cg->bytecode->size);
+
+    for (int position = code_label->chain; position != -1;) {
+        int next = cg->bytecode->code[position];
+        cg->bytecode->code[position] = code_label->address;
+        position = next;
+    }
+
+    code_label->chain = -1;
+}
+
+//* =================================== operands ===================================
+
+static CodeGenReturnCode EmitCommand(CodeGen* cg, Comands command) {
+    return EmitWord(cg, command);
+}
+
+static CodeGenReturnCode EmitReg(CodeGen* cg, Comands command, int reg) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    CodeGenReturnCode result = EmitWord(cg, command);
+    if (result == CODEGEN_SUCCESS) result = EmitWord(cg, REG_BIT);
+    if (result == CODEGEN_SUCCESS) result = EmitWord(cg, reg);
+
+    return result;
+}
+
+static CodeGenReturnCode EmitPushConst(CodeGen* cg, int value) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    CodeGenReturnCode result = EmitWord(cg, PUSH);
+    if (result == CODEGEN_SUCCESS) result = EmitWord(cg, CONSTANT_BIT);
+    if (result == CODEGEN_SUCCESS) result = EmitWord(cg, value);
+
+    return result;
+}
+
+/// @brief Emits PUSH or POP with the register or the frame cell [IX + slot]
+static CodeGenReturnCode EmitLocation(CodeGen* cg, Comands command, Location location) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (location.type == LOCATION_REG) return EmitReg(cg, command, AX + location.index);
+
+    CodeGenReturnCode result = EmitWord(cg, command);
+    if (result == CODEGEN_SUCCESS) result = EmitWord(cg, MEMORY_BIT | REG_BIT | CONSTANT_BIT);
+    if (result == CODEGEN_SUCCESS) result = EmitWord(cg, IX);
+    if (result == CODEGEN_SUCCESS) result = EmitWord(cg, location.index);
+
+    return result;
+}
+
+static CodeGenReturnCode EmitJump(CodeGen* cg, Comands command, int label) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    CodeGenReturnCode result = EmitWord(cg, command);
+    if (result == CODEGEN_SUCCESS) result = EmitLabel(cg, label);
+
+    return result;
+}
+
+/// @brief Jumps to the block unless it is placed next
+static CodeGenReturnCode EmitGoto(CodeGen* cg, int block) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (block == cg->next_block) return CODEGEN_SUCCESS;
+
+    return EmitJump(cg, JMP, cg->block_base + block);
+}
+
+//* PUSH multiplies by CALC_ACCURACY and POP divides by it, so integer values are kept in cells as they are.
+//* Values that may have a fraction are kept in the fixed point form: they are scaled by CALC_ACCURACY
+//* (MUL by the pushed CALC_ACCURACY) before POP and unscaled (DIV) after PUSH
+
+/// @brief Pushes the fixed point value on the SPU stack
+static CodeGenReturnCode Load(CodeGen* cg, int value) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    Location location = cg->alloc->locations[value];
+
+    if (location.type == LOCATION_CONST) {
+        int constant = cg->func->instrs[value].value;
+        if (constant % CALC_ACCURACY == 0) return EmitPushConst(cg, constant / CALC_ACCURACY);
+
+        CodeGenReturnCode result = EmitPushConst(cg, constant);
+        if (result == CODEGEN_SUCCESS) result = EmitPushConst(cg, CALC_ACCURACY);
+        if (result == CODEGEN_SUCCESS) result = EmitCommand(cg, DIV);
+
+        return result;
+    }
+
+    if (location.type != LOCATION_REG && location.type != LOCATION_SLOT) {
+        fprintf(stderr, RED("Value %%%d has no location!\n"), value);
+        return CODEGEN_VALUE_ERROR;
+    }
+
+    CodeGenReturnCode result = EmitLocation(cg, PUSH, location);
+    if (!cg->integral[value]) {
+        if (result == CODEGEN_SUCCESS) result = EmitPushConst(cg, CALC_ACCURACY);
+        if (result == CODEGEN_SUCCESS) result = EmitCommand(cg, DIV);
+    }
+
+    return result;
+}
+
+/// @brief Pops the fixed point value from the SPU stack to the value location
+static CodeGenReturnCode Store(CodeGen* cg, int value) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    Location location = cg->alloc->locations[value];
+
+    if (location.type != LOCATION_REG && location.type != LOCATION_SLOT) return EmitReg(cg, POP, XX);
+
+    CodeGenReturnCode result = CODEGEN_SUCCESS;
+    if (!cg->integral[value]) {
+        result = EmitPushConst(cg, CALC_ACCURACY);
+        if (result == CODEGEN_SUCCESS) result = EmitCommand(cg, MUL);
+    }
+
+    if (result == CODEGEN_SUCCESS) result = EmitLocation(cg, POP, location);
+
+    return result;
+}
+
+//* ================================== comparisons =================================
+
+//* the SPU has only JE, JNE and JGE (taken when the second pushed value >= the first one), the jumps
+//* leave both operands on the stack, so each way out of the jump starts with two POP XX
+static JumpForm GetJumpForm(const IRFunction* func, int compare) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRInstr* instr = &func->instrs[compare];
+    int left  = instr->args.data[0];
+    int right = instr->args.data[1];
+
+    switch (instr->opcode) {
+        case IR_EQUAL:      return {left,  right, JE,  1};
+        case IR_NOT_EQUAL:  return {left,  right, JNE, 1};
+        case IR_LESS_EQUAL: return {left,  right, JGE, 1};
+        case IR_MORE_EQUAL: return {right, left,  JGE, 1};
+        case IR_LESS:       return {right, left,  JGE, 0};
+        case IR_MORE:       return {left,  right, JGE, 0};
+
+        case IR_CONST: case IR_PARAM: case IR_PHI: case IR_COPY: case IR_ADD: case IR_SUB: case IR_MUL:
+        case IR_DIV: case IR_SQRT: case IR_TRUNC: case IR_CALL: case IR_SCAN: case IR_PRINT: case IR_JMP:
+        case IR_BRANCH: case IR_RET:
+        default:
+            return {compare, -1, JNE, 1};
+    }
+}
+
+static CodeGenReturnCode EmitDropPair(CodeGen* cg) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    CodeGenReturnCode result = EmitReg(cg, POP, XX);
+    if (result == CODEGEN_SUCCESS) result = EmitReg(cg, POP, XX);
+
+    return result;
+}
+
+/// @brief Pushes the operands and emits the conditional jump to the label
+static CodeGenReturnCode EmitCompareJump(CodeGen* cg, JumpForm form, int label) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    CodeGenReturnCode result = Load(cg, form.first);
+    if (result == CODEGEN_SUCCESS) {
+        result = form.second == -1 ? EmitPushConst(cg, 0) : Load(cg, form.second);
+    }
+    if (result == CODEGEN_SUCCESS) result = EmitJump(cg, form.jcc, label);
+
+    return result;
+}
+
+static CodeGenReturnCode EmitBranch(CodeGen* cg, int index) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRInstr* instr = &cg->func->instrs[index];
+    int condition = instr->args.data[0];
+
+    //* not fused condition is compared with zero
+    JumpForm form = {condition, -1, JNE, 1};
+    if (cg->alloc->locations[condition].type == LOCATION_FUSED) form = GetJumpForm(cg->func, condition);
+
+    int taken     = instr->targets[ form.if_true ? 0 : 1 ];
+    int not_taken = instr->targets[ form.if_true ? 1 : 0 ];
+
+    int label = NewLabel(cg);
+    if (label == -1) return CODEGEN_MEMORY_ERROR;
+
+    CodeGenReturnCode result = EmitCompareJump(cg, form, label);
+    if (result == CODEGEN_SUCCESS) result = EmitDropPair(cg);
+    if (result == CODEGEN_SUCCESS) result = EmitJump(cg, JMP, cg->block_base + not_taken);
+    if (result != CODEGEN_SUCCESS) return result;
+
+    BindLabel(cg, label);
+
+    result = EmitDropPair(cg);
+    if (result == CODEGEN_SUCCESS) result = EmitGoto(cg, taken);
+
+    return result;
+}
+
+/// @brief Materializes the comparison result (0 or 1) that is not fused into a branch
+static CodeGenReturnCode EmitCompare(CodeGen* cg, int index) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    JumpForm form = GetJumpForm(cg->func, index);
+
+    int taken = NewLabel(cg);
+    int end   = NewLabel(cg);
+    if (taken == -1 || end == -1) return CODEGEN_MEMORY_ERROR;
+
+    CodeGenReturnCode result = EmitCompareJump(cg, form, taken);
+    if (result == CODEGEN_SUCCESS) result = EmitDropPair(cg);
+    if (result == CODEGEN_SUCCESS) result = EmitPushConst(cg, !form.if_true);
+    if (result == CODEGEN_SUCCESS) result = EmitJump(cg, JMP, end);
+    if (result != CODEGEN_SUCCESS) return result;
+
+    BindLabel(cg, taken);
+
+    result = EmitDropPair(cg);
+    if (result == CODEGEN_SUCCESS) result = EmitPushConst(cg, form.if_true);
+    if (result != CODEGEN_SUCCESS) return result;
+
+    BindLabel(cg, end);
+
+    return Store(cg, index);
+}
+
+//* ================================= instructions =================================
+
+static CodeGenReturnCode EmitFrameShift(CodeGen* cg, Comands command) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (cg->frame_size == 0) return CODEGEN_SUCCESS;
+
+    CodeGenReturnCode result = EmitReg(cg, PUSH, IX);
+    if (result == CODEGEN_SUCCESS) result = EmitPushConst(cg, cg->frame_size);
+    if (result == CODEGEN_SUCCESS) result = EmitCommand(cg, command);
+    if (result == CODEGEN_SUCCESS) result = EmitReg(cg, POP, IX);
+
+    return result;
+}
+
+//* caller saves the registers live across the call on the stack, arguments are pushed in order,
+//* callee frame starts right after the caller one, the result is left on the stack by RET
+static CodeGenReturnCode EmitCall(CodeGen* cg, int index) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRInstr* instr = &cg->func->instrs[index];
+
+    int saved[ALLOC_REGS_COUNT] = {};
+    int saved_count = RegAllocLiveAcross(cg->alloc, index, saved);
+
+    CodeGenReturnCode result = CODEGEN_SUCCESS;
+    for (int i = 0; i < saved_count && result == CODEGEN_SUCCESS; i++) result = EmitReg(cg, PUSH, AX + saved[i]);
+    for (size_t i = 0; i < instr->args.size && result == CODEGEN_SUCCESS; i++) result = Load(cg, instr->args.data[i]);
+
+    if (result == CODEGEN_SUCCESS) result = EmitFrameShift(cg, ADD);
+    if (result == CODEGEN_SUCCESS) result = EmitJump(cg, CALL, instr->value);
+    if (result == CODEGEN_SUCCESS) result = EmitFrameShift(cg, SUB);
+    if (result == CODEGEN_SUCCESS) result = Store(cg, index);
+
+    for (int i = saved_count - 1; i >= 0 && result == CODEGEN_SUCCESS; i--) result = EmitReg(cg, POP, AX + saved[i]);
+
+    return result;
+}
+
+static CodeGenReturnCode EmitInstr(CodeGen* cg, int index) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRInstr* instr = &cg->func->instrs[index];
+    CodeGenReturnCode result = CODEGEN_SUCCESS;
+
+    switch (instr->opcode) {
+        case IR_CONST: case IR_PARAM: case IR_PHI:
+            //* constants are pushed by the users, parameters are taken in the prologue
+            return CODEGEN_SUCCESS;
+
+        case IR_COPY: {
+            Location dest   = cg->alloc->locations[instr->value];
+            Location source = cg->alloc->locations[ instr->args.data[0] ];
+
+            if (dest.type == source.type && dest.index == source.index &&
+                cg->integral[instr->value] == cg->integral[ instr->args.data[0] ]) return CODEGEN_SUCCESS;
+
+            result = Load(cg, instr->args.data[0]);
+            if (result == CODEGEN_SUCCESS) result = Store(cg, instr->value);
+
+            return result;
+        }
+
+        case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: {
+            static const Comands COMMANDS[] = {ADD, SUB, MUL, DIV};
+
+            result = Load(cg, instr->args.data[0]);
+            if (result == CODEGEN_SUCCESS) result = Load(cg, instr->args.data[1]);
+            if (result == CODEGEN_SUCCESS) result = EmitCommand(cg, COMMANDS[instr->opcode - IR_ADD]);
+            if (result == CODEGEN_SUCCESS) result = Store(cg, index);
+
+            return result;
+        }
+
+        case IR_SQRT:
+            result = Load(cg, instr->args.data[0]);
+            if (result == CODEGEN_SUCCESS) result = EmitCommand(cg, SQRT);
+            if (result == CODEGEN_SUCCESS) result = Store(cg, index);
+
+            return result;
+
+        case IR_TRUNC:
+            //* the result is integer, so POP into its cell drops the fraction
+            result = Load(cg, instr->args.data[0]);
+            if (result == CODEGEN_SUCCESS) result = Store(cg, index);
+
+            return result;
+
+        case IR_LESS: case IR_MORE: case IR_LESS_EQUAL: case IR_MORE_EQUAL: case IR_EQUAL: case IR_NOT_EQUAL:
+            if (cg->alloc->locations[index].type == LOCATION_FUSED) return CODEGEN_SUCCESS;
+
+            return EmitCompare(cg, index);
+
+        case IR_CALL:
+            return EmitCall(cg, index);
+
+        case IR_SCAN:
+            result = EmitCommand(cg, IN);
+            if (result == CODEGEN_SUCCESS) result = Store(cg, index);
+
+            return result;
+
+        case IR_PRINT:
+            result = Load(cg, instr->args.data[0]);
+            if (result == CODEGEN_SUCCESS) result = EmitCommand(cg, OUT);
+
+            return result;
+
+        case IR_JMP:
+            return EmitGoto(cg, instr->targets[0]);
+
+        case IR_BRANCH:
+            return EmitBranch(cg, index);
+
+        case IR_RET:
+            result = Load(cg, instr->args.data[0]);
+            if (result == CODEGEN_SUCCESS) result = EmitCommand(cg, cg->is_entry ? HLT : RET);
+
+            return result;
+
+        default:
+            return CODEGEN_VALUE_ERROR;
+    }
+}
+
+//* ================================== functions ===================================
+
+/// @brief Takes the arguments from the stack (the last one is on the top)
+static CodeGenReturnCode EmitPrologue(CodeGen* cg) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRFunction* func = cg->func;
+
+    for (int param = func->params_count - 1; param >= 0; param--) {
+        int value = -1;
+
+        for (size_t i = 0; i < func->instrs_count && value == -1; i++) {
+            if (func->instrs[i].block != -1 && func->instrs[i].opcode == IR_PARAM && func->instrs[i].value == param) {
+                value = int(i);
+            }
+        }
+
+        CodeGenReturnCode result = value == -1 ? EmitReg(cg, POP, XX) : Store(cg, value);
+        if (result != CODEGEN_SUCCESS) return result;
+    }
+
+    return CODEGEN_SUCCESS;
+}
+
+static CodeGenReturnCode EmitFunction(CodeGen* cg, int func_index, const RegAllocation* alloc) {
+    ASSERT(cg    != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(alloc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRFunction* func = cg->module->functions[func_index];
+
+    cg->func       = func;
+    cg->alloc      = alloc;
+    cg->frame_size = alloc->frame_size;
+    cg->is_entry   = func_index == cg->module->entry;
+    cg->integral   = (int*) calloc(func->instrs_count + 1, sizeof(int));
+    if (!cg->integral) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return CODEGEN_MEMORY_ERROR;
+    }
+
+    IRComputeIntegral(func, cg->integral);
+
+    cg->block_base = int(cg->labels_count);
+    for (size_t i = 0; i < func->blocks_count; i++) {
+        if (NewLabel(cg) == -1) {
+            FREE(cg->integral);
+            return CODEGEN_MEMORY_ERROR;
+        }
+    }
+
+    BindLabel(cg, func_index);
+    CodeGenReturnCode result = EmitPrologue(cg);
+
+    for (size_t i = 0; i < alloc->order_count && result == CODEGEN_SUCCESS; i++) {
+        int block = alloc->order[i];
+        cg->next_block = i + 1 < alloc->order_count ? alloc->order[i + 1] : -1;
+
+        BindLabel(cg, cg->block_base + block);
+
+        const IRIntArray* instrs = &func->blocks[block].instrs;
+        for (size_t j = 0; j < instrs->size && result == CODEGEN_SUCCESS; j++) {
+            result = AddLine(cg, func->instrs[instrs->data[j]].line);
+            if (result == CODEGEN_SUCCESS) result = EmitInstr(cg, instrs->data[j]);
+        }
+    }
+
+    FREE(cg->integral);
+
+    return result;
+}
+
+/// @brief Symbols of the bytecode: the function labels are the first ones
+static CodeGenReturnCode FillSymbols(CodeGen* cg) {
+    ASSERT(cg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRModule* module = cg->module;
+    Bytecode* bytecode = cg->bytecode;
+
+    bytecode->symbols = (SpuExeSymbol*) calloc(module->functions_count, sizeof(SpuExeSymbol));
+    if (!bytecode->symbols) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return CODEGEN_MEMORY_ERROR;
+    }
+
+    for (size_t i = 0; i < module->functions_count; i++) {
+        SpuExeSymbol* symbol = &bytecode->symbols[i];
+
+        symbol->address = cg->labels[i].address;
+        strncpy(symbol->name, module->functions[i]->name, SPU_EXE_NAME_LEN - 1);
+    }
+
+    bytecode->symbols_count = module->functions_count;
+
+    return CODEGEN_SUCCESS;
+}
+
+CodeGenReturnCode CodeGenModule(const IRModule* module, RegAllocation* const* allocs, Bytecode* bytecode) {
+    ASSERT(module   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(allocs   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(bytecode != NULL, "NULL POINTER WAS PASSED!\n");
+
+    CodeGen cg = {};
+    cg.bytecode = bytecode;
+    cg.module   = module;
+
+    //* labels of the functions go first: label index == function index
+    for (size_t i = 0; i < module->functions_count; i++) {
+        if (NewLabel(&cg) == -1) {
+            FREE(cg.labels);
+            return CODEGEN_MEMORY_ERROR;
+        }
+    }
+
+    //* execution starts from the address 0, so the entry function is placed first
+    CodeGenReturnCode result = EmitFunction(&cg, module->entry, allocs[module->entry]);
+
+    for (size_t i = 0; i < module->functions_count && result == CODEGEN_SUCCESS; i++) {
+        if (int(i) != module->entry) result = EmitFunction(&cg, int(i), allocs[i]);
+    }
+
+    for (size_t i = 0; i < cg.labels_count && result == CODEGEN_SUCCESS; i++) {
+        if (cg.labels[i].chain != -1) {
+            fprintf(stderr, RED("Jump to the label %lu that was not placed!\n"), i);
+            result = CODEGEN_LABEL_ERROR;
+        }
+    }
+
+    if (result == CODEGEN_SUCCESS) result = FillSymbols(&cg);
+
+    FREE(cg.labels);
+
+    return result;
+}
+
+//* ==================================== running ===================================
+
+CodeGenReturnCode RunBytecode(const Bytecode* bytecode, int use_jit, const SpuConfig* config) {
+    ASSERT(bytecode != NULL, "NULL POINTER WAS PASSED!\n");
+
+    SPU* spu = SpuInit(config);
+    if (!spu) return CODEGEN_MEMORY_ERROR;
+
+    SpuDebugInfo debug_info = {bytecode->symbols, bytecode->symbols_count, bytecode->lines, bytecode->lines_count};
+
+    spu->cmds       = bytecode->code;
+    spu->cmds_size  = bytecode->size;
+    spu->debug_info = &debug_info;
+
+    SpuRun(spu, use_jit);
+
+    SpuDtor(spu);
+
+    return CODEGEN_SUCCESS;
+}
+
+SpuExeReturnCode WriteBytecode(const Bytecode* bytecode, const char* filename, size_t ram_size) {
+    ASSERT(bytecode != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+
+    return WriteSpuExe(filename, bytecode->code, bytecode->size, NULL, 0, 0, bytecode->symbols, bytecode->symbols_count,
+                       ram_size);
+}
@@ -0,0 +1,231 @@
+/*!
+    \file
+    File with the binary SPU executable: writer, mmap loader and runner
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Executable.h"
+#include "SpuMethods.h"
+#include "Jit.h"
+
+//* ================================== writing =================================
+
+static size_t SectionEnd(size_t offset, size_t count, size_t elem_size) {
+    return offset + count * elem_size;
+}
+
+SpuExeReturnCode WriteSpuExe(const char* filename, const int* code, size_t code_size, const int* data, size_t data_size,
+                             int entry, const SpuExeSymbol* symbols, size_t symbols_count, size_t ram_size) {
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(code     != NULL || code_size     == 0, "NULL POINTER WAS PASSED!\n");
+    ASSERT(data     != NULL || data_size     == 0, "NULL POINTER WAS PASSED!\n");
+    ASSERT(symbols  != NULL || symbols_count == 0, "NULL POINTER WAS PASSED!\n");
+
+    SpuExeHeader header = {};
+    header.magic          = SPU_EXE_MAGIC;
+    header.version        = SPU_EXE_VERSION;
+    header.entry          = (uint32_t) entry;
+    header.code_offset    = (uint32_t) sizeof(SpuExeHeader);
+    header.code_size      = (uint32_t) code_size;
+    header.data_offset    = (uint32_t) SectionEnd(header.code_offset, code_size, sizeof(int));
+    header.data_size      = (uint32_t) data_size;
+    header.symbols_offset = (uint32_t) SectionEnd(header.data_offset, data_size, sizeof(int));
+    header.symbols_count  = (uint32_t) symbols_count;
+    header.ram_size       = (uint32_t) ram_size;
+
+    FILE* exe_file = fopen(filename, "wb");
+    if (!exe_file) {
+        fprintf(stderr, RED("Error occured while opening %s!\n"), filename);
+        return SPU_EXE_FILE_ERROR;
+    }
+
+    int written = fwrite(&header, sizeof(SpuExeHeader), 1, exe_file) == 1;
+    if (written && code_size)     written = fwrite(code,    sizeof(int),          code_size,     exe_file) == code_size;
+    if (written && data_size)     written = fwrite(data,    sizeof(int),          data_size,     exe_file) == data_size;
+    if (written && symbols_count) written = fwrite(symbols, sizeof(SpuExeSymbol), symbols_count, exe_file) == symbols_count;
+
+    if (fclose(exe_file) != 0) written = 0;
+
+    if (!written) {
+        fprintf(stderr, RED("Error occured while writing %s!\n"), filename);
+        return SPU_EXE_FILE_ERROR;
+    }
+
+    return SPU_EXE_SUCCESS;
+}
+
+//* ================================== loading =================================
+
+static int SectionFits(const SpuExe* exe, uint32_t offset, uint32_t count, size_t elem_size) {
+    ASSERT(exe != NULL, "NULL POINTER WAS PASSED!\n");
+
+    return offset % sizeof(int) == 0 && offset <= exe->mapping_size &&
+           (size_t) count <= (exe->mapping_size - offset) / elem_size;
+}
+
+static SpuExeReturnCode CheckSpuExe(const SpuExe* exe) {
+    ASSERT(exe != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const SpuExeHeader* header = exe->header;
+
+    if (header->magic != SPU_EXE_MAGIC) {
+        fprintf(stderr, RED("It is not the SPU executable!\n"));
+        return SPU_EXE_FORMAT_ERROR;
+    }
+
+    if (header->version != SPU_EXE_VERSION) {
+        fprintf(stderr, RED("Unsupported version of the SPU executable: %u!\n"), header->version);
+        return SPU_EXE_FORMAT_ERROR;
+    }
+
+    if (!SectionFits(exe, header->code_offset,    header->code_size,     sizeof(int))  ||
+        !SectionFits(exe, header->data_offset,    header->data_size,     sizeof(int))  ||
+        !SectionFits(exe, header->symbols_offset, header->symbols_count, sizeof(SpuExeSymbol))) {
+        fprintf(stderr, RED("Sections of the SPU executable are out of the file!\n"));
+        return SPU_EXE_FORMAT_ERROR;
+    }
+
+    if (header->ram_size > SPU_MAX_RAM_SIZE) {
+        fprintf(stderr, RED("RAM of the SPU executable is too big: %u words (maximum is %lu)!\n"),
+                header->ram_size, SPU_MAX_RAM_SIZE);
+        return SPU_EXE_FORMAT_ERROR;
+    }
+
+    if (header->entry >= header->code_size) {
+        fprintf(stderr, RED("Entry point %u is out of the code!\n"), header->entry);
+        return SPU_EXE_FORMAT_ERROR;
+    }
+
+    return SPU_EXE_SUCCESS;
+}
+
+SpuExeReturnCode LoadSpuExe(const char* filename, SpuExe* exe) {
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(exe      != NULL, "NULL POINTER WAS PASSED!\n");
+
+    *exe = {};
+
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, RED("Error occured while opening %s!\n"), filename);
+        return SPU_EXE_FILE_ERROR;
+    }
+
+    struct stat file_stat = {};
+    if (fstat(fd, &file_stat) == -1 || (size_t) file_stat.st_size < sizeof(SpuExeHeader)) {
+        fprintf(stderr, RED("%s is too small for the SPU executable!\n"), filename);
+        close(fd);
+        return SPU_EXE_FORMAT_ERROR;
+    }
+
+    exe->mapping_size = (size_t) file_stat.st_size;
+    exe->mapping      = mmap(NULL, exe->mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (exe->mapping == MAP_FAILED) {
+        fprintf(stderr, RED("Error occured while mapping %s!\n"), filename);
+        *exe = {};
+        return SPU_EXE_MEMORY_ERROR;
+    }
+
+    const char* base = (const char*) exe->mapping;
+    exe->header = (const SpuExeHeader*) base;
+
+    SpuExeReturnCode result = CheckSpuExe(exe);
+    if (result != SPU_EXE_SUCCESS) {
+        SpuExeDtor(exe);
+        return result;
+    }
+
+    exe->code    = (const int*)          (base + exe->header->code_offset);
+    exe->data    = (const int*)          (base + exe->header->data_offset);
+    exe->symbols = (const SpuExeSymbol*) (base + exe->header->symbols_offset);
+
+    return SPU_EXE_SUCCESS;
+}
+
+void SpuExeDtor(SpuExe* exe) {
+    ASSERT(exe != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (exe->mapping) munmap(exe->mapping, exe->mapping_size);
+    *exe = {};
+}
+
+//* ================================== running =================================
+
+SpuExeReturnCode RunSpuExe(const SpuExe* exe, int use_jit, const SpuConfig* config) {
+    ASSERT(exe         != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(exe->header != NULL, "NULL POINTER WAS PASSED!\n");
+
+    SpuConfig exe_config = {};
+    if (config) exe_config = *config;
+    if (!exe_config.ram_size) exe_config.ram_size = exe->header->ram_size;
+
+    SPU* spu = SpuInit(&exe_config);
+    if (!spu) return SPU_EXE_MEMORY_ERROR;
+
+    if (exe->header->data_size > spu->ram_size) {
+        fprintf(stderr, RED("Data of the SPU executable does not fit in RAM: %u words (RAM is %lu)!\n"),
+                exe->header->data_size, spu->ram_size);
+        SpuDtor(spu);
+        return SPU_EXE_FORMAT_ERROR;
+    }
+
+    //* the file has no lines, the profile names the functions only
+    SpuDebugInfo debug_info = {exe->symbols, exe->header->symbols_count, NULL, 0};
+
+    //* the code is executed from the mapping, only RAM gets a copy of the data (the rest of RAM is not touched)
+    spu->cmds       = exe->code;
+    spu->cmds_size  = exe->header->code_size;
+    spu->ip         = (int) exe->header->entry;
+    spu->debug_info = &debug_info;
+    memcpy(spu->ram, exe->data, exe->header->data_size * sizeof(int));
+
+    SpuRun(spu, use_jit);
+
+    SpuDtor(spu);
+
+    return SPU_EXE_SUCCESS;
+}
+
+//* ================================ debug info ================================
+
+const SpuExeSymbol* SpuDebugFindSymbol(const SpuDebugInfo* debug_info, int address, int is_inside) {
+    if (!debug_info) return NULL;
+
+    const SpuExeSymbol* found = NULL;
+    for (size_t i = 0; i < debug_info->symbols_count; i++) {
+        const SpuExeSymbol* symbol = &debug_info->symbols[i];
+
+        if (symbol->address == address) return symbol;
+        if (is_inside && symbol->address < address && (!found || symbol->address > found->address)) found = symbol;
+    }
+
+    return found;
+}
+
+int SpuDebugFindLine(const SpuDebugInfo* debug_info, int address, int function) {
+    if (!debug_info || !debug_info->lines_count) return 0;
+
+    //* the first line after the address
+    size_t left  = 0;
+    size_t right = debug_info->lines_count;
+    while (left < right) {
+        size_t middle = (left + right) / 2;
+
+        if (debug_info->lines[middle].address <= address) left  = middle + 1;
+        else                                              right = middle;
+    }
+
+    if (left == 0) return 0;
+
+    const SpuExeLine* line = &debug_info->lines[left - 1];
+    return line->address >= function ? line->line : 0;
+}
@@ -99,8 +99,13 @@ Tokens* GetLexerTokens(Text* program_text) {
     char lexem[MAX_NAME_LENGTH] = "";
     size_t  read_symbols = 0;
 
+    //* the new lines are counted up to the end of the read lexem (there are none in it)
+    int    line        = 1;
+    size_t line_offset = program_text->offset;
+
     while (sscanf(program_text->text + program_text->offset, "%s%n", lexem, &read_symbols) != EOF) {
         DELTA_SHIFT(program_text, read_symbols);
+        for (; line_offset < program_text->offset; line_offset++) line += program_text->text[line_offset] == '\n';
         lexem[ strcspn(lexem, "\n\t\r") ] = '\0';
 
         if (IS_COMMENT(lexem)) {
@@ -149,6 +154,7 @@ Tokens* GetLexerTokens(Text* program_text) {
             fprintf(stderr, RED("Unknown lexem in code \"%s\"\n"), lexem);
         }
 
+        if (node) node->line = line;
         tokens->lexems[tokens->size++] = node;
     }
 
@@ -394,22 +400,30 @@ Node* GetBlockStatement(Tokens* tokens) {
     return statement_block;
 }
 
+/// @brief The statement gets the line of its first token
+static Node* SetLine(Node* statement, int line) {
+    if (statement) statement->line = line;
+
+    return statement;
+}
+
 Node* GetSimpleStatement(Tokens* tokens) {
     ASSERT(tokens != NULL, "NULL POINTER WAS PASSED!\n");
 
     //!printf("%s %lu %lu | %lu\n", __func__, tokens->lexems[tokens->offset]->data, tokens->lexems[tokens->offset]->type, tokens->offset);
 
     int old_offset = tokens->offset;
+    int line       = tokens->offset < tokens->size ? tokens->lexems[tokens->offset]->line : 0;
 
     Node* simple_statement = NULL;
 
     simple_statement = GetIf(tokens);
-    if (simple_statement) return simple_statement;
+    if (simple_statement) return SetLine(simple_statement, line);
 
     tokens->offset = old_offset;
 
     simple_statement = GetWhile(tokens);
-    if (simple_statement) return simple_statement;
+    if (simple_statement) return SetLine(simple_statement, line);
 
     tokens->offset = old_offset;
 
@@ -420,7 +434,7 @@ Node* GetSimpleStatement(Tokens* tokens) {
             tokens->lexems[tokens->offset]->data != END_LINE) SYNTAX_ASSERT(0, "Syntax error!\n");
         SHIFT(tokens); //* проверка на синтаксис + скип
 
-        return simple_statement;
+        return SetLine(simple_statement, line);
     }
 
     tokens->offset = old_offset;
@@ -432,7 +446,7 @@ Node* GetSimpleStatement(Tokens* tokens) {
             tokens->lexems[tokens->offset]->data != END_LINE) SYNTAX_ASSERT(0, "Syntax error!\n");
         SHIFT(tokens); //* проверка на синтаксис + скип
 
-        return simple_statement;
+        return SetLine(simple_statement, line);
     }
 
     tokens->offset = old_offset;
@@ -443,7 +457,7 @@ Node* GetSimpleStatement(Tokens* tokens) {
             tokens->lexems[tokens->offset]->data != END_LINE) SYNTAX_ASSERT(0, "Syntax error!\n");
         SHIFT(tokens); //* проверка на синтаксис + скип
 
-        return simple_statement;
+        return SetLine(simple_statement, line);
     }
 
     tokens->offset = old_offset;
@@ -460,7 +474,7 @@ Node* GetSimpleStatement(Tokens* tokens) {
 
     SHIFT(tokens);
 
-    return simple_statement;
+    return SetLine(simple_statement, line);
 }
 
 Node* GetIf(Tokens* tokens) {
@@ -0,0 +1,2106 @@
+/*!
+    \file
+    File with the SSA intermediate representation functions: lowering from AST and optimizations
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "IR.h"
+#include "BinaryTree.h"
+#include "LanguageSyntaxis.h"
+
+/// @brief Constant for IR filename
+const char* IR_FILENAME = "../Language/ir.txt";
+
+/// @brief Constant with the printable names of IR instructions
+static const char* const IR_OPCODE_NAMES[] = {
+    "const", "param", "phi", "copy", "add", "sub", "mul", "div", "sqrt",
+    "less", "more", "less_equal", "more_equal", "equal", "not_equal",
+    "trunc", "call", "scan", "print", "jmp", "branch", "ret",
+};
+
+/// @brief Structure with the state of AST lowering
+struct IRBuilder {
+    IRModule*   module;
+    IRFunction*   func;
+    int          block;     ///< block where the next instruction goes
+    int*    func_index;     ///< nametable index -> function index or -1
+    int*   local_index;     ///< nametable index -> local index of the current function or -1
+};
+
+//* =================================== helpers ===================================
+
+IRReturnCode IRIntArrayPush(IRIntArray* array, int value) {
+    ASSERT(array != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (array->size >= array->capacity) {
+        size_t new_capacity = array->capacity ? array->capacity * 2 : 4;
+
+        int* new_data = (int*) realloc(array->data, new_capacity * sizeof(int));
+        if (!new_data) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return IR_MEMORY_ERROR;
+        }
+
+        array->data     = new_data;
+        array->capacity = new_capacity;
+    }
+
+    array->data[array->size++] = value;
+
+    return IR_SUCCESS;
+}
+
+void IRIntArrayDtor(IRIntArray* array) {
+    ASSERT(array != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FREE(array->data);
+    array->size     = 0;
+    array->capacity = 0;
+}
+
+static void IRIntArrayRemove(IRIntArray* array, size_t index) {
+    ASSERT(array != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(index < array->size, "INDEX OUT OF RANGE!\n");
+
+    memmove(array->data + index, array->data + index + 1, (array->size - index - 1) * sizeof(int));
+    array->size--;
+}
+
+static int IRIntArrayFind(const IRIntArray* array, int value) {
+    ASSERT(array != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < array->size; i++) {
+        if (array->data[i] == value) return int(i);
+    }
+
+    return -1;
+}
+
+int IRIsTerminator(IROpcode opcode) {
+    return opcode == IR_JMP || opcode == IR_BRANCH || opcode == IR_RET;
+}
+
+int IRIsCompare(IROpcode opcode) {
+    return opcode >= IR_LESS && opcode <= IR_NOT_EQUAL;
+}
+
+int IRIsPure(IROpcode opcode) {
+    switch (opcode) {
+        case IR_CONST: case IR_PHI: case IR_COPY: case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV:
+        case IR_SQRT: case IR_LESS: case IR_MORE: case IR_LESS_EQUAL: case IR_MORE_EQUAL: case IR_EQUAL:
+        case IR_NOT_EQUAL: case IR_TRUNC:
+            return 1;
+
+        case IR_PARAM: case IR_CALL: case IR_SCAN: case IR_PRINT: case IR_JMP: case IR_BRANCH: case IR_RET:
+        default:
+            return 0;
+    }
+}
+
+int IRDefinedValue(const IRFunction* func, int index) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    switch (func->instrs[index].opcode) {
+        case IR_COPY:
+            return func->instrs[index].value;
+
+        case IR_PRINT: case IR_JMP: case IR_BRANCH: case IR_RET:
+            return -1;
+
+        case IR_CONST: case IR_PARAM: case IR_PHI: case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_SQRT:
+        case IR_LESS: case IR_MORE: case IR_LESS_EQUAL: case IR_MORE_EQUAL: case IR_EQUAL: case IR_NOT_EQUAL:
+        case IR_TRUNC: case IR_CALL: case IR_SCAN:
+        default:
+            return index;
+    }
+}
+
+/// @brief Wraps the value to int the way the SPU registers do (two's complement, no overflow UB)
+static int WrapInt(long long value) {
+    return int(unsigned(value));
+}
+
+int IRFold(IROpcode opcode, int left, int right, int* result) {
+    ASSERT(result != NULL, "NULL POINTER WAS PASSED!\n");
+
+    //* the formulas of the SPU stack operations: values are fixed point numbers scaled by CALC_ACCURACY,
+    //* the intermediate products wrap like in the JIT and in the -fwrapv native build
+    switch (opcode) {
+        case IR_ADD:        *result = WrapInt((long long) left + right);                        return 1;
+        case IR_SUB:        *result = WrapInt((long long) left - right);                        return 1;
+        case IR_MUL:        *result = WrapInt((long long) left * right) / CALC_ACCURACY;        return 1;
+        case IR_DIV:
+            if (right == 0) return 0;
+            *result = WrapInt((long long) WrapInt((long long) CALC_ACCURACY * left) / right);
+            return 1;
+        case IR_SQRT:
+            if (left / CALC_ACCURACY < 0) return 0;
+            *result = int(sqrt(left / CALC_ACCURACY)) * CALC_ACCURACY;
+            return 1;
+        case IR_TRUNC:      *result = left / CALC_ACCURACY * CALC_ACCURACY;    return 1;
+        case IR_LESS:       *result = (left <  right) * CALC_ACCURACY;         return 1;
+        case IR_MORE:       *result = (left >  right) * CALC_ACCURACY;         return 1;
+        case IR_LESS_EQUAL: *result = (left <= right) * CALC_ACCURACY;         return 1;
+        case IR_MORE_EQUAL: *result = (left >= right) * CALC_ACCURACY;         return 1;
+        case IR_EQUAL:      *result = (left == right) * CALC_ACCURACY;         return 1;
+        case IR_NOT_EQUAL:  *result = (left != right) * CALC_ACCURACY;         return 1;
+
+        case IR_CONST: case IR_PARAM: case IR_PHI: case IR_COPY: case IR_CALL: case IR_SCAN: case IR_PRINT:
+        case IR_JMP: case IR_BRANCH: case IR_RET:
+        default:
+            return 0;
+    }
+}
+
+static int IRArgsCount(IROpcode opcode) {
+    switch (opcode) {
+        case IR_CONST: case IR_PARAM: case IR_SCAN: case IR_JMP:
+            return 0;
+        case IR_COPY: case IR_SQRT: case IR_TRUNC: case IR_PRINT: case IR_BRANCH: case IR_RET:
+            return 1;
+        case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_LESS: case IR_MORE:
+        case IR_LESS_EQUAL: case IR_MORE_EQUAL: case IR_EQUAL: case IR_NOT_EQUAL:
+            return 2;
+        case IR_PHI: case IR_CALL:
+        default:
+            return -1;
+    }
+}
+
+int IRBlockSuccs(const IRFunction* func, int block, int* succs) {
+    ASSERT(func  != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(succs != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRBlock* bb = &func->blocks[block];
+    if (bb->dead || bb->instrs.size == 0) return 0;
+
+    const IRInstr* last = &func->instrs[ bb->instrs.data[bb->instrs.size - 1] ];
+
+    switch (last->opcode) {
+        case IR_JMP:
+            succs[0] = last->targets[0];
+            return 1;
+        case IR_BRANCH:
+            succs[0] = last->targets[0];
+            succs[1] = last->targets[1];
+            return 2;
+        case IR_CONST: case IR_PARAM: case IR_PHI: case IR_COPY: case IR_ADD: case IR_SUB: case IR_MUL:
+        case IR_DIV: case IR_SQRT: case IR_LESS: case IR_MORE: case IR_LESS_EQUAL: case IR_MORE_EQUAL:
+        case IR_EQUAL: case IR_NOT_EQUAL: case IR_TRUNC: case IR_CALL: case IR_SCAN: case IR_PRINT: case IR_RET:
+        default:
+            return 0;
+    }
+}
+
+size_t IRComputeRPO(const IRFunction* func, int* rpo) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(rpo  != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t count = func->blocks_count;
+    int* visited = (int*) calloc(count, sizeof(int));
+    int* stack   = (int*) calloc(count, sizeof(int));
+    int* next    = (int*) calloc(count, sizeof(int));
+    if (!visited || !stack || !next) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(visited); FREE(stack); FREE(next);
+        return 0;
+    }
+
+    size_t postorder_size = 0, stack_size = 0;
+    stack[stack_size++] = 0;
+    visited[0] = 1;
+
+    //* iterative DFS, rpo is filled from the end
+    while (stack_size > 0) {
+        int block = stack[stack_size - 1];
+        int succs[2] = {};
+        int succs_count = IRBlockSuccs(func, block, succs);
+
+        if (next[block] < succs_count) {
+            int succ = succs[ next[block]++ ];
+            if (!visited[succ]) {
+                visited[succ] = 1;
+                stack[stack_size++] = succ;
+            }
+            continue;
+        }
+
+        stack_size--;
+        rpo[count - 1 - postorder_size++] = block;
+    }
+
+    memmove(rpo, rpo + count - postorder_size, postorder_size * sizeof(int));
+
+    FREE(visited);
+    FREE(stack);
+    FREE(next);
+
+    return postorder_size;
+}
+
+void IRComputeDominators(const IRFunction* func, int* idom) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(idom != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t count = func->blocks_count;
+    int* rpo       = (int*) calloc(count, sizeof(int));
+    int* rpo_index = (int*) calloc(count, sizeof(int));
+    if (!rpo || !rpo_index) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(rpo); FREE(rpo_index);
+        return;
+    }
+
+    size_t reachable = IRComputeRPO(func, rpo);
+
+    for (size_t i = 0; i < count; i++) {
+        idom[i]      = -1;
+        rpo_index[i] = -1;
+    }
+    for (size_t i = 0; i < reachable; i++) rpo_index[ rpo[i] ] = int(i);
+
+    idom[0] = 0;
+    int changed = 1;
+
+    while (changed) {
+        changed = 0;
+
+        for (size_t i = 1; i < reachable; i++) {
+            int block    = rpo[i];
+            int new_idom = -1;
+            const IRIntArray* preds = &func->blocks[block].preds;
+
+            for (size_t j = 0; j < preds->size; j++) {
+                int pred = preds->data[j];
+                if (rpo_index[pred] == -1 || idom[pred] == -1) continue;
+
+                if (new_idom == -1) {
+                    new_idom = pred;
+                    continue;
+                }
+
+                int finger1 = pred, finger2 = new_idom;
+                while (finger1 != finger2) {
+                    while (rpo_index[finger1] > rpo_index[finger2]) finger1 = idom[finger1];
+                    while (rpo_index[finger2] > rpo_index[finger1]) finger2 = idom[finger2];
+                }
+                new_idom = finger1;
+            }
+
+            if (idom[block] != new_idom) {
+                idom[block] = new_idom;
+                changed = 1;
+            }
+        }
+    }
+
+    FREE(rpo);
+    FREE(rpo_index);
+}
+
+//* ================================ construction =================================
+
+static int NewInstr(IRFunction* func, IROpcode opcode) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (func->instrs_count >= func->instrs_capacity) {
+        size_t new_capacity = func->instrs_capacity ? func->instrs_capacity * 2 : 64;
+
+        IRInstr* new_instrs = (IRInstr*) realloc(func->instrs, new_capacity * sizeof(IRInstr));
+        if (!new_instrs) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return -1;
+        }
+
+        func->instrs          = new_instrs;
+        func->instrs_capacity = new_capacity;
+    }
+
+    IRInstr* instr = &func->instrs[func->instrs_count];
+    memset(instr, 0, sizeof(IRInstr));
+
+    instr->opcode     = opcode;
+    instr->block      = -1;
+    instr->var        = -1;
+    instr->targets[0] = -1;
+    instr->targets[1] = -1;
+    instr->line       = func->line;
+
+    return int(func->instrs_count++);
+}
+
+static int NewBlock(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (func->blocks_count >= func->blocks_capacity) {
+        size_t new_capacity = func->blocks_capacity ? func->blocks_capacity * 2 : 16;
+
+        IRBlock* new_blocks = (IRBlock*) realloc(func->blocks, new_capacity * sizeof(IRBlock));
+        if (!new_blocks) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return -1;
+        }
+
+        func->blocks          = new_blocks;
+        func->blocks_capacity = new_capacity;
+    }
+
+    IRBlock* block = &func->blocks[func->blocks_count];
+    memset(block, 0, sizeof(IRBlock));
+
+    block->defs = (int*) calloc(func->locals_count + 1, sizeof(int));
+    if (!block->defs) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return -1;
+    }
+    for (size_t i = 0; i < func->locals_count; i++) block->defs[i] = -1;
+
+    return int(func->blocks_count++);
+}
+
+/// @brief Adds instruction to the end of the block (phis go after the other phis)
+static int AddInstr(IRFunction* func, int block, IROpcode opcode) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int index = NewInstr(func, opcode);
+    if (index == -1) return -1;
+
+    func->instrs[index].block = block;
+    IRIntArray* instrs = &func->blocks[block].instrs;
+
+    if (IRIntArrayPush(instrs, index) != IR_SUCCESS) return -1;
+
+    if (opcode == IR_PHI) {
+        size_t position = instrs->size - 1;
+        while (position > 0 && func->instrs[ instrs->data[position - 1] ].opcode != IR_PHI) {
+            instrs->data[position] = instrs->data[position - 1];
+            position--;
+        }
+        instrs->data[position] = index;
+    }
+
+    return index;
+}
+
+static int Emit(IRBuilder* builder, IROpcode opcode, int arg0, int arg1) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int index = AddInstr(builder->func, builder->block, opcode);
+    if (index == -1) return -1;
+
+    int args_count = IRArgsCount(opcode);
+    if (args_count >= 1) IRIntArrayPush(&builder->func->instrs[index].args, arg0);
+    if (args_count >= 2) IRIntArrayPush(&builder->func->instrs[index].args, arg1);
+
+    return index;
+}
+
+static void AddEdge(IRFunction* func, int from, int to) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    IRIntArrayPush(&func->blocks[to].preds, from);
+}
+
+/// @brief Removes CFG edge together with the corresponding phi operands
+static void RemoveEdge(IRFunction* func, int from, int to) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    IRBlock* block = &func->blocks[to];
+
+    int index = IRIntArrayFind(&block->preds, from);
+    if (index == -1) return;
+
+    IRIntArrayRemove(&block->preds, size_t(index));
+
+    for (size_t i = 0; i < block->instrs.size; i++) {
+        IRInstr* phi = &func->instrs[ block->instrs.data[i] ];
+        if (phi->opcode != IR_PHI) break;
+
+        IRIntArrayRemove(&phi->args, size_t(index));
+    }
+}
+
+static int Jump(IRBuilder* builder, int target) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int jmp = Emit(builder, IR_JMP, 0, 0);
+    if (jmp == -1) return -1;
+
+    builder->func->instrs[jmp].targets[0] = target;
+    AddEdge(builder->func, builder->block, target);
+
+    return jmp;
+}
+
+static int Branch(IRBuilder* builder, int condition, int if_true, int if_false) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int branch = Emit(builder, IR_BRANCH, condition, 0);
+    if (branch == -1) return -1;
+
+    builder->func->instrs[branch].targets[0] = if_true;
+    builder->func->instrs[branch].targets[1] = if_false;
+    AddEdge(builder->func, builder->block, if_true);
+    AddEdge(builder->func, builder->block, if_false);
+
+    return branch;
+}
+
+/// @brief Skips the copies left by the trivial phi removal
+static int Follow(const IRFunction* func, int value) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    while (func->instrs[value].opcode == IR_COPY) value = func->instrs[value].args.data[0];
+
+    return value;
+}
+
+static int ReadVariable(IRFunction* func, int var, int block);
+
+//* SSA construction follows Braun et al. "Simple and Efficient Construction of Static Single Assignment Form"
+static int TryRemoveTrivialPhi(IRFunction* func, int phi) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int same = -1;
+    IRIntArray* args = &func->instrs[phi].args;
+
+    for (size_t i = 0; i < args->size; i++) {
+        int arg = Follow(func, args->data[i]);
+
+        if (arg == same || arg == phi) continue;
+        if (same != -1) return phi;
+
+        same = arg;
+    }
+
+    if (same == -1) same = func->undef;
+
+    //* trivial phi turns into copy, copies are propagated after the construction
+    func->instrs[phi].opcode = IR_COPY;
+    func->instrs[phi].value  = phi;
+    args->size = 0;
+    IRIntArrayPush(args, same);
+
+    return same;
+}
+
+static int AddPhiOperands(IRFunction* func, int var, int phi) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int block = func->instrs[phi].block;
+
+    for (size_t i = 0; i < func->blocks[block].preds.size; i++) {
+        int value = ReadVariable(func, var, func->blocks[block].preds.data[i]);
+        IRIntArrayPush(&func->instrs[phi].args, value);
+    }
+
+    return TryRemoveTrivialPhi(func, phi);
+}
+
+static int ReadVariableRecursive(IRFunction* func, int var, int block) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int value = -1;
+    IRBlock* bb = &func->blocks[block];
+
+    if (!bb->sealed) {
+        value = AddInstr(func, block, IR_PHI);
+        func->instrs[value].var = var;
+        IRIntArrayPush(&func->blocks[block].incomplete_phis, value);
+    } else if (bb->preds.size == 0) {
+        value = func->undef;
+    } else if (bb->preds.size == 1) {
+        value = ReadVariable(func, var, bb->preds.data[0]);
+    } else {
+        value = AddInstr(func, block, IR_PHI);
+        func->instrs[value].var = var;
+        func->blocks[block].defs[var] = value;
+        value = AddPhiOperands(func, var, value);
+    }
+
+    func->blocks[block].defs[var] = value;
+
+    return value;
+}
+
+static int ReadVariable(IRFunction* func, int var, int block) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int value = func->blocks[block].defs[var];
+    if (value != -1) return value;
+
+    return ReadVariableRecursive(func, var, block);
+}
+
+static void WriteVariable(IRFunction* func, int var, int block, int value) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    func->blocks[block].defs[var] = value;
+}
+
+static void SealBlock(IRFunction* func, int block) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    //* the list can grow while operands are added, so the size is reread every iteration
+    for (size_t i = 0; i < func->blocks[block].incomplete_phis.size; i++) {
+        int phi = func->blocks[block].incomplete_phis.data[i];
+        AddPhiOperands(func, func->instrs[phi].var, phi);
+    }
+
+    IRIntArrayDtor(&func->blocks[block].incomplete_phis);
+    func->blocks[block].sealed = 1;
+}
+
+static int IsCall(const IRBuilder* builder, const Node* node) {
+    return node->type == VARIABLE && builder->func_index[node->data] != -1;
+}
+
+static IRReturnCode CollectLocals(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return IR_SUCCESS;
+
+    if (node->type == VARIABLE && !IsCall(builder, node) && builder->local_index[node->data] == -1) {
+        IRFunction* func = builder->func;
+
+        int* new_locals = (int*) realloc(func->locals, (func->locals_count + 1) * sizeof(int));
+        if (!new_locals) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return IR_MEMORY_ERROR;
+        }
+
+        func->locals = new_locals;
+        func->locals[func->locals_count] = node->data;
+        builder->local_index[node->data] = int(func->locals_count++);
+    }
+
+    //* nested function declarations are reported by the lowering
+    if (node->type == DECLARATOR && node->data == FUNC_DECLARATOR) return IR_SUCCESS;
+
+    if (CollectLocals(builder, node->left) != IR_SUCCESS) return IR_MEMORY_ERROR;
+
+    return CollectLocals(builder, node->right);
+}
+
+static IROpcode OperatorToIR(int code) {
+    switch (code) {
+        case ADD:        return IR_ADD;
+        case SUB:        return IR_SUB;
+        case MUL:        return IR_MUL;
+        case DIV:        return IR_DIV;
+        case LESS:       return IR_LESS;
+        case MORE:       return IR_MORE;
+        case LESS_EQUAL: return IR_LESS_EQUAL;
+        case MORE_EQUAL: return IR_MORE_EQUAL;
+        case EQUAL:      return IR_EQUAL;
+        case NOT_EQUAL:  return IR_NOT_EQUAL;
+        case SQRT:       return IR_SQRT;
+        default:         return IR_RET;
+    }
+}
+
+static int LowerExpression(IRBuilder* builder, const Node* node);
+
+static IRReturnCode LowerArguments(IRBuilder* builder, const Node* node, IRIntArray* args) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return IR_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (LowerArguments(builder, node->left,  args) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+        return LowerArguments(builder, node->right, args);
+    }
+
+    int value = LowerExpression(builder, node);
+    if (value == -1) return IR_SEMANTIC_ERROR;
+
+    return IRIntArrayPush(args, value);
+}
+
+static int LowerCall(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int callee = builder->func_index[node->data];
+    IRIntArray args = {};
+
+    if (LowerArguments(builder, node->left, &args) != IR_SUCCESS) {
+        IRIntArrayDtor(&args);
+        return -1;
+    }
+
+    const IRFunction* callee_func = builder->module->functions[callee];
+    if (int(args.size) != callee_func->params_count) {
+        fprintf(stderr, RED("Function %s takes %d parameters, %lu were passed!\n"),
+                callee_func->name, callee_func->params_count, args.size);
+        IRIntArrayDtor(&args);
+        return -1;
+    }
+
+    int call = Emit(builder, IR_CALL, 0, 0);
+    if (call == -1) {
+        IRIntArrayDtor(&args);
+        return -1;
+    }
+
+    builder->func->instrs[call].value = callee;
+    builder->func->instrs[call].args  = args;
+
+    return call;
+}
+
+static int LowerExpression(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) {
+        fprintf(stderr, RED("Empty expression!\n"));
+        return -1;
+    }
+
+    switch (node->type) {
+        case NUMBER: {
+            int constant = Emit(builder, IR_CONST, 0, 0);
+            if (constant != -1) builder->func->instrs[constant].value = node->data * CALC_ACCURACY;
+
+            return constant;
+        }
+        case VARIABLE: {
+            if (IsCall(builder, node)) return LowerCall(builder, node);
+
+            return ReadVariable(builder->func, builder->local_index[node->data], builder->block);
+        }
+        case OPERATOR: {
+            IROpcode opcode = OperatorToIR(node->data);
+
+            if (opcode == IR_SQRT) {
+                int operand = LowerExpression(builder, node->right);
+                if (operand == -1) return -1;
+
+                return Emit(builder, IR_SQRT, operand, 0);
+            }
+
+            if (opcode == IR_RET) break;
+
+            int left = LowerExpression(builder, node->left);
+            if (left == -1) return -1;
+
+            int right = LowerExpression(builder, node->right);
+            if (right == -1) return -1;
+
+            return Emit(builder, opcode, left, right);
+        }
+        case DECLARATOR:
+        case KEYWORD:
+        case SEPARATOR:
+        default:
+            break;
+    }
+
+    fprintf(stderr, RED("Unexpected node in expression (type %d, data %d)!\n"), node->type, node->data);
+
+    return -1;
+}
+
+static IRReturnCode LowerStatement(IRBuilder* builder, const Node* node);
+
+static IRReturnCode LowerIf(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    //* IF: right - condition, left - IF node with the true branch in left and else branch in right
+    IRFunction* func      = builder->func;
+    const Node* if_branch = node->left->left;
+    const Node* el_branch = node->left->right;
+
+    int condition = LowerExpression(builder, node->right);
+    if (condition == -1) return IR_SEMANTIC_ERROR;
+
+    int then_block = NewBlock(func);
+    int else_block = el_branch ? NewBlock(func) : -1;
+    int join_block = NewBlock(func);
+    if (then_block == -1 || join_block == -1 || (el_branch && else_block == -1)) return IR_MEMORY_ERROR;
+
+    Branch(builder, condition, then_block, el_branch ? else_block : join_block);
+
+    SealBlock(func, then_block);
+    builder->block = then_block;
+    if (LowerStatement(builder, if_branch) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+    Jump(builder, join_block);
+
+    if (el_branch) {
+        SealBlock(func, else_block);
+        builder->block = else_block;
+        if (LowerStatement(builder, el_branch) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+        Jump(builder, join_block);
+    }
+
+    SealBlock(func, join_block);
+    builder->block = join_block;
+
+    return IR_SUCCESS;
+}
+
+static IRReturnCode LowerWhile(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    //* WHILE: right - condition, left - body
+    IRFunction* func = builder->func;
+
+    int header_block = NewBlock(func);
+    int body_block   = NewBlock(func);
+    int exit_block   = NewBlock(func);
+    if (header_block == -1 || body_block == -1 || exit_block == -1) return IR_MEMORY_ERROR;
+
+    Jump(builder, header_block);
+    builder->block = header_block;
+
+    int condition = LowerExpression(builder, node->right);
+    if (condition == -1) return IR_SEMANTIC_ERROR;
+
+    Branch(builder, condition, body_block, exit_block);
+
+    SealBlock(func, body_block);
+    builder->block = body_block;
+    if (LowerStatement(builder, node->left) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+    Jump(builder, header_block);
+
+    SealBlock(func, header_block);
+    SealBlock(func, exit_block);
+    builder->block = exit_block;
+
+    return IR_SUCCESS;
+}
+
+static IRReturnCode LowerAssign(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node->left || node->left->type != VARIABLE || IsCall(builder, node->left)) {
+        fprintf(stderr, RED("Only variables can be assigned!\n"));
+        return IR_SEMANTIC_ERROR;
+    }
+
+    int value = LowerExpression(builder, node->right);
+    if (value == -1) return IR_SEMANTIC_ERROR;
+
+    //* variables store only the integer part (as POP on the SPU)
+    int var   = builder->local_index[node->left->data];
+    int trunc = Emit(builder, IR_TRUNC, value, 0);
+    if (trunc == -1) return IR_MEMORY_ERROR;
+
+    builder->func->instrs[trunc].var = var;
+    WriteVariable(builder->func, var, builder->block, trunc);
+
+    return IR_SUCCESS;
+}
+
+static IRReturnCode LowerKeyWord(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    switch (node->data) {
+        case IF:
+            return LowerIf(builder, node);
+
+        case WHILE:
+            return LowerWhile(builder, node);
+
+        case RETURN: {
+            int value = LowerExpression(builder, node->left);
+            if (value == -1) return IR_SEMANTIC_ERROR;
+
+            Emit(builder, IR_RET, value, 0);
+
+            //* code after return is unreachable, it goes to the block without predecessors
+            int unreachable = NewBlock(builder->func);
+            if (unreachable == -1) return IR_MEMORY_ERROR;
+
+            SealBlock(builder->func, unreachable);
+            builder->block = unreachable;
+
+            return IR_SUCCESS;
+        }
+
+        case PRINT: {
+            int value = LowerExpression(builder, node->left);
+            if (value == -1) return IR_SEMANTIC_ERROR;
+
+            Emit(builder, IR_PRINT, value, 0);
+
+            return IR_SUCCESS;
+        }
+
+        case SCAN: {
+            if (!node->right || node->right->type != VARIABLE || IsCall(builder, node->right)) {
+                fprintf(stderr, RED("Only variables can be scanned!\n"));
+                return IR_SEMANTIC_ERROR;
+            }
+
+            int var  = builder->local_index[node->right->data];
+            int scan = Emit(builder, IR_SCAN, 0, 0);
+            if (scan == -1) return IR_MEMORY_ERROR;
+
+            builder->func->instrs[scan].var = var;
+            WriteVariable(builder->func, var, builder->block, scan);
+
+            return IR_SUCCESS;
+        }
+
+        default:
+            fprintf(stderr, RED("Unexpected keyword in statement!\n"));
+            return IR_SEMANTIC_ERROR;
+    }
+}
+
+static IRReturnCode LowerStatement(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return IR_SUCCESS;
+    if (node->line) builder->func->line = node->line;
+
+    switch (node->type) {
+        case SEPARATOR: {
+            if (node->data != END_LINE) break;
+
+            if (LowerStatement(builder, node->left) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+
+            return LowerStatement(builder, node->right);
+        }
+        case DECLARATOR: {
+            if (node->data == VAR_DECLARATOR) return LowerStatement(builder, node->left);
+
+            fprintf(stderr, RED("Functions can be declared only at the top level!\n"));
+            return IR_SEMANTIC_ERROR;
+        }
+        case OPERATOR: {
+            if (node->data == ASSIGN) return LowerAssign(builder, node);
+            break;
+        }
+        case KEYWORD:
+            return LowerKeyWord(builder, node);
+
+        case NUMBER:
+        case VARIABLE:
+        default:
+            break;
+    }
+
+    fprintf(stderr, RED("Unexpected node in statement (type %d, data %d)!\n"), node->type, node->data);
+
+    return IR_SEMANTIC_ERROR;
+}
+
+static IRFunction* IRFunctionCtor(const char* name, int name_index) {
+    IRFunction* func = (IRFunction*) calloc(1, sizeof(IRFunction));
+    NULL_CHECK(func);
+
+    func->name       = name;
+    func->name_index = name_index;
+    func->undef      = -1;
+
+    return func;
+}
+
+static void IRFunctionDtor(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < func->instrs_count; i++) IRIntArrayDtor(&func->instrs[i].args);
+
+    for (size_t i = 0; i < func->blocks_count; i++) {
+        IRIntArrayDtor(&func->blocks[i].instrs);
+        IRIntArrayDtor(&func->blocks[i].preds);
+        IRIntArrayDtor(&func->blocks[i].incomplete_phis);
+        FREE(func->blocks[i].defs);
+    }
+
+    FREE(func->instrs);
+    FREE(func->blocks);
+    FREE(func->locals);
+    FREE(func);
+}
+
+void IRModuleDtor(IRModule* module) {
+    ASSERT(module != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < module->functions_count; i++) IRFunctionDtor(module->functions[i]);
+
+    FREE(module->functions);
+    FREE(module);
+}
+
+static IRReturnCode AddFunction(IRModule* module, IRFunction* func) {
+    ASSERT(module != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!func) return IR_MEMORY_ERROR;
+
+    IRFunction** new_functions = (IRFunction**) realloc(module->functions,
+                                                        (module->functions_count + 1) * sizeof(IRFunction*));
+    if (!new_functions) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        IRFunctionDtor(func);
+        return IR_MEMORY_ERROR;
+    }
+
+    module->functions = new_functions;
+    module->functions[module->functions_count++] = func;
+
+    return IR_SUCCESS;
+}
+
+static int CountParameters(const Node* node) {
+    if (!node) return 0;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) return CountParameters(node->left) + CountParameters(node->right);
+
+    return 1;
+}
+
+/// @brief Goes through the top level statements, registers functions and counts the other statements
+static IRReturnCode DeclareFunctions(IRBuilder* builder, const Node* node, int* statements_count) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return IR_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (DeclareFunctions(builder, node->left, statements_count) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+        return DeclareFunctions(builder, node->right, statements_count);
+    }
+
+    if (node->type != DECLARATOR || node->data != FUNC_DECLARATOR) {
+        (*statements_count)++;
+        return IR_SUCCESS;
+    }
+
+    //* FUNC_DECLARATOR: left - body, right->right - name, right->left - parameters
+    int name_index = node->right->right->data;
+
+    if (builder->func_index[name_index] != -1) {
+        fprintf(stderr, RED("Function %s is declared twice!\n"), builder->module->nametable->names[name_index]);
+        return IR_SEMANTIC_ERROR;
+    }
+
+    builder->func_index[name_index] = int(builder->module->functions_count);
+
+    IRFunction* func = IRFunctionCtor(builder->module->nametable->names[name_index], name_index);
+    if (func) func->params_count = CountParameters(node->right->left);
+
+    return AddFunction(builder->module, func);
+}
+
+static IRReturnCode CollectParameters(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return IR_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (CollectParameters(builder, node->left) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+        return CollectParameters(builder, node->right);
+    }
+
+    if (node->type != VARIABLE || builder->local_index[node->data] != -1) {
+        fprintf(stderr, RED("Bad function parameter!\n"));
+        return IR_SEMANTIC_ERROR;
+    }
+
+    return CollectLocals(builder, node);
+}
+
+/// @brief Creates entry block with undef constant and parameters
+static IRReturnCode BeginFunction(IRBuilder* builder) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    IRFunction* func = builder->func;
+
+    builder->block = NewBlock(func);
+    if (builder->block == -1) return IR_MEMORY_ERROR;
+    SealBlock(func, builder->block);
+
+    func->undef = Emit(builder, IR_CONST, 0, 0);
+    if (func->undef == -1) return IR_MEMORY_ERROR;
+
+    for (int i = 0; i < func->params_count; i++) {
+        int param = Emit(builder, IR_PARAM, 0, 0);
+        if (param == -1) return IR_MEMORY_ERROR;
+
+        func->instrs[param].value = i;
+        func->instrs[param].var   = i;
+        WriteVariable(func, i, builder->block, param);
+    }
+
+    return IR_SUCCESS;
+}
+
+static void ResetLocals(IRBuilder* builder) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < NAMETABLE_SIZE; i++) builder->local_index[i] = -1;
+}
+
+static void CleanupFunction(IRFunction* func);
+
+static IRReturnCode LowerFunction(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    builder->func = builder->module->functions[ builder->func_index[node->right->right->data] ];
+    ResetLocals(builder);
+
+    if (CollectParameters(builder, node->right->left) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+    if (CollectLocals(builder, node->left)            != IR_SUCCESS) return IR_MEMORY_ERROR;
+    if (BeginFunction(builder)                        != IR_SUCCESS) return IR_MEMORY_ERROR;
+    if (LowerStatement(builder, node->left)           != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+
+    //* falling off the end of the function returns 0
+    Emit(builder, IR_RET, builder->func->undef, 0);
+    CleanupFunction(builder->func);
+    builder->func->line = 0;
+
+    return IR_SUCCESS;
+}
+
+static IRReturnCode LowerTopLevel(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return IR_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (LowerTopLevel(builder, node->left) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+        return LowerTopLevel(builder, node->right);
+    }
+
+    if (node->type == DECLARATOR && node->data == FUNC_DECLARATOR) return IR_SUCCESS;
+
+    return LowerStatement(builder, node);
+}
+
+static IRReturnCode CollectTopLevelLocals(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return IR_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (CollectTopLevelLocals(builder, node->left) != IR_SUCCESS) return IR_MEMORY_ERROR;
+        return CollectTopLevelLocals(builder, node->right);
+    }
+
+    if (node->type == DECLARATOR && node->data == FUNC_DECLARATOR) return IR_SUCCESS;
+
+    return CollectLocals(builder, node);
+}
+
+/*!
+    The entry function runs the top level statements. If there are none,
+    it calls the last declared function (with zero arguments).
+*/
+static IRReturnCode LowerEntry(IRBuilder* builder, const Node* root, int statements_count) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    IRModule* module = builder->module;
+    int last_function = int(module->functions_count) - 1;
+
+    if (AddFunction(module, IRFunctionCtor("main", -1)) != IR_SUCCESS) return IR_MEMORY_ERROR;
+
+    module->entry = int(module->functions_count) - 1;
+    builder->func = module->functions[module->entry];
+    ResetLocals(builder);
+
+    if (CollectTopLevelLocals(builder, root) != IR_SUCCESS) return IR_MEMORY_ERROR;
+    if (BeginFunction(builder)               != IR_SUCCESS) return IR_MEMORY_ERROR;
+
+    if (statements_count > 0) {
+        if (LowerTopLevel(builder, root) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+    } else if (last_function >= 0) {
+        int call = Emit(builder, IR_CALL, 0, 0);
+        if (call == -1) return IR_MEMORY_ERROR;
+
+        builder->func->instrs[call].value = last_function;
+        for (int i = 0; i < module->functions[last_function]->params_count; i++) {
+            IRIntArrayPush(&builder->func->instrs[call].args, builder->func->undef);
+        }
+    }
+
+    Emit(builder, IR_RET, builder->func->undef, 0);
+    CleanupFunction(builder->func);
+    builder->func->line = 0;
+
+    return IR_SUCCESS;
+}
+
+static IRReturnCode LowerFunctions(IRBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return IR_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (LowerFunctions(builder, node->left) != IR_SUCCESS) return IR_SEMANTIC_ERROR;
+        return LowerFunctions(builder, node->right);
+    }
+
+    if (node->type != DECLARATOR || node->data != FUNC_DECLARATOR) return IR_SUCCESS;
+
+    return LowerFunction(builder, node);
+}
+
+IRModule* IRBuild(const Tree* ast) {
+    ASSERT(ast != NULL, "NULL POINTER WAS PASSED!\n");
+
+    IRModule* module = (IRModule*) calloc(1, sizeof(IRModule));
+    NULL_CHECK(module);
+
+    module->nametable = ast->nametable;
+    module->entry     = -1;
+
+    IRBuilder builder = {};
+    builder.module      = module;
+    builder.func_index  = (int*) calloc(NAMETABLE_SIZE, sizeof(int));
+    builder.local_index = (int*) calloc(NAMETABLE_SIZE, sizeof(int));
+
+    if (!builder.func_index || !builder.local_index) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(builder.func_index);
+        FREE(builder.local_index);
+        IRModuleDtor(module);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < NAMETABLE_SIZE; i++) builder.func_index[i] = -1;
+
+    int statements_count = 0;
+    IRReturnCode status = DeclareFunctions(&builder, ast->root, &statements_count);
+
+    if (status == IR_SUCCESS) status = LowerFunctions(&builder, ast->root);
+    if (status == IR_SUCCESS) status = LowerEntry(&builder, ast->root, statements_count);
+
+    FREE(builder.func_index);
+    FREE(builder.local_index);
+
+    if (status != IR_SUCCESS) {
+        fprintf(stderr, RED("Could not lower AST to IR!\n"));
+        IRModuleDtor(module);
+        return NULL;
+    }
+
+    return module;
+}
+
+//* ================================ optimizations ================================
+
+static void RemoveInstr(IRFunction* func, int instr) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    func->instrs[instr].block = -1;
+}
+
+/// @brief Drops removed instructions from the block lists
+static void CompactBlocks(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < func->blocks_count; i++) {
+        IRIntArray* instrs = &func->blocks[i].instrs;
+        size_t size = 0;
+
+        for (size_t j = 0; j < instrs->size; j++) {
+            if (func->instrs[ instrs->data[j] ].block == int(i)) instrs->data[size++] = instrs->data[j];
+        }
+
+        instrs->size = size;
+    }
+}
+
+static void KillBlock(IRFunction* func, int block) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int succs[2] = {};
+    int succs_count = IRBlockSuccs(func, block, succs);
+
+    for (int i = 0; i < succs_count; i++) RemoveEdge(func, block, succs[i]);
+
+    IRBlock* bb = &func->blocks[block];
+    for (size_t i = 0; i < bb->instrs.size; i++) RemoveInstr(func, bb->instrs.data[i]);
+
+    bb->instrs.size = 0;
+    bb->preds.size  = 0;
+    bb->dead        = 1;
+}
+
+static int RemoveUnreachableBlocks(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int* rpo       = (int*) calloc(func->blocks_count, sizeof(int));
+    int* reachable = (int*) calloc(func->blocks_count, sizeof(int));
+    if (!rpo || !reachable) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(rpo); FREE(reachable);
+        return 0;
+    }
+
+    size_t count = IRComputeRPO(func, rpo);
+    for (size_t i = 0; i < count; i++) reachable[ rpo[i] ] = 1;
+
+    int changed = 0;
+    for (size_t i = 0; i < func->blocks_count; i++) {
+        if (!reachable[i] && !func->blocks[i].dead) {
+            KillBlock(func, int(i));
+            changed = 1;
+        }
+    }
+
+    FREE(rpo);
+    FREE(reachable);
+
+    return changed;
+}
+
+/// @brief Replaces every use of a copy with its source and removes the copies
+static void PropagateCopies(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < func->instrs_count; i++) {
+        IRInstr* instr = &func->instrs[i];
+        if (instr->block == -1) continue;
+
+        for (size_t j = 0; j < instr->args.size; j++) instr->args.data[j] = Follow(func, instr->args.data[j]);
+    }
+
+    for (size_t i = 0; i < func->instrs_count; i++) {
+        if (func->instrs[i].block != -1 && func->instrs[i].opcode == IR_COPY) RemoveInstr(func, int(i));
+    }
+
+    CompactBlocks(func);
+}
+
+static int RemoveTrivialPhis(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int changed = 0, iteration_changed = 1;
+
+    while (iteration_changed) {
+        iteration_changed = 0;
+
+        for (size_t i = 0; i < func->instrs_count; i++) {
+            if (func->instrs[i].block == -1 || func->instrs[i].opcode != IR_PHI) continue;
+
+            if (TryRemoveTrivialPhi(func, int(i)) != int(i)) iteration_changed = changed = 1;
+        }
+    }
+
+    PropagateCopies(func);
+
+    return changed;
+}
+
+static void CleanupFunction(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < func->blocks_count; i++) FREE(func->blocks[i].defs);
+
+    RemoveUnreachableBlocks(func);
+    RemoveTrivialPhis(func);
+}
+
+/// @brief Builds lists of the instructions that use every value
+static IRIntArray* ComputeUsers(const IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    IRIntArray* users = (IRIntArray*) calloc(func->instrs_count + 1, sizeof(IRIntArray));
+    NULL_CHECK(users);
+
+    for (size_t i = 0; i < func->instrs_count; i++) {
+        const IRInstr* instr = &func->instrs[i];
+        if (instr->block == -1) continue;
+
+        for (size_t j = 0; j < instr->args.size; j++) IRIntArrayPush(&users[ instr->args.data[j] ], int(i));
+    }
+
+    return users;
+}
+
+static void UsersDtor(IRIntArray* users, size_t count) {
+    for (size_t i = 0; i < count; i++) IRIntArrayDtor(&users[i]);
+
+    FREE(users);
+}
+
+/// @brief Lattice values of sparse conditional constant propagation
+enum SCCPState {
+    SCCP_TOP      = 0,
+    SCCP_CONST    = 1,
+    SCCP_BOTTOM   = 2,
+};
+
+struct SCCPContext {
+    IRFunction*    func;
+    SCCPState*    state;
+    int*         values;
+    int*     block_exec;
+    int**     edge_exec; ///< per block, per predecessor
+    IRIntArray cfg_work; ///< pairs (from, to)
+    IRIntArray ssa_work;
+};
+
+static void SCCPSet(SCCPContext* ctx, int instr, SCCPState state, int value) {
+    if (ctx->state[instr] == state && (state != SCCP_CONST || ctx->values[instr] == value)) return;
+
+    ctx->state[instr]  = state;
+    ctx->values[instr] = value;
+    IRIntArrayPush(&ctx->ssa_work, instr);
+}
+
+static void SCCPAddEdge(SCCPContext* ctx, int from, int to) {
+    IRIntArrayPush(&ctx->cfg_work, from);
+    IRIntArrayPush(&ctx->cfg_work, to);
+}
+
+static void SCCPVisitPhi(SCCPContext* ctx, int phi) {
+    const IRInstr* instr = &ctx->func->instrs[phi];
+    const IRIntArray* preds = &ctx->func->blocks[instr->block].preds;
+
+    SCCPState state = SCCP_TOP;
+    int value = 0;
+
+    for (size_t i = 0; i < instr->args.size && i < preds->size; i++) {
+        if (!ctx->edge_exec[instr->block][i]) continue;
+
+        int arg = instr->args.data[i];
+        if (ctx->state[arg] == SCCP_TOP) continue;
+
+        if (ctx->state[arg] == SCCP_BOTTOM || (state == SCCP_CONST && ctx->values[arg] != value)) {
+            state = SCCP_BOTTOM;
+            break;
+        }
+
+        state = SCCP_CONST;
+        value = ctx->values[arg];
+    }
+
+    SCCPSet(ctx, phi, state, value);
+}
+
+static void SCCPVisitInstr(SCCPContext* ctx, int index) {
+    const IRInstr* instr = &ctx->func->instrs[index];
+
+    switch (instr->opcode) {
+        case IR_PHI:
+            SCCPVisitPhi(ctx, index);
+            return;
+
+        case IR_CONST:
+            SCCPSet(ctx, index, SCCP_CONST, instr->value);
+            return;
+
+        case IR_PARAM: case IR_CALL: case IR_SCAN:
+            SCCPSet(ctx, index, SCCP_BOTTOM, 0);
+            return;
+
+        case IR_COPY:
+            SCCPSet(ctx, index, ctx->state[instr->args.data[0]], ctx->values[instr->args.data[0]]);
+            return;
+
+        case IR_PRINT: case IR_RET:
+            return;
+
+        case IR_JMP:
+            SCCPAddEdge(ctx, instr->block, instr->targets[0]);
+            return;
+
+        case IR_BRANCH: {
+            int condition = instr->args.data[0];
+
+            if (ctx->state[condition] == SCCP_CONST) {
+                SCCPAddEdge(ctx, instr->block, instr->targets[ ctx->values[condition] != 0 ? 0 : 1 ]);
+            } else if (ctx->state[condition] == SCCP_BOTTOM) {
+                SCCPAddEdge(ctx, instr->block, instr->targets[0]);
+                SCCPAddEdge(ctx, instr->block, instr->targets[1]);
+            }
+            return;
+        }
+
+        case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_SQRT: case IR_LESS: case IR_MORE:
+        case IR_LESS_EQUAL: case IR_MORE_EQUAL: case IR_EQUAL: case IR_NOT_EQUAL: case IR_TRUNC:
+        default: {
+            int operands[2] = {};
+
+            for (size_t i = 0; i < instr->args.size && i < 2; i++) {
+                int arg = instr->args.data[i];
+
+                if (ctx->state[arg] == SCCP_BOTTOM) {
+                    SCCPSet(ctx, index, SCCP_BOTTOM, 0);
+                    return;
+                }
+                if (ctx->state[arg] == SCCP_TOP) return;
+
+                operands[i] = ctx->values[arg];
+            }
+
+            int result = 0;
+            if (IRFold(instr->opcode, operands[0], operands[1], &result)) SCCPSet(ctx, index, SCCP_CONST, result);
+            else                                                          SCCPSet(ctx, index, SCCP_BOTTOM, 0);
+            return;
+        }
+    }
+}
+
+static void SCCPVisitEdge(SCCPContext* ctx, int from, int to) {
+    IRFunction* func = ctx->func;
+
+    if (from != -1) {
+        int index = IRIntArrayFind(&func->blocks[to].preds, from);
+        if (index == -1 || ctx->edge_exec[to][index]) return;
+
+        ctx->edge_exec[to][index] = 1;
+    }
+
+    const IRIntArray* instrs = &func->blocks[to].instrs;
+
+    for (size_t i = 0; i < instrs->size; i++) {
+        if (func->instrs[ instrs->data[i] ].opcode == IR_PHI) SCCPVisitPhi(ctx, instrs->data[i]);
+    }
+
+    if (ctx->block_exec[to]) return;
+    ctx->block_exec[to] = 1;
+
+    for (size_t i = 0; i < instrs->size; i++) {
+        if (func->instrs[ instrs->data[i] ].opcode != IR_PHI) SCCPVisitInstr(ctx, instrs->data[i]);
+    }
+}
+
+/// @brief Applies the result of SCCP: folds constants and branches, removes never executed blocks
+static int SCCPRewrite(SCCPContext* ctx) {
+    IRFunction* func = ctx->func;
+    int changed = 0;
+
+    for (size_t i = 0; i < func->instrs_count; i++) {
+        IRInstr* instr = &func->instrs[i];
+        if (instr->block == -1 || !ctx->block_exec[instr->block]) continue;
+
+        if (ctx->state[i] == SCCP_CONST && instr->opcode != IR_CONST && IRIsPure(instr->opcode)) {
+            instr->opcode    = IR_CONST;
+            instr->value     = ctx->values[i];
+            instr->args.size = 0;
+            changed = 1;
+            continue;
+        }
+
+        if (instr->opcode == IR_BRANCH && ctx->state[ instr->args.data[0] ] == SCCP_CONST) {
+            int taken     = ctx->values[ instr->args.data[0] ] != 0 ? 0 : 1;
+            int not_taken = instr->targets[1 - taken];
+
+            instr->opcode     = IR_JMP;
+            instr->targets[0] = instr->targets[taken];
+            instr->targets[1] = -1;
+            instr->args.size  = 0;
+
+            if (not_taken != instr->targets[0]) RemoveEdge(func, instr->block, not_taken);
+            changed = 1;
+        }
+    }
+
+    for (size_t i = 0; i < func->blocks_count; i++) {
+        if (!func->blocks[i].dead && !ctx->block_exec[i]) {
+            KillBlock(func, int(i));
+            changed = 1;
+        }
+    }
+
+    return changed;
+}
+
+//* Wegman, Zadeck "Constant Propagation with Conditional Branches"
+static int SparseConditionalConstantPropagation(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    SCCPContext ctx = {};
+    ctx.func       = func;
+    ctx.state      = (SCCPState*) calloc(func->instrs_count, sizeof(SCCPState));
+    ctx.values     = (int*)       calloc(func->instrs_count, sizeof(int));
+    ctx.block_exec = (int*)       calloc(func->blocks_count, sizeof(int));
+    ctx.edge_exec  = (int**)      calloc(func->blocks_count, sizeof(int*));
+    IRIntArray* users = ComputeUsers(func);
+
+    int changed = 0;
+
+    if (ctx.state && ctx.values && ctx.block_exec && ctx.edge_exec && users) {
+        for (size_t i = 0; i < func->blocks_count; i++) {
+            ctx.edge_exec[i] = (int*) calloc(func->blocks[i].preds.size + 1, sizeof(int));
+        }
+
+        SCCPAddEdge(&ctx, -1, 0);
+
+        while (ctx.cfg_work.size > 0 || ctx.ssa_work.size > 0) {
+            if (ctx.cfg_work.size > 0) {
+                int to   = ctx.cfg_work.data[--ctx.cfg_work.size];
+                int from = ctx.cfg_work.data[--ctx.cfg_work.size];
+
+                SCCPVisitEdge(&ctx, from, to);
+                continue;
+            }
+
+            int value = ctx.ssa_work.data[--ctx.ssa_work.size];
+
+            for (size_t i = 0; i < users[value].size; i++) {
+                int user = users[value].data[i];
+                if (ctx.block_exec[ func->instrs[user].block ]) SCCPVisitInstr(&ctx, user);
+            }
+        }
+
+        changed = SCCPRewrite(&ctx);
+
+        for (size_t i = 0; i < func->blocks_count; i++) FREE(ctx.edge_exec[i]);
+    } else {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+    }
+
+    if (users) UsersDtor(users, func->instrs_count + 1);
+    IRIntArrayDtor(&ctx.cfg_work);
+    IRIntArrayDtor(&ctx.ssa_work);
+    FREE(ctx.state);
+    FREE(ctx.values);
+    FREE(ctx.block_exec);
+    FREE(ctx.edge_exec);
+
+    CompactBlocks(func);
+
+    return changed;
+}
+
+static int IsNumbered(IROpcode opcode) {
+    return IRIsPure(opcode) && opcode != IR_PHI && opcode != IR_COPY;
+}
+
+static int IsCommutative(IROpcode opcode) {
+    return opcode == IR_ADD || opcode == IR_MUL || opcode == IR_EQUAL || opcode == IR_NOT_EQUAL;
+}
+
+struct GVNContext {
+    IRFunction*     func;
+    int*           table; ///< open addressing hash table with instruction indexes
+    size_t      capacity;
+    IRIntArray      undo; ///< filled slots, cleared when the dominator subtree is left
+    int*            idom;
+    IRIntArray* children;
+    int          changed;
+};
+
+static void GVNKey(const IRFunction* func, int index, int* arg0, int* arg1) {
+    const IRInstr* instr = &func->instrs[index];
+
+    *arg0 = instr->args.size > 0 ? Follow(func, instr->args.data[0]) : -1;
+    *arg1 = instr->args.size > 1 ? Follow(func, instr->args.data[1]) : -1;
+
+    if (IsCommutative(instr->opcode) && *arg0 > *arg1) {
+        int temp = *arg0;
+        *arg0 = *arg1;
+        *arg1 = temp;
+    }
+}
+
+static size_t GVNHash(const IRFunction* func, int index) {
+    int arg0 = 0, arg1 = 0;
+    GVNKey(func, index, &arg0, &arg1);
+
+    const IRInstr* instr = &func->instrs[index];
+    size_t hash = size_t(instr->opcode) * 31 + size_t(unsigned(instr->value));
+
+    hash = hash * 1000003 + size_t(unsigned(arg0));
+    hash = hash * 1000003 + size_t(unsigned(arg1));
+
+    return hash;
+}
+
+static int GVNEqual(const IRFunction* func, int first, int second) {
+    const IRInstr* a = &func->instrs[first];
+    const IRInstr* b = &func->instrs[second];
+
+    if (a->opcode != b->opcode || a->value != b->value) return 0;
+
+    int a0 = 0, a1 = 0, b0 = 0, b1 = 0;
+    GVNKey(func, first,  &a0, &a1);
+    GVNKey(func, second, &b0, &b1);
+
+    return a0 == b0 && a1 == b1;
+}
+
+static void GVNBlock(GVNContext* ctx, int block) {
+    IRFunction* func = ctx->func;
+    size_t undo_mark = ctx->undo.size;
+    const IRIntArray* instrs = &func->blocks[block].instrs;
+
+    for (size_t i = 0; i < instrs->size; i++) {
+        int index = instrs->data[i];
+        if (!IsNumbered(func->instrs[index].opcode)) continue;
+
+        size_t slot = GVNHash(func, index) & (ctx->capacity - 1);
+
+        while (ctx->table[slot] != -1 && !GVNEqual(func, ctx->table[slot], index)) {
+            slot = (slot + 1) & (ctx->capacity - 1);
+        }
+
+        if (ctx->table[slot] != -1) {
+            //* the same value was computed in a dominating block
+            IRInstr* instr   = &func->instrs[index];
+            instr->opcode    = IR_COPY;
+            instr->value     = index;
+            instr->args.size = 0;
+            IRIntArrayPush(&instr->args, ctx->table[slot]);
+            ctx->changed = 1;
+            continue;
+        }
+
+        ctx->table[slot] = index;
+        IRIntArrayPush(&ctx->undo, int(slot));
+    }
+
+    for (size_t i = 0; i < ctx->children[block].size; i++) GVNBlock(ctx, ctx->children[block].data[i]);
+
+    //* entries are removed in the reverse order, so the probe sequences stay valid
+    while (ctx->undo.size > undo_mark) ctx->table[ ctx->undo.data[--ctx->undo.size] ] = -1;
+}
+
+/// @brief Dominator based global value numbering
+static int GlobalValueNumbering(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    GVNContext ctx = {};
+    ctx.func     = func;
+    ctx.capacity = 16;
+    while (ctx.capacity < func->instrs_count * 2) ctx.capacity *= 2;
+
+    ctx.table    = (int*)        calloc(ctx.capacity,      sizeof(int));
+    ctx.idom     = (int*)        calloc(func->blocks_count, sizeof(int));
+    ctx.children = (IRIntArray*) calloc(func->blocks_count, sizeof(IRIntArray));
+
+    if (ctx.table && ctx.idom && ctx.children) {
+        for (size_t i = 0; i < ctx.capacity; i++) ctx.table[i] = -1;
+
+        IRComputeDominators(func, ctx.idom);
+        for (size_t i = 1; i < func->blocks_count; i++) {
+            if (ctx.idom[i] != -1) IRIntArrayPush(&ctx.children[ ctx.idom[i] ], int(i));
+        }
+
+        GVNBlock(&ctx, 0);
+
+        for (size_t i = 0; i < func->blocks_count; i++) IRIntArrayDtor(&ctx.children[i]);
+    } else {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+    }
+
+    IRIntArrayDtor(&ctx.undo);
+    FREE(ctx.table);
+    FREE(ctx.idom);
+    FREE(ctx.children);
+
+    PropagateCopies(func);
+
+    return ctx.changed;
+}
+
+/// @brief Removes instructions whose values are never used (dead stores to variables included)
+static int DeadCodeElimination(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int* live = (int*) calloc(func->instrs_count, sizeof(int));
+    IRIntArray work = {};
+    if (!live) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return 0;
+    }
+
+    for (size_t i = 0; i < func->instrs_count; i++) {
+        const IRInstr* instr = &func->instrs[i];
+
+        if (instr->block != -1 && !IRIsPure(instr->opcode)) {
+            live[i] = 1;
+            IRIntArrayPush(&work, int(i));
+        }
+    }
+
+    while (work.size > 0) {
+        const IRInstr* instr = &func->instrs[ work.data[--work.size] ];
+
+        for (size_t i = 0; i < instr->args.size; i++) {
+            int arg = instr->args.data[i];
+
+            if (!live[arg]) {
+                live[arg] = 1;
+                IRIntArrayPush(&work, arg);
+            }
+        }
+    }
+
+    int changed = 0;
+    for (size_t i = 0; i < func->instrs_count; i++) {
+        if (func->instrs[i].block != -1 && !live[i]) {
+            RemoveInstr(func, int(i));
+            changed = 1;
+        }
+    }
+
+    IRIntArrayDtor(&work);
+    FREE(live);
+
+    CompactBlocks(func);
+
+    return changed;
+}
+
+void IRComputeIntegral(const IRFunction* func, int* integral) {
+    ASSERT(func     != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(integral != NULL, "NULL POINTER WAS PASSED!\n");
+
+    //* optimistic start: loops of phis with integer inputs stay integer
+    for (size_t i = 0; i < func->instrs_count; i++) integral[i] = 1;
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+
+        for (size_t i = 0; i < func->instrs_count; i++) {
+            const IRInstr* instr = &func->instrs[i];
+            if (instr->block == -1) continue;
+
+            //* out of SSA a value may have several definitions (copies), each of them must be integer
+            int def = IRDefinedValue(func, int(i));
+            if (def == -1 || !integral[def]) continue;
+
+            int value = 1;
+
+            switch (instr->opcode) {
+                case IR_CONST:
+                    value = instr->value % CALC_ACCURACY == 0;
+                    break;
+                case IR_DIV: case IR_CALL:
+                    value = 0;
+                    break;
+                case IR_ADD: case IR_SUB: case IR_MUL: case IR_PHI: case IR_COPY:
+                    for (size_t j = 0; j < instr->args.size; j++) value = value && integral[ instr->args.data[j] ];
+                    break;
+                case IR_PARAM: case IR_SQRT: case IR_LESS: case IR_MORE: case IR_LESS_EQUAL: case IR_MORE_EQUAL:
+                case IR_EQUAL: case IR_NOT_EQUAL: case IR_TRUNC: case IR_SCAN: case IR_PRINT: case IR_JMP:
+                case IR_BRANCH: case IR_RET:
+                default:
+                    break;
+            }
+
+            if (!value) {
+                integral[def] = 0;
+                changed = 1;
+            }
+        }
+    }
+}
+
+/// @brief Removes truncations of the values that have no fractional part
+static int SimplifyTruncs(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int* integral = (int*) calloc(func->instrs_count, sizeof(int));
+    if (!integral) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return 0;
+    }
+
+    IRComputeIntegral(func, integral);
+
+    int changed = 0;
+    for (size_t i = 0; i < func->instrs_count; i++) {
+        IRInstr* instr = &func->instrs[i];
+
+        if (instr->block != -1 && instr->opcode == IR_TRUNC && integral[ instr->args.data[0] ]) {
+            instr->opcode = IR_COPY;
+            instr->value  = int(i);
+            changed = 1;
+        }
+    }
+
+    FREE(integral);
+    PropagateCopies(func);
+
+    return changed;
+}
+
+/// @brief Constant for the limit of optimization rounds
+static const int IR_OPTIMIZE_ROUNDS = 8;
+
+IRReturnCode IROptimize(IRModule* module) {
+    ASSERT(module != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < module->functions_count; i++) {
+        IRFunction* func = module->functions[i];
+
+        for (int round = 0; round < IR_OPTIMIZE_ROUNDS; round++) {
+            int changed = 0;
+
+            changed |= SparseConditionalConstantPropagation(func);
+            changed |= SimplifyTruncs(func);
+            changed |= RemoveTrivialPhis(func);
+            changed |= GlobalValueNumbering(func);
+            changed |= RemoveTrivialPhis(func);
+            changed |= DeadCodeElimination(func);
+
+            if (!changed) break;
+        }
+    }
+
+    return IR_SUCCESS;
+}
+
+//* ================================== out of SSA ==================================
+
+/// @brief Puts a block on the edge, so that the copies for the target phis have their own place
+static int SplitEdge(IRFunction* func, int from, int to) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int split = NewBlock(func);
+    if (split == -1) return -1;
+
+    func->blocks[split].sealed = 1;
+
+    int jmp = AddInstr(func, split, IR_JMP);
+    if (jmp == -1) return -1;
+    func->instrs[jmp].targets[0] = to;
+
+    IRIntArrayPush(&func->blocks[split].preds, from);
+
+    IRInstr* last = &func->instrs[ func->blocks[from].instrs.data[func->blocks[from].instrs.size - 1] ];
+    last->targets[ last->targets[0] == to ? 0 : 1 ] = split;
+
+    IRIntArray* preds = &func->blocks[to].preds;
+    preds->data[ IRIntArrayFind(preds, from) ] = split;
+
+    return split;
+}
+
+/// @brief Inserts copy dest = source before the terminator of the block
+static int InsertCopy(IRFunction* func, int block, int dest, int source) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int copy = AddInstr(func, block, IR_COPY);
+    if (copy == -1) return -1;
+
+    func->instrs[copy].value = dest == -1 ? copy : dest;
+    IRIntArrayPush(&func->instrs[copy].args, source);
+
+    IRIntArray* instrs = &func->blocks[block].instrs;
+    instrs->data[instrs->size - 1] = instrs->data[instrs->size - 2];
+    instrs->data[instrs->size - 2] = copy;
+
+    return copy;
+}
+
+/// @brief Sequentializes the parallel copy dests[i] = sources[i] (the phis of one incoming edge)
+static IRReturnCode EmitParallelCopy(IRFunction* func, int block, int* dests, int* sources, size_t count) {
+    ASSERT(func    != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(dests   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(sources != NULL, "NULL POINTER WAS PASSED!\n");
+
+    while (count > 0) {
+        size_t ready = count;
+
+        //* a copy is ready when no other pending copy still reads its destination
+        for (size_t i = 0; i < count && ready == count; i++) {
+            ready = i;
+            for (size_t j = 0; j < count; j++) {
+                if (j != i && sources[j] == dests[i]) {
+                    ready = count;
+                    break;
+                }
+            }
+        }
+
+        if (ready == count) {
+            //* only cycles are left: save one destination to a temporary and read it from there
+            int temp = InsertCopy(func, block, -1, dests[0]);
+            if (temp == -1) return IR_MEMORY_ERROR;
+
+            for (size_t j = 0; j < count; j++) {
+                if (sources[j] == dests[0]) sources[j] = temp;
+            }
+            continue;
+        }
+
+        if (InsertCopy(func, block, dests[ready], sources[ready]) == -1) return IR_MEMORY_ERROR;
+
+        count--;
+        dests[ready]   = dests[count];
+        sources[ready] = sources[count];
+    }
+
+    return IR_SUCCESS;
+}
+
+static IRReturnCode LeaveSSA(IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t blocks_count = func->blocks_count;
+
+    for (size_t i = 0; i < blocks_count; i++) {
+        if (func->blocks[i].dead || func->blocks[i].instrs.size == 0) continue;
+
+        size_t phis_count = 0;
+        while (phis_count < func->blocks[i].instrs.size &&
+               func->instrs[ func->blocks[i].instrs.data[phis_count] ].opcode == IR_PHI) phis_count++;
+
+        if (phis_count == 0) continue;
+
+        int* dests   = (int*) calloc(phis_count, sizeof(int));
+        int* sources = (int*) calloc(phis_count, sizeof(int));
+        if (!dests || !sources) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            FREE(dests); FREE(sources);
+            return IR_MEMORY_ERROR;
+        }
+
+        for (size_t j = 0; j < func->blocks[i].preds.size; j++) {
+            int pred = func->blocks[i].preds.data[j];
+            int succs[2] = {};
+
+            //* critical edge: the copies would run on the other path of the branch too
+            if (IRBlockSuccs(func, pred, succs) > 1) pred = SplitEdge(func, pred, int(i));
+            if (pred == -1) {
+                FREE(dests); FREE(sources);
+                return IR_MEMORY_ERROR;
+            }
+
+            size_t count = 0;
+            for (size_t k = 0; k < phis_count; k++) {
+                int phi    = func->blocks[i].instrs.data[k];
+                int source = func->instrs[phi].args.data[j];
+
+                if (source == phi) continue;
+
+                dests[count]   = phi;
+                sources[count] = source;
+                count++;
+            }
+
+            if (EmitParallelCopy(func, pred, dests, sources, count) != IR_SUCCESS) {
+                FREE(dests); FREE(sources);
+                return IR_MEMORY_ERROR;
+            }
+        }
+
+        //* the phi values stay as variables written by the copies
+        for (size_t k = 0; k < phis_count; k++) RemoveInstr(func, func->blocks[i].instrs.data[k]);
+
+        FREE(dests);
+        FREE(sources);
+    }
+
+    CompactBlocks(func);
+
+    return IR_SUCCESS;
+}
+
+IRReturnCode IRLeaveSSA(IRModule* module) {
+    ASSERT(module != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < module->functions_count; i++) {
+        IRReturnCode result = LeaveSSA(module->functions[i]);
+        if (result != IR_SUCCESS) return result;
+    }
+
+    return IR_SUCCESS;
+}
+
+//* ==================================== dump =====================================
+
+static const char* LocalName(const IRModule* module, const IRFunction* func, int var) {
+    if (var < 0 || size_t(var) >= func->locals_count) return NULL;
+
+    return module->nametable->names[ func->locals[var] ];
+}
+
+void IRDumpInstr(FILE* filename, const IRModule* module, const IRFunction* func, int index) {
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(module   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(func     != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRInstr* instr = &func->instrs[index];
+
+    int def = IRDefinedValue(func, index);
+    if (def != -1) fprintf(filename, "%%%d = ", def);
+
+    fprintf(filename, "%s", IR_OPCODE_NAMES[instr->opcode]);
+
+    switch (instr->opcode) {
+        case IR_CONST:
+            fprintf(filename, " %g", double(instr->value) / CALC_ACCURACY);
+            break;
+        case IR_PARAM:
+            fprintf(filename, " %d", instr->value);
+            break;
+        case IR_CALL:
+            fprintf(filename, " %s", module->functions[instr->value]->name);
+            break;
+        case IR_PHI: {
+            const IRIntArray* preds = &func->blocks[instr->block].preds;
+            for (size_t i = 0; i < instr->args.size; i++) {
+                fprintf(filename, "%s [%%%d, bb%d]", i ? "," : "", instr->args.data[i],
+                                  i < preds->size ? preds->data[i] : -1);
+            }
+            break;
+        }
+        case IR_COPY: case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_SQRT: case IR_LESS:
+        case IR_MORE: case IR_LESS_EQUAL: case IR_MORE_EQUAL: case IR_EQUAL: case IR_NOT_EQUAL: case IR_TRUNC:
+        case IR_SCAN: case IR_PRINT: case IR_JMP: case IR_BRANCH: case IR_RET:
+        default:
+            break;
+    }
+
+    if (instr->opcode != IR_PHI) {
+        for (size_t i = 0; i < instr->args.size; i++) {
+            fprintf(filename, "%s%%%d", i ? ", " : " ", instr->args.data[i]);
+        }
+    }
+
+    if (instr->opcode == IR_JMP)    fprintf(filename, " bb%d", instr->targets[0]);
+    if (instr->opcode == IR_BRANCH) fprintf(filename, ", bb%d, bb%d", instr->targets[0], instr->targets[1]);
+
+    const char* name = LocalName(module, func, instr->var);
+    if (name) fprintf(filename, "\t; %s", name);
+}
+
+IRReturnCode IRDump(FILE* filename, const IRModule* module) {
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(module   != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < module->functions_count; i++) {
+        const IRFunction* func = module->functions[i];
+
+        fprintf(filename, "function %s (%d parameters)%s\n", func->name, func->params_count,
+                          int(i) == module->entry ? " entry" : "");
+
+        for (size_t j = 0; j < func->blocks_count; j++) {
+            const IRBlock* block = &func->blocks[j];
+            if (block->dead) continue;
+
+            fprintf(filename, "  bb%lu:\t; preds:", j);
+            for (size_t k = 0; k < block->preds.size; k++) fprintf(filename, " bb%d", block->preds.data[k]);
+            fputc('\n', filename);
+
+            for (size_t k = 0; k < block->instrs.size; k++) {
+                fprintf(filename, "    ");
+                IRDumpInstr(filename, module, func, block->instrs.data[k]);
+                fputc('\n', filename);
+            }
+        }
+
+        fputc('\n', filename);
+    }
+
+    return IR_SUCCESS;
+}
+
+IRReturnCode WriteIR(const IRModule* module) {
+    ASSERT(module != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FILE* ir_file = fopen(IR_FILENAME, "wb");
+    if (!ir_file) {
+        fprintf(stderr, RED("Error occured while opening %s!\n"), IR_FILENAME);
+        return IR_FILE_ERROR;
+    }
+
+    IRDump(ir_file, module);
+    fclose(ir_file);
+
+    return IR_SUCCESS;
+}
@@ -0,0 +1,780 @@
+/*!
+    \file
+    File with the tree-walking interpreter: names are resolved once, then the resolved tree is run
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Interpreter.h"
+#include "LanguageSyntaxis.h"
+#include "IR.h"
+
+/// @brief Constant for the start size of the frames stack
+static const size_t INTERP_STACK_SIZE = 256;
+
+/// @brief Structure with the state of name resolution
+struct InterpBuilder {
+    ExecProgram*     program;
+    const NameTable* nametable;
+    int*          func_index; ///< nametable index -> function index or -1
+    int*          slot_index; ///< nametable index -> frame slot of the current function or -1
+    int          slots_count;
+};
+
+/// @brief Enum with results of the statement execution
+enum ExecResult {
+    RESULT_NEXT   = 0,
+    RESULT_RETURN = 1,
+    RESULT_ERROR  = 2,
+};
+
+/// @brief Structure with the state of the running program
+struct Interpreter {
+    const ExecProgram* program;
+    int*                 stack; ///< frames of the called functions, one cell per slot
+    size_t          stack_size;
+    size_t      stack_capacity;
+    int            return_value;
+    int                  error;
+};
+
+//* ================================== resolution ==================================
+
+static int NewExecNode(ExecProgram* program, ExecKind kind, int value) {
+    ASSERT(program != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (program->nodes_count >= program->nodes_capacity) {
+        size_t new_capacity = program->nodes_capacity ? program->nodes_capacity * 2 : 64;
+
+        ExecNode* new_nodes = (ExecNode*) realloc(program->nodes, new_capacity * sizeof(ExecNode));
+        if (!new_nodes) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return -1;
+        }
+
+        program->nodes          = new_nodes;
+        program->nodes_capacity = new_capacity;
+    }
+
+    program->nodes[program->nodes_count] = {kind, value, -1, -1, -1, 0, 0};
+
+    return int(program->nodes_count++);
+}
+
+/// @brief Moves the collected children into the items pool, so that they lie together
+static InterpReturnCode SetItems(ExecProgram* program, int node, IRIntArray* children) {
+    ASSERT(program  != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(children != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (program->items_count + children->size > program->items_capacity) {
+        size_t new_capacity = (program->items_capacity + children->size) * 2;
+
+        int* new_items = (int*) realloc(program->items, new_capacity * sizeof(int));
+        if (!new_items) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            IRIntArrayDtor(children);
+            return INTERP_MEMORY_ERROR;
+        }
+
+        program->items          = new_items;
+        program->items_capacity = new_capacity;
+    }
+
+    program->nodes[node].items       = int(program->items_count);
+    program->nodes[node].items_count = int(children->size);
+
+    if (children->size) memcpy(program->items + program->items_count, children->data, children->size * sizeof(int));
+    program->items_count += children->size;
+
+    IRIntArrayDtor(children);
+
+    return INTERP_SUCCESS;
+}
+
+static int IsFunction(const InterpBuilder* builder, const Node* node) {
+    return node->type == VARIABLE && builder->func_index[node->data] != -1;
+}
+
+static int GetSlot(InterpBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (builder->slot_index[node->data] == -1) builder->slot_index[node->data] = builder->slots_count++;
+
+    return builder->slot_index[node->data];
+}
+
+static IROpcode OperatorToIR(int code) {
+    switch (code) {
+        case ADD:        return IR_ADD;
+        case SUB:        return IR_SUB;
+        case MUL:        return IR_MUL;
+        case DIV:        return IR_DIV;
+        case LESS:       return IR_LESS;
+        case MORE:       return IR_MORE;
+        case LESS_EQUAL: return IR_LESS_EQUAL;
+        case MORE_EQUAL: return IR_MORE_EQUAL;
+        case EQUAL:      return IR_EQUAL;
+        case NOT_EQUAL:  return IR_NOT_EQUAL;
+        case SQRT:       return IR_SQRT;
+        default:         return IR_RET;
+    }
+}
+
+static int ResolveExpression(InterpBuilder* builder, const Node* node);
+
+static InterpReturnCode ResolveArguments(InterpBuilder* builder, const Node* node, IRIntArray* args) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return INTERP_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (ResolveArguments(builder, node->left, args) != INTERP_SUCCESS) return INTERP_SEMANTIC_ERROR;
+        return ResolveArguments(builder, node->right, args);
+    }
+
+    int arg = ResolveExpression(builder, node);
+    if (arg == -1) return INTERP_SEMANTIC_ERROR;
+
+    return IRIntArrayPush(args, arg) == IR_SUCCESS ? INTERP_SUCCESS : INTERP_MEMORY_ERROR;
+}
+
+static int ResolveCall(InterpBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int callee = builder->func_index[node->data];
+    IRIntArray args = {};
+
+    if (ResolveArguments(builder, node->left, &args) != INTERP_SUCCESS) {
+        IRIntArrayDtor(&args);
+        return -1;
+    }
+
+    const ExecFunction* function = &builder->program->functions[callee];
+    if (int(args.size) != function->params_count) {
+        fprintf(stderr, RED("Function %s takes %d parameters, %lu were passed!\n"),
+                function->name, function->params_count, args.size);
+        IRIntArrayDtor(&args);
+        return -1;
+    }
+
+    int call = NewExecNode(builder->program, EXEC_CALL, callee);
+    if (call == -1 || SetItems(builder->program, call, &args) != INTERP_SUCCESS) return -1;
+
+    return call;
+}
+
+static int ResolveExpression(InterpBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) {
+        fprintf(stderr, RED("Empty expression!\n"));
+        return -1;
+    }
+
+    switch (node->type) {
+        case NUMBER:
+            return NewExecNode(builder->program, EXEC_NUMBER, node->data * CALC_ACCURACY);
+
+        case VARIABLE:
+            if (IsFunction(builder, node)) return ResolveCall(builder, node);
+
+            return NewExecNode(builder->program, EXEC_LOCAL, GetSlot(builder, node));
+
+        case OPERATOR: {
+            IROpcode opcode = OperatorToIR(node->data);
+
+            if (opcode == IR_SQRT) {
+                int operand = ResolveExpression(builder, node->right);
+                if (operand == -1) return -1;
+
+                int sqrt_node = NewExecNode(builder->program, EXEC_SQRT, 0);
+                if (sqrt_node != -1) builder->program->nodes[sqrt_node].first = operand;
+
+                return sqrt_node;
+            }
+
+            if (opcode == IR_RET) break;
+
+            int left = ResolveExpression(builder, node->left);
+            if (left == -1) return -1;
+
+            int right = ResolveExpression(builder, node->right);
+            if (right == -1) return -1;
+
+            int binary = NewExecNode(builder->program, EXEC_BINARY, opcode);
+            if (binary != -1) {
+                builder->program->nodes[binary].first  = left;
+                builder->program->nodes[binary].second = right;
+            }
+
+            return binary;
+        }
+        case DECLARATOR:
+        case KEYWORD:
+        case SEPARATOR:
+        default:
+            break;
+    }
+
+    fprintf(stderr, RED("Unexpected node in expression (type %d, data %d)!\n"), node->type, node->data);
+
+    return -1;
+}
+
+static int ResolveStatement(InterpBuilder* builder, const Node* node);
+
+/// @brief Flattens the chain of statements into one list
+static InterpReturnCode CollectStatements(InterpBuilder* builder, const Node* node, IRIntArray* statements) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return INTERP_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (CollectStatements(builder, node->left, statements) != INTERP_SUCCESS) return INTERP_SEMANTIC_ERROR;
+        return CollectStatements(builder, node->right, statements);
+    }
+
+    //* function declarations are resolved separately
+    if (node->type == DECLARATOR && node->data == FUNC_DECLARATOR) return INTERP_SUCCESS;
+
+    int statement = ResolveStatement(builder, node);
+    if (statement == -1) return INTERP_SEMANTIC_ERROR;
+
+    return IRIntArrayPush(statements, statement) == IR_SUCCESS ? INTERP_SUCCESS : INTERP_MEMORY_ERROR;
+}
+
+static int ResolveBlock(InterpBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    IRIntArray statements = {};
+
+    if (CollectStatements(builder, node, &statements) != INTERP_SUCCESS) {
+        IRIntArrayDtor(&statements);
+        return -1;
+    }
+
+    int block = NewExecNode(builder->program, EXEC_BLOCK, 0);
+    if (block == -1 || SetItems(builder->program, block, &statements) != INTERP_SUCCESS) return -1;
+
+    return block;
+}
+
+/// @brief Creates node with one expression operand
+static int ResolveUnary(InterpBuilder* builder, ExecKind kind, int value, const Node* expression) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int operand = ResolveExpression(builder, expression);
+    if (operand == -1) return -1;
+
+    int node = NewExecNode(builder->program, kind, value);
+    if (node != -1) builder->program->nodes[node].first = operand;
+
+    return node;
+}
+
+static int ResolveKeyWord(InterpBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    switch (node->data) {
+        case IF: {
+            //* IF: right - condition, left - IF node with the true branch in left and else branch in right
+            int condition = ResolveExpression(builder, node->right);
+            if (condition == -1) return -1;
+
+            int then_branch = ResolveBlock(builder, node->left->left);
+            if (then_branch == -1) return -1;
+
+            int else_branch = -1;
+            if (node->left->right && (else_branch = ResolveBlock(builder, node->left->right)) == -1) return -1;
+
+            int if_node = NewExecNode(builder->program, EXEC_IF, 0);
+            if (if_node != -1) {
+                builder->program->nodes[if_node].first  = condition;
+                builder->program->nodes[if_node].second = then_branch;
+                builder->program->nodes[if_node].third  = else_branch;
+            }
+
+            return if_node;
+        }
+
+        case WHILE: {
+            //* WHILE: right - condition, left - body
+            int condition = ResolveExpression(builder, node->right);
+            if (condition == -1) return -1;
+
+            int body = ResolveBlock(builder, node->left);
+            if (body == -1) return -1;
+
+            int while_node = NewExecNode(builder->program, EXEC_WHILE, 0);
+            if (while_node != -1) {
+                builder->program->nodes[while_node].first  = condition;
+                builder->program->nodes[while_node].second = body;
+            }
+
+            return while_node;
+        }
+
+        case RETURN:
+            return ResolveUnary(builder, EXEC_RETURN, 0, node->left);
+
+        case PRINT:
+            return ResolveUnary(builder, EXEC_PRINT, 0, node->left);
+
+        case SCAN:
+            if (!node->right || node->right->type != VARIABLE || IsFunction(builder, node->right)) {
+                fprintf(stderr, RED("Only variables can be scanned!\n"));
+                return -1;
+            }
+
+            return NewExecNode(builder->program, EXEC_SCAN, GetSlot(builder, node->right));
+
+        default:
+            fprintf(stderr, RED("Unexpected keyword in statement!\n"));
+            return -1;
+    }
+}
+
+static int ResolveStatement(InterpBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    switch (node->type) {
+        case SEPARATOR:
+            if (node->data == END_LINE) return ResolveBlock(builder, node);
+            break;
+
+        case DECLARATOR:
+            if (node->data == VAR_DECLARATOR) return ResolveStatement(builder, node->left);
+
+            fprintf(stderr, RED("Functions can be declared only at the top level!\n"));
+            return -1;
+
+        case OPERATOR:
+            if (node->data != ASSIGN) break;
+
+            if (!node->left || node->left->type != VARIABLE || IsFunction(builder, node->left)) {
+                fprintf(stderr, RED("Only variables can be assigned!\n"));
+                return -1;
+            }
+
+            return ResolveUnary(builder, EXEC_ASSIGN, GetSlot(builder, node->left), node->right);
+
+        case KEYWORD:
+            return ResolveKeyWord(builder, node);
+
+        case NUMBER:
+        case VARIABLE:
+        default:
+            break;
+    }
+
+    fprintf(stderr, RED("Unexpected node in statement (type %d, data %d)!\n"), node->type, node->data);
+
+    return -1;
+}
+
+static InterpReturnCode AddFunction(ExecProgram* program, const char* name, int params_count) {
+    ASSERT(program != NULL, "NULL POINTER WAS PASSED!\n");
+
+    ExecFunction* new_functions = (ExecFunction*) realloc(program->functions,
+                                                          (program->functions_count + 1) * sizeof(ExecFunction));
+    if (!new_functions) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return INTERP_MEMORY_ERROR;
+    }
+
+    program->functions = new_functions;
+    program->functions[program->functions_count++] = {name, -1, params_count, params_count};
+
+    return INTERP_SUCCESS;
+}
+
+static int CountParameters(const Node* node) {
+    if (!node) return 0;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) return CountParameters(node->left) + CountParameters(node->right);
+
+    return 1;
+}
+
+/// @brief Registers functions of the top level and counts the other statements
+static InterpReturnCode DeclareFunctions(InterpBuilder* builder, const Node* node, int* statements_count) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return INTERP_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (DeclareFunctions(builder, node->left, statements_count) != INTERP_SUCCESS) return INTERP_SEMANTIC_ERROR;
+        return DeclareFunctions(builder, node->right, statements_count);
+    }
+
+    if (node->type != DECLARATOR || node->data != FUNC_DECLARATOR) {
+        (*statements_count)++;
+        return INTERP_SUCCESS;
+    }
+
+    //* FUNC_DECLARATOR: left - body, right->right - name, right->left - parameters
+    int name_index = node->right->right->data;
+
+    if (builder->func_index[name_index] != -1) {
+        fprintf(stderr, RED("Function %s is declared twice!\n"), builder->nametable->names[name_index]);
+        return INTERP_SEMANTIC_ERROR;
+    }
+
+    builder->func_index[name_index] = int(builder->program->functions_count);
+
+    return AddFunction(builder->program, builder->nametable->names[name_index], CountParameters(node->right->left));
+}
+
+static void ResetSlots(InterpBuilder* builder) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < NAMETABLE_SIZE; i++) builder->slot_index[i] = -1;
+    builder->slots_count = 0;
+}
+
+static InterpReturnCode ResolveParameters(InterpBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return INTERP_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (ResolveParameters(builder, node->left) != INTERP_SUCCESS) return INTERP_SEMANTIC_ERROR;
+        return ResolveParameters(builder, node->right);
+    }
+
+    if (node->type != VARIABLE || builder->slot_index[node->data] != -1) {
+        fprintf(stderr, RED("Bad function parameter!\n"));
+        return INTERP_SEMANTIC_ERROR;
+    }
+
+    GetSlot(builder, node);
+
+    return INTERP_SUCCESS;
+}
+
+static InterpReturnCode ResolveFunctions(InterpBuilder* builder, const Node* node) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!node) return INTERP_SUCCESS;
+
+    if (node->type == SEPARATOR && node->data == END_LINE) {
+        if (ResolveFunctions(builder, node->left) != INTERP_SUCCESS) return INTERP_SEMANTIC_ERROR;
+        return ResolveFunctions(builder, node->right);
+    }
+
+    if (node->type != DECLARATOR || node->data != FUNC_DECLARATOR) return INTERP_SUCCESS;
+
+    int function = builder->func_index[node->right->right->data];
+    ResetSlots(builder);
+
+    //* parameters take the first slots of the frame in their order
+    if (ResolveParameters(builder, node->right->left) != INTERP_SUCCESS) return INTERP_SEMANTIC_ERROR;
+
+    int body = ResolveBlock(builder, node->left);
+    if (body == -1) return INTERP_SEMANTIC_ERROR;
+
+    builder->program->functions[function].body        = body;
+    builder->program->functions[function].slots_count = builder->slots_count;
+
+    return INTERP_SUCCESS;
+}
+
+/*!
+    The entry function runs the top level statements. If there are none,
+    it calls the last declared function (with zero arguments).
+*/
+static InterpReturnCode ResolveEntry(InterpBuilder* builder, const Node* root, int statements_count) {
+    ASSERT(builder != NULL, "NULL POINTER WAS PASSED!\n");
+
+    ExecProgram* program = builder->program;
+    int last_function = int(program->functions_count) - 1;
+
+    if (AddFunction(program, "main", 0) != INTERP_SUCCESS) return INTERP_MEMORY_ERROR;
+    program->entry = int(program->functions_count) - 1;
+
+    ResetSlots(builder);
+
+    int body = -1;
+    if (statements_count > 0 || last_function < 0) {
+        body = ResolveBlock(builder, root);
+    } else {
+        IRIntArray args = {};
+        for (int i = 0; i < program->functions[last_function].params_count; i++) {
+            IRIntArrayPush(&args, NewExecNode(program, EXEC_NUMBER, 0));
+        }
+
+        int call = NewExecNode(program, EXEC_CALL, last_function);
+        if (call != -1 && SetItems(program, call, &args) == INTERP_SUCCESS) {
+            IRIntArray statements = {};
+            IRIntArrayPush(&statements, call);
+
+            body = NewExecNode(program, EXEC_BLOCK, 0);
+            if (body != -1 && SetItems(program, body, &statements) != INTERP_SUCCESS) body = -1;
+        }
+    }
+
+    if (body == -1) return INTERP_SEMANTIC_ERROR;
+
+    program->functions[program->entry].body        = body;
+    program->functions[program->entry].slots_count = builder->slots_count;
+
+    return INTERP_SUCCESS;
+}
+
+void InterpDtor(ExecProgram* program) {
+    if (!program) return;
+
+    FREE(program->nodes);
+    FREE(program->items);
+    FREE(program->functions);
+    FREE(program);
+}
+
+ExecProgram* InterpBuild(const Tree* ast) {
+    ASSERT(ast != NULL, "NULL POINTER WAS PASSED!\n");
+
+    ExecProgram* program = (ExecProgram*) calloc(1, sizeof(ExecProgram));
+    NULL_CHECK(program);
+    program->entry = -1;
+
+    InterpBuilder builder = {};
+    builder.program    = program;
+    builder.nametable  = ast->nametable;
+    builder.func_index = (int*) calloc(NAMETABLE_SIZE, sizeof(int));
+    builder.slot_index = (int*) calloc(NAMETABLE_SIZE, sizeof(int));
+
+    if (!builder.func_index || !builder.slot_index) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(builder.func_index);
+        FREE(builder.slot_index);
+        InterpDtor(program);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < NAMETABLE_SIZE; i++) builder.func_index[i] = -1;
+
+    int statements_count = 0;
+    InterpReturnCode status = DeclareFunctions(&builder, ast->root, &statements_count);
+
+    if (status == INTERP_SUCCESS) status = ResolveFunctions(&builder, ast->root);
+    if (status == INTERP_SUCCESS) status = ResolveEntry(&builder, ast->root, statements_count);
+
+    FREE(builder.func_index);
+    FREE(builder.slot_index);
+
+    if (status != INTERP_SUCCESS) {
+        fprintf(stderr, RED("Could not prepare the program for the interpreter!\n"));
+        InterpDtor(program);
+        return NULL;
+    }
+
+    return program;
+}
+
+//* =================================== execution ==================================
+
+//* values are fixed point numbers (as on the SPU), variables keep only the integer part
+
+static int Truncate(int value) {
+    return value / CALC_ACCURACY * CALC_ACCURACY;
+}
+
+static int ReserveStack(Interpreter* interp, size_t count);
+
+static int Call(Interpreter* interp, int function, size_t frame);
+
+static int Eval(Interpreter* interp, int index, size_t frame) {
+    ASSERT(interp != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const ExecNode* node = &interp->program->nodes[index];
+
+    switch (node->kind) {
+        case EXEC_NUMBER:
+            return node->value;
+
+        case EXEC_LOCAL:
+            return interp->stack[frame + size_t(node->value)];
+
+        case EXEC_BINARY: {
+            int left  = Eval(interp, node->first,  frame);
+            int right = Eval(interp, node->second, frame);
+            int result = 0;
+
+            if (interp->error) return 0;
+
+            if (!IRFold(IROpcode(node->value), left, right, &result)) {
+                printf(RED("ERROR! DIVISION BY ZERO!!!\n"));
+                interp->error = 1;
+            }
+
+            return result;
+        }
+
+        case EXEC_SQRT: {
+            int operand = Eval(interp, node->first, frame);
+            int result  = 0;
+
+            if (interp->error) return 0;
+
+            if (!IRFold(IR_SQRT, operand, 0, &result)) {
+                printf(RED("SQRT ERROR!\n"));
+                interp->error = 1;
+            }
+
+            return result;
+        }
+
+        case EXEC_CALL: {
+            //* arguments are pushed where the callee frame begins, so they become its first slots
+            size_t base = interp->stack_size;
+
+            for (int i = 0; i < node->items_count; i++) {
+                int arg = Eval(interp, interp->program->items[node->items + i], frame);
+                if (interp->error || !ReserveStack(interp, 1)) return 0;
+
+                interp->stack[interp->stack_size++] = Truncate(arg);
+            }
+
+            return Call(interp, node->value, base);
+        }
+
+        case EXEC_ASSIGN: case EXEC_IF: case EXEC_WHILE: case EXEC_RETURN: case EXEC_PRINT: case EXEC_SCAN:
+        case EXEC_BLOCK:
+        default:
+            fprintf(stderr, RED("Statement in expression!\n"));
+            interp->error = 1;
+            return 0;
+    }
+}
+
+static ExecResult Exec(Interpreter* interp, int index, size_t frame) {
+    ASSERT(interp != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const ExecNode* node = &interp->program->nodes[index];
+
+    switch (node->kind) {
+        case EXEC_BLOCK:
+            for (int i = 0; i < node->items_count; i++) {
+                ExecResult result = Exec(interp, interp->program->items[node->items + i], frame);
+                if (result != RESULT_NEXT) return result;
+            }
+            return RESULT_NEXT;
+
+        case EXEC_ASSIGN: {
+            int value = Eval(interp, node->first, frame);
+            if (interp->error) return RESULT_ERROR;
+
+            interp->stack[frame + size_t(node->value)] = Truncate(value);
+            return RESULT_NEXT;
+        }
+
+        case EXEC_IF: {
+            int condition = Eval(interp, node->first, frame);
+            if (interp->error) return RESULT_ERROR;
+
+            if (condition != 0) return Exec(interp, node->second, frame);
+            if (node->third != -1) return Exec(interp, node->third, frame);
+
+            return RESULT_NEXT;
+        }
+
+        case EXEC_WHILE:
+            while (1) {
+                int condition = Eval(interp, node->first, frame);
+                if (interp->error) return RESULT_ERROR;
+                if (condition == 0) return RESULT_NEXT;
+
+                ExecResult result = Exec(interp, node->second, frame);
+                if (result != RESULT_NEXT) return result;
+            }
+
+        case EXEC_RETURN:
+            interp->return_value = Eval(interp, node->first, frame);
+            return interp->error ? RESULT_ERROR : RESULT_RETURN;
+
+        case EXEC_PRINT: {
+            int value = Eval(interp, node->first, frame);
+            if (interp->error) return RESULT_ERROR;
+
+            printf(GREEN("RESULT: %lg\n"), (double) value / CALC_ACCURACY);
+            return RESULT_NEXT;
+        }
+
+        case EXEC_SCAN: {
+            int value = 0;
+            printf(YELLOW("Enter a number: ")); scanf("%d", &value);
+
+            interp->stack[frame + size_t(node->value)] = value * CALC_ACCURACY;
+            return RESULT_NEXT;
+        }
+
+        case EXEC_NUMBER: case EXEC_LOCAL: case EXEC_BINARY: case EXEC_SQRT: case EXEC_CALL:
+        default:
+            Eval(interp, index, frame);
+            return interp->error ? RESULT_ERROR : RESULT_NEXT;
+    }
+}
+
+static int ReserveStack(Interpreter* interp, size_t count) {
+    ASSERT(interp != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (interp->stack_size + count <= interp->stack_capacity) return 1;
+
+    size_t new_capacity = (interp->stack_capacity + count) * 2;
+
+    int* new_stack = (int*) realloc(interp->stack, new_capacity * sizeof(int));
+    if (!new_stack) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        interp->error = 1;
+        return 0;
+    }
+
+    interp->stack          = new_stack;
+    interp->stack_capacity = new_capacity;
+
+    return 1;
+}
+
+/// @brief Runs the function, its arguments are already on the stack from the frame beginning
+static int Call(Interpreter* interp, int function, size_t frame) {
+    ASSERT(interp != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const ExecFunction* func = &interp->program->functions[function];
+    size_t locals_count = size_t(func->slots_count - func->params_count);
+
+    if (!ReserveStack(interp, locals_count)) return 0;
+
+    for (size_t i = 0; i < locals_count; i++) interp->stack[interp->stack_size++] = 0;
+
+    interp->return_value = 0;
+    ExecResult result = Exec(interp, func->body, frame);
+
+    interp->stack_size = frame;
+
+    //* falling off the end of the function returns 0
+    if (result == RESULT_NEXT) return 0;
+
+    return interp->return_value;
+}
+
+InterpReturnCode InterpRun(const ExecProgram* program) {
+    ASSERT(program != NULL, "NULL POINTER WAS PASSED!\n");
+
+    Interpreter interp = {};
+    interp.program        = program;
+    interp.stack_capacity = INTERP_STACK_SIZE;
+    interp.stack          = (int*) calloc(interp.stack_capacity, sizeof(int));
+
+    if (!interp.stack) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return INTERP_MEMORY_ERROR;
+    }
+
+    Call(&interp, program->entry, 0);
+
+    FREE(interp.stack);
+
+    return interp.error ? INTERP_RUNTIME_ERROR : INTERP_SUCCESS;
+}
@@ -0,0 +1,820 @@
+/*!
+    \file
+    File with the x86-64 JIT compiler of the SPU bytecode
+
+    Native registers: rbx - regs, r12 - ram, r14 - data stack, r13 - data stack size,
+    r15 - calls left before the overflow, rbp - stack pointer around the C++ helpers.
+    SPU CALL and RET are native call and ret, so the return addresses live on the native stack.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "Jit.h"
+#include "ReturnCodes.h"
+#include "SpuMethods.h"
+#include "processor.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+
+#include <sys/mman.h>
+
+/// @brief Enum with runtime errors of the JIT code (every error has one shared stub)
+enum JitError {
+    JIT_ERROR_DIVISION       = 0,
+    JIT_ERROR_SQRT           = 1,
+    JIT_ERROR_ZERO_DIVISION  = 2,
+    JIT_ERROR_STACK_OVERFLOW = 3,
+    JIT_ERROR_STACK_EMPTY    = 4,
+    JIT_ERROR_CALL_OVERFLOW  = 5,
+    JIT_ERROR_RAM            = 6,
+    JIT_ERROR_CALL_EMPTY     = 7,
+    JIT_ERROR_UNKNOWN        = 8,
+    JIT_ERRORS_COUNT         = 9,
+};
+
+/// @brief Structure with the place of rel32 that waits for its target
+struct JitFixup {
+    size_t  position; ///< offset of the rel32 in the buffer
+    int       target; ///< SPU address or JitError
+    int     is_error;
+};
+
+/// @brief Structure with the state of the translation
+struct JitCompiler {
+    unsigned char*        code;
+    size_t                size;
+    size_t            capacity;
+    int           memory_error; ///< set by the emitters, checked once at the end
+    long*              offsets; ///< native offset of every SPU address (-1 inside of the commands)
+    JitFixup*           fixups;
+    size_t        fixups_count;
+    size_t     fixups_capacity;
+    const int*            cmds;
+    size_t           code_size;
+    const SPU*             spu;
+    size_t         exit_offset;
+};
+
+/// @brief Emits the bytes listed in the arguments
+#define EMIT(jc, ...) { static const unsigned char bytes_[] = {__VA_ARGS__}; EmitBytes(jc, bytes_, sizeof(bytes_)); }
+
+//* ================================== helpers called from the native code =================================
+
+static void JitReportError(int error, int ip, int command, SPU* spu) {
+    FILE* stream = SpuMessageStream(spu);
+
+    switch (error) {
+        case JIT_ERROR_DIVISION:       fprintf(stream, RED("ERROR! DIVISION BY ZERO!!!\n")); break;
+        case JIT_ERROR_SQRT:           fprintf(stream, RED("SQRT ERROR!\n"));                break;
+        case JIT_ERROR_ZERO_DIVISION:  fprintf(stream, RED("ZERO DIVISION!\n"));             break;
+        case JIT_ERROR_STACK_OVERFLOW: fprintf(stream, RED("SPU STACK OVERFLOW!\n"));        break;
+        case JIT_ERROR_STACK_EMPTY:    fprintf(stream, RED("SPU STACK IS EMPTY!\n"));        break;
+        case JIT_ERROR_CALL_OVERFLOW:  fprintf(stream, RED("SPU CALL STACK OVERFLOW!\n"));   break;
+        case JIT_ERROR_RAM:            fprintf(stream, RED("RAM ACCESS ERROR!\n"));          break;
+        case JIT_ERROR_CALL_EMPTY:     fprintf(stream, RED("SPU CALL STACK IS EMPTY!\n"));   break;
+        case JIT_ERROR_UNKNOWN: {
+            fprintf(stream, "%d %d ", ip, command);
+            fprintf(stream, RED("UNKNOWN CODE!!!\n"));
+            break;
+        }
+        default: break;
+    }
+}
+
+//* ================================== code buffer =================================
+
+static void EmitBytes(JitCompiler* jc, const unsigned char* bytes, size_t count) {
+    ASSERT(jc    != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(bytes != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (jc->memory_error) return;
+
+    if (jc->size + count > jc->capacity) {
+        size_t new_capacity = jc->capacity ? jc->capacity * 2 : 4096;
+        while (new_capacity < jc->size + count) new_capacity *= 2;
+
+        unsigned char* new_code = (unsigned char*) realloc(jc->code, new_capacity);
+        if (!new_code) {
+            jc->memory_error = 1;
+            return;
+        }
+
+        jc->code     = new_code;
+        jc->capacity = new_capacity;
+    }
+
+    memcpy(jc->code + jc->size, bytes, count);
+    jc->size += count;
+}
+
+static void EmitByte(JitCompiler* jc, unsigned char byte) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EmitBytes(jc, &byte, 1);
+}
+
+static void EmitInt32(JitCompiler* jc, int value) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    unsigned int bits = (unsigned int) value;
+    for (size_t i = 0; i < sizeof(int); i++) EmitByte(jc, (unsigned char) (bits >> (8 * i)));
+}
+
+static void EmitInt64(JitCompiler* jc, uint64_t value) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < sizeof(uint64_t); i++) EmitByte(jc, (unsigned char) (value >> (8 * i)));
+}
+
+static void AddFixup(JitCompiler* jc, int target, int is_error) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (jc->memory_error) return;
+
+    if (jc->fixups_count >= jc->fixups_capacity) {
+        size_t new_capacity = jc->fixups_capacity ? jc->fixups_capacity * 2 : 256;
+
+        JitFixup* new_fixups = (JitFixup*) realloc(jc->fixups, new_capacity * sizeof(JitFixup));
+        if (!new_fixups) {
+            jc->memory_error = 1;
+            return;
+        }
+
+        jc->fixups          = new_fixups;
+        jc->fixups_capacity = new_capacity;
+    }
+
+    jc->fixups[jc->fixups_count++] = {jc->size, target, is_error};
+    EmitInt32(jc, 0);
+}
+
+static void PatchRel32(JitCompiler* jc, size_t position, size_t target) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int rel = (int) ((long) target - (long) (position + sizeof(int)));
+    memcpy(jc->code + position, &rel, sizeof(int));
+}
+
+//* ================================== instructions =================================
+
+/// @brief Jump to the shared stub of the error
+static void EmitErrorJump(JitCompiler* jc, unsigned char condition, JitError error) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EmitByte(jc, 0x0F);
+    EmitByte(jc, condition);
+    AddFixup(jc, error, 1);
+}
+
+/// @brief Condition codes of the second byte of jcc rel32
+static const unsigned char JCC_JB  = 0x82;
+static const unsigned char JCC_JAE = 0x83;
+static const unsigned char JCC_JE  = 0x84;
+static const unsigned char JCC_JNE = 0x85;
+static const unsigned char JCC_JS  = 0x88;
+static const unsigned char JCC_JGE = 0x8D;
+static const unsigned char JCC_JG  = 0x8F;
+
+static void EmitCallHelper(JitCompiler* jc, uint64_t address) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EMIT(jc, 0x48, 0x89, 0xE5,                  // mov rbp, rsp
+             0x48, 0x83, 0xE4, 0xF0,            // and rsp, -16
+             0x48, 0xB8)                        // mov rax, imm64
+    EmitInt64(jc, address);
+    EMIT(jc, 0xFF, 0xD0,                        // call rax
+             0x48, 0x89, 0xEC)                  // mov rsp, rbp
+}
+
+/// @brief Checks that the data stack has at least count (1 or 2) elements
+static void EmitCheckDepth(JitCompiler* jc, int count) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (count == 1) {
+        EMIT(jc, 0x4D, 0x85, 0xED)              // test r13, r13
+        EmitErrorJump(jc, JCC_JE, JIT_ERROR_STACK_EMPTY);
+    } else {
+        EMIT(jc, 0x49, 0x83, 0xFD, 0x02)        // cmp r13, 2
+        EmitErrorJump(jc, JCC_JB, JIT_ERROR_STACK_EMPTY);
+    }
+}
+
+static void EmitPushEax(JitCompiler* jc) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EMIT(jc, 0x49, 0x81, 0xFD)                  // cmp r13, JIT_STACK_SIZE
+    EmitInt32(jc, (int) JIT_STACK_SIZE);
+    EmitErrorJump(jc, JCC_JAE, JIT_ERROR_STACK_OVERFLOW);
+    EMIT(jc, 0x43, 0x89, 0x04, 0xAE,            // mov [r14 + r13 * 4], eax
+             0x49, 0xFF, 0xC5)                  // inc r13
+}
+
+static void EmitPopEax(JitCompiler* jc) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EmitCheckDepth(jc, 1);
+    EMIT(jc, 0x49, 0xFF, 0xCD,                  // dec r13
+             0x43, 0x8B, 0x04, 0xAE)            // mov eax, [r14 + r13 * 4]
+}
+
+/// @brief eax *= CALC_ACCURACY
+static void EmitScale(JitCompiler* jc) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EMIT(jc, 0x69, 0xC0)                        // imul eax, eax, imm32
+    EmitInt32(jc, CALC_ACCURACY);
+}
+
+/// @brief eax /= CALC_ACCURACY (rounding to zero as the C division), edx and esi are clobbered
+static void EmitUnscale(JitCompiler* jc) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (CALC_ACCURACY == 2) {
+        EMIT(jc, 0x89, 0xC2,                    // mov edx, eax
+                 0xC1, 0xEA, 0x1F,              // shr edx, 31
+                 0x01, 0xD0,                    // add eax, edx
+                 0xD1, 0xF8)                    // sar eax, 1
+    } else {
+        EMIT(jc, 0xBE)                          // mov esi, imm32
+        EmitInt32(jc, CALC_ACCURACY);
+        EMIT(jc, 0x99,                          // cdq
+                 0xF7, 0xFE)                    // idiv esi
+    }
+}
+
+/// @brief ecx = top, eax = second
+static void EmitLoadPair(JitCompiler* jc) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EmitCheckDepth(jc, 2);
+    EMIT(jc, 0x43, 0x8B, 0x4C, 0xAE, 0xFC,      // mov ecx, [r14 + r13 * 4 - 4]
+             0x43, 0x8B, 0x44, 0xAE, 0xF8)      // mov eax, [r14 + r13 * 4 - 8]
+}
+
+/// @brief Replaces the pair with eax
+static void EmitStorePair(JitCompiler* jc) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EMIT(jc, 0x49, 0xFF, 0xCD,                  // dec r13
+             0x43, 0x89, 0x44, 0xAE, 0xFC)      // mov [r14 + r13 * 4 - 4], eax
+}
+
+static void EmitLoadTop(JitCompiler* jc) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EmitCheckDepth(jc, 1);
+    EMIT(jc, 0x43, 0x8B, 0x44, 0xAE, 0xFC)      // mov eax, [r14 + r13 * 4 - 4]
+}
+
+static void EmitStoreTop(JitCompiler* jc) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EMIT(jc, 0x43, 0x89, 0x44, 0xAE, 0xFC)      // mov [r14 + r13 * 4 - 4], eax
+}
+
+static void EmitJumpTo(JitCompiler* jc, unsigned char condition, int target) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EmitByte(jc, 0x0F);
+    EmitByte(jc, condition);
+    AddFixup(jc, target, 0);
+}
+
+/*!
+    @brief Function that emits the operand of PUSH or POP the same way as GetArg: regs[XX] gets the sum with the constant
+    \param [in]         jc - pointer on the compiler
+    \param [in]         ip - address of the command
+    \param [in]     is_pop - 1 for POP (eax is stored), 0 for PUSH (eax is loaded)
+    @return The length of the command in words (0 if the operand is not supported)
+*/
+static int EmitOperand(JitCompiler* jc, size_t ip, int is_pop) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (ip + 1 >= jc->code_size) return 0;
+
+    int arg_type = jc->cmds[ip + 1];
+    if (arg_type <= 0 || arg_type > (REG_BIT | CONSTANT_BIT | MEMORY_BIT) || arg_type == MEMORY_BIT) return 0;
+
+    size_t length = 2;
+    unsigned char reg_disp = 0;
+    int constant = 0;
+
+    if (arg_type & REG_BIT) {
+        if (ip + length >= jc->code_size) return 0;
+
+        int reg = jc->cmds[ip + length++];
+        if (reg < 0 || reg >= (int) REGS_SIZE) return 0;
+        reg_disp = (unsigned char) (reg * (int) sizeof(int));
+    }
+
+    if (arg_type & CONSTANT_BIT) {
+        if (ip + length >= jc->code_size) return 0;
+
+        constant = jc->cmds[ip + length++];
+    }
+
+    const unsigned char xx_disp = (unsigned char) (XX * (int) sizeof(int));
+
+    if (!(arg_type & MEMORY_BIT)) {
+        if (is_pop) {
+            unsigned char disp = (arg_type & CONSTANT_BIT) ? xx_disp : reg_disp;
+            EMIT(jc, 0x89, 0x43) EmitByte(jc, disp);                           // mov [rbx + disp], eax
+        } else if (arg_type == REG_BIT) {
+            EMIT(jc, 0x8B, 0x43) EmitByte(jc, reg_disp);                       // mov eax, [rbx + disp]
+        } else if (arg_type == CONSTANT_BIT) {
+            EMIT(jc, 0xB8)                                                     // mov eax, imm32
+            EmitInt32(jc, constant);
+            EMIT(jc, 0x89, 0x43) EmitByte(jc, xx_disp);                        // mov [rbx + XX], eax
+        } else {
+            EMIT(jc, 0x8B, 0x43) EmitByte(jc, reg_disp);                       // mov eax, [rbx + disp]
+            EMIT(jc, 0x05)                                                     // add eax, imm32
+            EmitInt32(jc, constant);
+            EMIT(jc, 0x89, 0x43) EmitByte(jc, xx_disp);                        // mov [rbx + XX], eax
+        }
+
+        return (int) length;
+    }
+
+    if (arg_type & REG_BIT) {
+        EMIT(jc, 0x8B, 0x53) EmitByte(jc, reg_disp);                           // mov edx, [rbx + disp]
+
+        if (arg_type & CONSTANT_BIT) {
+            EMIT(jc, 0x81, 0xC2)                                               // add edx, imm32
+            EmitInt32(jc, constant);
+        }
+    } else {
+        EMIT(jc, 0xBA)                                                         // mov edx, imm32
+        EmitInt32(jc, constant);
+    }
+
+    if (arg_type & CONSTANT_BIT) {
+        EMIT(jc, 0x89, 0x53) EmitByte(jc, xx_disp);                            // mov [rbx + XX], edx
+    }
+
+    //* the constant address is checked here, the computed one at run time (if SPU_UNCHECKED_RAM does not drop it)
+    int is_checked = (arg_type & REG_BIT) || (size_t) constant >= jc->spu->ram_size;
+#ifdef SPU_UNCHECKED_RAM
+    is_checked = !(arg_type & REG_BIT) && is_checked;
+#endif
+    if (is_checked) {
+        EMIT(jc, 0x81, 0xFA)                                                   // cmp edx, ram_size
+        EmitInt32(jc, (int) jc->spu->ram_size);
+        EmitErrorJump(jc, JCC_JAE, JIT_ERROR_RAM);
+    }
+
+    if (is_pop) {
+        EMIT(jc, 0x41, 0x89, 0x04, 0x94)                                       // mov [r12 + rdx * 4], eax
+    } else {
+        EMIT(jc, 0x41, 0x8B, 0x04, 0x94)                                       // mov eax, [r12 + rdx * 4]
+    }
+
+    return (int) length;
+}
+
+/// @brief JE, JNE, JGE keep the pair on the stack, JEP, JNEP, JGEP (is_pop) drop it
+static void EmitCompareJump(JitCompiler* jc, unsigned char condition, int target, int is_pop) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EmitCheckDepth(jc, 2);
+    EMIT(jc, 0x43, 0x8B, 0x44, 0xAE, 0xFC,      // mov eax, [r14 + r13 * 4 - 4]
+             0x43, 0x3B, 0x44, 0xAE, 0xF8)      // cmp eax, [r14 + r13 * 4 - 8]
+    if (is_pop) {
+        EMIT(jc, 0x4D, 0x8D, 0x6D, 0xFE)        // lea r13, [r13 - 2] (flags are kept)
+    }
+    EmitJumpTo(jc, condition, target);
+}
+
+static void EmitSignJump(JitCompiler* jc, unsigned char condition, int target) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EmitCheckDepth(jc, 1);
+    EMIT(jc, 0x43, 0x83, 0x7C, 0xAE, 0xFC, 0x00) // cmp dword [r14 + r13 * 4 - 4], 0
+    EmitJumpTo(jc, condition, target);
+}
+
+static void EmitUnknown(JitCompiler* jc, int ip, int command) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EMIT(jc, 0xBF)                              // mov edi, imm32
+    EmitInt32(jc, JIT_ERROR_UNKNOWN);
+    EMIT(jc, 0xBE)                              // mov esi, imm32
+    EmitInt32(jc, ip);
+    EMIT(jc, 0xBA)                              // mov edx, imm32
+    EmitInt32(jc, command);
+    EMIT(jc, 0x48, 0xB9)                        // mov rcx, spu
+    EmitInt64(jc, (uint64_t) jc->spu);
+    EmitCallHelper(jc, (uint64_t) JitReportError);
+    EMIT(jc, 0xB8, 0x01, 0x00, 0x00, 0x00,      // mov eax, 1
+             0xE9)                              // jmp exit
+    EmitInt32(jc, 0);
+    PatchRel32(jc, jc->size - sizeof(int), jc->exit_offset);
+}
+
+/*!
+    @brief Function that translates one SPU command
+    \param [in] jc - pointer on the compiler
+    \param [in] ip - address of the command
+    @return The length of the command in words (0 if it can not be translated)
+*/
+static int EmitCommand(JitCompiler* jc, size_t ip) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int command = jc->cmds[ip];
+    int target  = (ip + 1 < jc->code_size) ? jc->cmds[ip + 1] : -1;
+
+    switch (command) {
+        case PUSH: {
+            int length = EmitOperand(jc, ip, 0);
+            EmitScale(jc);
+            EmitPushEax(jc);
+            return length;
+        }
+
+        case POP: {
+            EmitPopEax(jc);
+            EmitUnscale(jc);
+            return EmitOperand(jc, ip, 1);
+        }
+
+        case ADD: {
+            EmitLoadPair(jc);
+            EMIT(jc, 0x01, 0xC8)                // add eax, ecx
+            EmitStorePair(jc);
+            return 1;
+        }
+
+        case SUB: {
+            EmitLoadPair(jc);
+            EMIT(jc, 0x29, 0xC8)                // sub eax, ecx
+            EmitStorePair(jc);
+            return 1;
+        }
+
+        case MUL: {
+            EmitLoadPair(jc);
+            EMIT(jc, 0x0F, 0xAF, 0xC1)          // imul eax, ecx
+            EmitUnscale(jc);
+            EmitStorePair(jc);
+            return 1;
+        }
+
+        case DIV: {
+            EmitLoadPair(jc);
+            EMIT(jc, 0x85, 0xC9)                // test ecx, ecx
+            EmitErrorJump(jc, JCC_JE, JIT_ERROR_DIVISION);
+            EmitScale(jc);
+            EMIT(jc, 0x99,                      // cdq
+                     0xF7, 0xF9)                // idiv ecx
+            EmitStorePair(jc);
+            return 1;
+        }
+
+        case MOD:
+        case IDIV: {
+            EmitCheckDepth(jc, 2);
+            EMIT(jc, 0x43, 0x8B, 0x44, 0xAE, 0xFC) // mov eax, [r14 + r13 * 4 - 4]
+            EmitUnscale(jc);
+            EMIT(jc, 0x89, 0xC1,                   // mov ecx, eax
+                     0x43, 0x8B, 0x44, 0xAE, 0xF8) // mov eax, [r14 + r13 * 4 - 8]
+            EmitUnscale(jc);
+            EMIT(jc, 0x85, 0xC9)                   // test ecx, ecx
+            EmitErrorJump(jc, JCC_JE, JIT_ERROR_ZERO_DIVISION);
+            EMIT(jc, 0x99,                         // cdq
+                     0xF7, 0xF9)                   // idiv ecx
+            if (command == MOD) EMIT(jc, 0x89, 0xD0) // mov eax, edx
+            EmitScale(jc);
+            EmitStorePair(jc);
+            return 1;
+        }
+
+        case SQR: {
+            EmitLoadTop(jc);
+            EmitUnscale(jc);
+            EMIT(jc, 0x0F, 0xAF, 0xC0)          // imul eax, eax
+            EmitScale(jc);
+            EmitStoreTop(jc);
+            return 1;
+        }
+
+        case SQRT: {
+            EmitLoadTop(jc);
+            EmitUnscale(jc);
+            EMIT(jc, 0x85, 0xC0)                // test eax, eax
+            EmitErrorJump(jc, JCC_JS, JIT_ERROR_SQRT);
+            EMIT(jc, 0xF2, 0x0F, 0x2A, 0xC0,    // cvtsi2sd xmm0, eax
+                     0xF2, 0x0F, 0x51, 0xC0,    // sqrtsd xmm0, xmm0
+                     0xF2, 0x0F, 0x2C, 0xC0)    // cvttsd2si eax, xmm0
+            EmitScale(jc);
+            EmitStoreTop(jc);
+            return 1;
+        }
+
+        case IN: {
+            EMIT(jc, 0x48, 0xBF)                // mov rdi, spu
+            EmitInt64(jc, (uint64_t) jc->spu);
+            EmitCallHelper(jc, (uint64_t) SpuIn);
+            EmitScale(jc);
+            EmitPushEax(jc);
+            return 1;
+        }
+
+        case OUT: {
+            EmitPopEax(jc);
+            EMIT(jc, 0x89, 0xC6,                // mov esi, eax
+                     0x48, 0xBF)                // mov rdi, spu
+            EmitInt64(jc, (uint64_t) jc->spu);
+            EmitCallHelper(jc, (uint64_t) SpuOut);
+            return 1;
+        }
+
+        case DRAW: {
+            EMIT(jc, 0x48, 0xBF)                // mov rdi, spu
+            EmitInt64(jc, (uint64_t) jc->spu);
+            EmitCallHelper(jc, (uint64_t) SpuDraw);
+            return 1;
+        }
+
+        case HLT: {
+            EMIT(jc, 0x31, 0xC0,                // xor eax, eax
+                     0xE9)                      // jmp exit
+            EmitInt32(jc, 0);
+            PatchRel32(jc, jc->size - sizeof(int), jc->exit_offset);
+            return 1;
+        }
+
+        case JMP: {
+            if (target < 0) return 0;
+            EMIT(jc, 0xE9)                      // jmp rel32
+            AddFixup(jc, target, 0);
+            return 2;
+        }
+
+        case CALL: {
+            if (target < 0) return 0;
+            EMIT(jc, 0x49, 0xFF, 0xCF)          // dec r15
+            EmitErrorJump(jc, JCC_JE, JIT_ERROR_CALL_OVERFLOW);
+            EMIT(jc, 0xE8)                      // call rel32
+            AddFixup(jc, target, 0);
+            return 2;
+        }
+
+        case RET: {
+            //* r15 is JIT_CALL_DEPTH outside of the calls: RET without CALL must not return through the entry
+            EMIT(jc, 0x49, 0x81, 0xFF)          // cmp r15, JIT_CALL_DEPTH
+            EmitInt32(jc, JIT_CALL_DEPTH);
+            EmitErrorJump(jc, JCC_JAE, JIT_ERROR_CALL_EMPTY);
+            EMIT(jc, 0x49, 0xFF, 0xC7,          // inc r15
+                     0xC3)                      // ret
+            return 1;
+        }
+
+        case JE:   if (target < 0) return 0; EmitCompareJump(jc, JCC_JE,  target, 0); return 2;
+        case JNE:  if (target < 0) return 0; EmitCompareJump(jc, JCC_JNE, target, 0); return 2;
+        case JGE:  if (target < 0) return 0; EmitCompareJump(jc, JCC_JGE, target, 0); return 2;
+        case JEP:  if (target < 0) return 0; EmitCompareJump(jc, JCC_JE,  target, 1); return 2;
+        case JNEP: if (target < 0) return 0; EmitCompareJump(jc, JCC_JNE, target, 1); return 2;
+        case JGEP: if (target < 0) return 0; EmitCompareJump(jc, JCC_JGE, target, 1); return 2;
+        case JLZ:  if (target < 0) return 0; EmitSignJump(jc,    JCC_JS,  target);    return 2;
+        case JGZ:  if (target < 0) return 0; EmitSignJump(jc,    JCC_JG,  target);    return 2;
+
+        default: {
+            EmitUnknown(jc, (int) ip, command);
+            return 1;
+        }
+    }
+}
+
+/// @brief Entry: saves the callee-saved registers, loads the base registers and calls the address spu->ip
+static void EmitEntry(JitCompiler* jc, SPU* spu, JitCode* jit) {
+    ASSERT(jc  != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(spu != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(jit != NULL, "NULL POINTER WAS PASSED!\n");
+
+    EMIT(jc, 0x53,                              // push rbx
+             0x55,                              // push rbp
+             0x41, 0x54,                        // push r12
+             0x41, 0x55,                        // push r13
+             0x41, 0x56,                        // push r14
+             0x41, 0x57,                        // push r15
+             0x48, 0xBB)                        // mov rbx, regs
+    EmitInt64(jc, (uint64_t) spu->regs);
+    EMIT(jc, 0x49, 0xBC)                        // mov r12, ram
+    EmitInt64(jc, (uint64_t) spu->ram);
+    EMIT(jc, 0x49, 0xBE)                        // mov r14, stack
+    EmitInt64(jc, (uint64_t) jit->stack);
+    EMIT(jc, 0x45, 0x31, 0xED,                  // xor r13d, r13d
+             0x41, 0xBF)                        // mov r15d, imm32
+    EmitInt32(jc, JIT_CALL_DEPTH);
+    EMIT(jc, 0x48, 0xB9)                        // mov rcx, &saved_rsp
+    EmitInt64(jc, (uint64_t) &jit->saved_rsp);
+    EMIT(jc, 0x48, 0x89, 0x21,                  // mov [rcx], rsp
+             0xE8)                              // call spu->ip
+    AddFixup(jc, spu->ip, 0);
+    EMIT(jc, 0x31, 0xC0)                        // xor eax, eax
+
+    jc->exit_offset = jc->size;
+
+    EMIT(jc, 0x48, 0xB9)                        // mov rcx, &saved_rsp
+    EmitInt64(jc, (uint64_t) &jit->saved_rsp);
+    EMIT(jc, 0x48, 0x8B, 0x21,                  // mov rsp, [rcx]
+             0x41, 0x5F,                        // pop r15
+             0x41, 0x5E,                        // pop r14
+             0x41, 0x5D,                        // pop r13
+             0x41, 0x5C,                        // pop r12
+             0x5D,                              // pop rbp
+             0x5B,                              // pop rbx
+             0xC3)                              // ret
+}
+
+/// @brief Shared error stubs, their offsets are written to error_offsets
+static void EmitErrorStubs(JitCompiler* jc, size_t* error_offsets) {
+    ASSERT(jc            != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(error_offsets != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (int error = 0; error < JIT_ERRORS_COUNT; error++) {
+        error_offsets[error] = jc->size;
+
+        EMIT(jc, 0xBF)                          // mov edi, imm32
+        EmitInt32(jc, error);
+        EMIT(jc, 0x31, 0xF6,                    // xor esi, esi
+                 0x31, 0xD2,                    // xor edx, edx
+                 0x48, 0xB9)                    // mov rcx, spu
+        EmitInt64(jc, (uint64_t) jc->spu);
+        EmitCallHelper(jc, (uint64_t) JitReportError);
+        EMIT(jc, 0xB8, 0x01, 0x00, 0x00, 0x00,  // mov eax, 1
+                 0xE9)                          // jmp exit
+        EmitInt32(jc, 0);
+        PatchRel32(jc, jc->size - sizeof(int), jc->exit_offset);
+    }
+}
+
+/// @brief Resolves the fixups, returns 0 if some jump target is not a command of the program
+static int ResolveFixups(JitCompiler* jc, const size_t* error_offsets) {
+    ASSERT(jc            != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(error_offsets != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < jc->fixups_count; i++) {
+        JitFixup fixup = jc->fixups[i];
+
+        if (fixup.is_error) {
+            PatchRel32(jc, fixup.position, error_offsets[fixup.target]);
+            continue;
+        }
+
+        if (fixup.target < 0 || (size_t) fixup.target > jc->code_size) return 0;
+
+        long offset = jc->offsets[fixup.target];
+        if (offset < 0) return 0;
+
+        PatchRel32(jc, fixup.position, (size_t) offset);
+    }
+
+    return 1;
+}
+
+static void JitCompilerDtor(JitCompiler* jc) {
+    ASSERT(jc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FREE(jc->code);
+    FREE(jc->offsets);
+    FREE(jc->fixups);
+}
+
+//* ================================== public functions =================================
+
+JitCode* JitCompile(SPU* spu, size_t code_size) {
+    ASSERT(spu != NULL, "NULL POINTER WAS PASSED!\n");
+
+    JitCode* jit = (JitCode*) calloc(1, sizeof(JitCode));
+    if (!jit) return NULL;
+
+    jit->stack = (int*) calloc(JIT_STACK_SIZE, sizeof(int));
+
+    JitCompiler jc = {};
+    jc.cmds      = spu->cmds;
+    jc.code_size = code_size;
+    jc.spu       = spu;
+    jc.offsets   = (long*) calloc(code_size + 1, sizeof(long));
+
+    if (!jit->stack || !jc.offsets) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        JitCompilerDtor(&jc);
+        JitDtor(jit);
+        return NULL;
+    }
+
+    for (size_t ip = 0; ip <= code_size; ip++) jc.offsets[ip] = -1;
+
+    EmitEntry(&jc, spu, jit);
+
+    size_t ip = 0;
+    while (ip < code_size) {
+        jc.offsets[ip] = (long) jc.size;
+
+        int length = EmitCommand(&jc, ip);
+        if (length == 0) {
+            JitCompilerDtor(&jc);
+            JitDtor(jit);
+            return NULL;
+        }
+
+        ip += (size_t) length;
+    }
+
+    // falling out of the program reads the zero words after it
+    jc.offsets[code_size] = (long) jc.size;
+    EmitUnknown(&jc, (int) code_size, 0);
+
+    size_t error_offsets[JIT_ERRORS_COUNT] = {};
+    EmitErrorStubs(&jc, error_offsets);
+
+    if (jc.memory_error || !ResolveFixups(&jc, error_offsets)) {
+        if (jc.memory_error) fprintf(stderr, RED("MEMORY ERROR!\n"));
+        JitCompilerDtor(&jc);
+        JitDtor(jit);
+        return NULL;
+    }
+
+    void* code = mmap(NULL, jc.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        JitCompilerDtor(&jc);
+        JitDtor(jit);
+        return NULL;
+    }
+
+    memcpy(code, jc.code, jc.size);
+    jit->code = (unsigned char*) code;
+    jit->size = jc.size;
+    JitCompilerDtor(&jc);
+
+    if (mprotect(code, jit->size, PROT_READ | PROT_EXEC) != 0) {
+        JitDtor(jit);
+        return NULL;
+    }
+
+    return jit;
+}
+
+JitReturnCode JitRun(JitCode* jit) {
+    ASSERT(jit       != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(jit->code != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int (*entry)() = NULL;
+    memcpy(&entry, &jit->code, sizeof(entry));
+
+    return (entry() == 0) ? JIT_SUCCESS : JIT_RUNTIME_ERROR;
+}
+
+void JitDtor(JitCode* jit) {
+    ASSERT(jit != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (jit->code) munmap(jit->code, jit->size);
+    FREE(jit->stack);
+    FREE(jit);
+}
+
+#else
+
+JitCode* JitCompile(SPU* spu, size_t code_size) {
+    ASSERT(spu != NULL, "NULL POINTER WAS PASSED!\n");
+    (void) code_size;
+
+    return NULL;
+}
+
+JitReturnCode JitRun(JitCode* jit) {
+    ASSERT(jit != NULL, "NULL POINTER WAS PASSED!\n");
+
+    return JIT_RUNTIME_ERROR;
+}
+
+void JitDtor(JitCode* jit) {
+    ASSERT(jit != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FREE(jit->stack);
+    FREE(jit);
+}
+
+#endif
+
+void SpuRun(SPU* spu, int use_jit) {
+    ASSERT(spu != NULL, "NULL POINTER WAS PASSED!\n");
+
+#if defined(SPU_PROFILE) || defined(SPU_TRACE) || defined(SPU_GUARDED_STACK)
+    //* the profile, the trace and the guarded stacks are in the interpreter only
+    use_jit = 0;
+#endif
+
+    JitCode* jit = use_jit ? JitCompile(spu, spu->cmds_size) : NULL;
+    if (jit) {
+        JitRun(jit);
+        JitDtor(jit);
+        if (spu->raw_io) SpuFlushOutput(spu);
+    } else {
+        CPUWork(spu);
+    }
+}
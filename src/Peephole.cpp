@@ -0,0 +1,493 @@
+/*!
+    \file
+    File with the peephole optimizer of the SPU bytecode
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "Peephole.h"
+#include "ReturnCodes.h"
+#include "SpuMethods.h"
+
+/// @brief Structure with the decoded command
+struct PeepInstr {
+    int      opcode;
+    int    arg_type; ///< PUSH and POP only
+    int         reg;
+    int    constant;
+    int      target; ///< index of the target command (jumps and calls)
+    int     address; ///< address in the original code
+    int      length; ///< in words
+    int     is_dead;
+};
+
+/// @brief Structure with the state of the optimizer
+struct PeepState {
+    PeepInstr*   instrs;
+    size_t        count;
+    int*        entries; ///< count of the jumps, calls and symbols to every command (count + 1 for the end)
+    int*       index_of; ///< index of the command at every original address (-1 inside the commands)
+    size_t    code_size;
+};
+
+//* ================================== decoding =================================
+
+static int IsJump(int opcode) {
+    return opcode == JMP || opcode == JNE || opcode == JE  || opcode == JGE  || opcode == JLZ || opcode == JGZ ||
+           opcode == JEP || opcode == JNEP || opcode == JGEP || opcode == CALL;
+}
+
+static int IsSimple(int opcode) {
+    return opcode == ADD || opcode == SUB  || opcode == DIV || opcode == MUL || opcode == IN   || opcode == OUT  ||
+           opcode == HLT || opcode == RET  || opcode == SQRT || opcode == SQR || opcode == MOD || opcode == IDIV ||
+           opcode == DRAW;
+}
+
+/// @brief Decodes the command at the address, returns 0 if it is not known
+static int DecodeInstr(const int* code, size_t size, size_t ip, PeepInstr* instr) {
+    ASSERT(code  != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(instr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    *instr = {};
+    instr->opcode  = code[ip];
+    instr->address = (int) ip;
+    instr->target  = -1;
+
+    if (IsSimple(instr->opcode)) return instr->length = 1;
+
+    if (IsJump(instr->opcode)) {
+        if (ip + 1 >= size) return 0;
+
+        instr->target = code[ip + 1];
+        return instr->length = 2;
+    }
+
+    if (instr->opcode != PUSH && instr->opcode != POP) return 0;
+    if (ip + 1 >= size) return 0;
+
+    instr->arg_type = code[ip + 1];
+    if (instr->arg_type <= 0 || instr->arg_type > (REG_BIT | CONSTANT_BIT | MEMORY_BIT) ||
+        instr->arg_type == MEMORY_BIT) return 0;
+
+    size_t length = 2;
+
+    if (instr->arg_type & REG_BIT) {
+        if (ip + length >= size) return 0;
+
+        instr->reg = code[ip + length++];
+        if (instr->reg < 0 || instr->reg >= (int) REGS_SIZE) return 0;
+    }
+
+    if (instr->arg_type & CONSTANT_BIT) {
+        if (ip + length >= size) return 0;
+
+        instr->constant = code[ip + length++];
+    }
+
+    return instr->length = (int) length;
+}
+
+/// @brief Decodes the whole code, jump targets become indices of the commands
+static PeepholeReturnCode PeepDecode(PeepState* st, const Bytecode* bytecode) {
+    ASSERT(st       != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(bytecode != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t size = bytecode->size;
+
+    st->code_size = size;
+    st->instrs    = (PeepInstr*) calloc(size, sizeof(PeepInstr));
+    st->index_of  = (int*)       calloc(size + 1, sizeof(int));
+    if (!st->instrs || !st->index_of) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return PEEPHOLE_MEMORY_ERROR;
+    }
+
+    for (size_t ip = 0; ip <= size; ip++) st->index_of[ip] = -1;
+
+    size_t ip = 0;
+    while (ip < size) {
+        int length = DecodeInstr(bytecode->code, size, ip, &st->instrs[st->count]);
+        if (length == 0) return PEEPHOLE_SKIPPED;
+
+        st->index_of[ip] = (int) st->count++;
+        ip += (size_t) length;
+    }
+    st->index_of[size] = (int) st->count;
+
+    for (size_t i = 0; i < st->count; i++) {
+        PeepInstr* instr = &st->instrs[i];
+        if (!IsJump(instr->opcode)) continue;
+
+        if (instr->target < 0 || (size_t) instr->target > size || st->index_of[instr->target] == -1)
+            return PEEPHOLE_SKIPPED;
+
+        instr->target = st->index_of[instr->target];
+    }
+
+    st->entries = (int*) calloc(st->count + 1, sizeof(int));
+    if (!st->entries) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return PEEPHOLE_MEMORY_ERROR;
+    }
+
+    st->entries[0]++;
+    for (size_t i = 0; i < st->count; i++) {
+        if (IsJump(st->instrs[i].opcode)) st->entries[st->instrs[i].target]++;
+    }
+
+    for (size_t i = 0; i < bytecode->symbols_count; i++) {
+        int address = bytecode->symbols[i].address;
+        if (address < 0 || (size_t) address > size || st->index_of[address] == -1) return PEEPHOLE_SKIPPED;
+
+        st->entries[st->index_of[address]]++;
+    }
+
+    return PEEPHOLE_SUCCESS;
+}
+
+//* ================================== editing =================================
+
+static size_t NextLive(const PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    index++;
+    while (index < st->count && st->instrs[index].is_dead) index++;
+
+    return index;
+}
+
+/// @brief The command executed after the jump to the index (dead commands fall through)
+static size_t Resolve(const PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    while (index < st->count && st->instrs[index].is_dead) index++;
+
+    return index;
+}
+
+/// @brief Deletes the command, the jumps to it go to the next command
+static void Kill(PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    PeepInstr* instr = &st->instrs[index];
+    if (IsJump(instr->opcode)) st->entries[Resolve(st, (size_t) instr->target)]--;
+
+    instr->is_dead = 1;
+
+    st->entries[Resolve(st, index)] += st->entries[index];
+    st->entries[index] = 0;
+}
+
+static void Retarget(PeepState* st, size_t index, size_t target) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    PeepInstr* instr = &st->instrs[index];
+
+    st->entries[Resolve(st, (size_t) instr->target)]--;
+    st->entries[target]++;
+    instr->target = (int) target;
+}
+
+static int IsLive(const PeepState* st, size_t index, int opcode) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    return index < st->count && st->instrs[index].opcode == opcode;
+}
+
+/// @brief Checks that nothing jumps into the window after its first command
+static int IsStraight(const PeepState* st, size_t index, int length) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (int i = 1; i < length; i++) {
+        index = NextLive(st, index);
+        if (index >= st->count || st->entries[index] != 0) return 0;
+    }
+
+    return 1;
+}
+
+static int IsPopXX(const PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    return IsLive(st, index, POP) && st->instrs[index].arg_type == REG_BIT && st->instrs[index].reg == XX;
+}
+
+static int IsPushConst(const PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    return IsLive(st, index, PUSH) && st->instrs[index].arg_type == CONSTANT_BIT;
+}
+
+//* ================================== rules =================================
+
+/// @brief PUSH x; POP x (x does not use regs[XX] that the operand itself changes)
+static int RulePushPop(PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t next = NextLive(st, index);
+    if (!IsLive(st, index, PUSH) || !IsLive(st, next, POP) || !IsStraight(st, index, 2)) return 0;
+
+    const PeepInstr* push = &st->instrs[index];
+    const PeepInstr* pop  = &st->instrs[next];
+
+    if (push->arg_type != pop->arg_type || push->arg_type == CONSTANT_BIT) return 0;
+    if ((push->arg_type & REG_BIT)      && (push->reg != pop->reg || push->reg == XX)) return 0;
+    if ((push->arg_type & CONSTANT_BIT) && push->constant != pop->constant)            return 0;
+
+    Kill(st, next);
+    Kill(st, index);
+
+    return 1;
+}
+
+/// @brief PUSH c; PUSH d; ADD (SUB, MUL, DIV) -> PUSH e, if the SPU computes it without overflow and e is a number
+static int RuleFold(PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t second    = NextLive(st, index);
+    size_t operation = NextLive(st, second);
+
+    if (!IsPushConst(st, index) || !IsPushConst(st, second) || operation >= st->count ||
+        !IsStraight(st, index, 3)) return 0;
+
+    long a = (long) st->instrs[index ].constant * CALC_ACCURACY;
+    long b = (long) st->instrs[second].constant * CALC_ACCURACY;
+    if (a < INT_MIN || a > INT_MAX || b < INT_MIN || b > INT_MAX) return 0;
+
+    long value = 0;
+
+    switch (st->instrs[operation].opcode) {
+        case ADD: value = a + b; break;
+        case SUB: value = a - b; break;
+
+        case MUL: {
+            value = a * b;
+            if (value < INT_MIN || value > INT_MAX) return 0;
+            value /= CALC_ACCURACY;
+            break;
+        }
+
+        case DIV: {
+            if (b == 0) return 0;
+            value = a * CALC_ACCURACY;
+            if (value < INT_MIN || value > INT_MAX) return 0;
+            value /= b;
+            break;
+        }
+
+        default: return 0;
+    }
+
+    if (value < INT_MIN || value > INT_MAX || value % CALC_ACCURACY != 0) return 0;
+
+    st->instrs[index].constant = (int) (value / CALC_ACCURACY);
+    Kill(st, second);
+    Kill(st, operation);
+
+    return 1;
+}
+
+/// @brief PUSH x; PUSH d; DIV; PUSH d; MUL -> PUSH x, the pushed value is divisible by d if d divides CALC_ACCURACY
+static int RuleScaleRoundTrip(PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t divisor    = NextLive(st, index);
+    size_t divide     = NextLive(st, divisor);
+    size_t multiplier = NextLive(st, divide);
+    size_t multiply   = NextLive(st, multiplier);
+
+    if (!IsLive(st, index, PUSH) || !IsPushConst(st, divisor) || !IsLive(st, divide, DIV) ||
+        !IsPushConst(st, multiplier) || !IsLive(st, multiply, MUL) || !IsStraight(st, index, 5)) return 0;
+
+    int d = st->instrs[divisor].constant;
+    if (d <= 0 || CALC_ACCURACY % d != 0 || st->instrs[multiplier].constant != d) return 0;
+
+    Kill(st, divisor);
+    Kill(st, divide);
+    Kill(st, multiplier);
+    Kill(st, multiply);
+
+    return 1;
+}
+
+/// @brief JE L; POP XX; POP XX ... L: POP XX; POP XX; M: -> JEP M (the same for JNE and JGE)
+static int RuleFuseCompare(PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int fused = 0;
+    switch (st->instrs[index].opcode) {
+        case JE:  fused = JEP;  break;
+        case JNE: fused = JNEP; break;
+        case JGE: fused = JGEP; break;
+        default:  return 0;
+    }
+
+    size_t first_drop  = NextLive(st, index);
+    size_t second_drop = NextLive(st, first_drop);
+    if (!IsPopXX(st, first_drop) || !IsPopXX(st, second_drop) || !IsStraight(st, index, 3)) return 0;
+
+    size_t target = Resolve(st, (size_t) st->instrs[index].target);
+    size_t target_drop = NextLive(st, target);
+    if (!IsPopXX(st, target) || !IsPopXX(st, target_drop) || st->entries[target_drop] != 0) return 0;
+
+    size_t after = NextLive(st, target_drop);
+    if (after >= st->count) return 0;
+
+    Kill(st, first_drop);
+    Kill(st, second_drop);
+
+    st->instrs[index].opcode = fused;
+    Retarget(st, index, after);
+
+    return 1;
+}
+
+/// @brief J L; ... L: JMP M -> J M
+static int RuleThreadJump(PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (!IsJump(st->instrs[index].opcode)) return 0;
+
+    size_t target = Resolve(st, (size_t) st->instrs[index].target);
+    if (!IsLive(st, target, JMP)) return 0;
+
+    size_t next_target = Resolve(st, (size_t) st->instrs[target].target);
+    if (next_target == target || next_target == Resolve(st, (size_t) st->instrs[index].target)) return 0;
+
+    Retarget(st, index, next_target);
+
+    return 1;
+}
+
+/// @brief Jumps to the next command (the comparisons restore the stack, so they are removed too)
+static int RuleJumpToNext(PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int opcode = st->instrs[index].opcode;
+    if (opcode != JMP && opcode != JE && opcode != JNE && opcode != JGE && opcode != JLZ && opcode != JGZ) return 0;
+
+    if (Resolve(st, (size_t) st->instrs[index].target) != NextLive(st, index)) return 0;
+
+    Kill(st, index);
+
+    return 1;
+}
+
+/// @brief Commands after JMP, RET and HLT that nothing jumps to
+static int RuleUnreachable(PeepState* st, size_t index) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int opcode = st->instrs[index].opcode;
+    if (opcode != JMP && opcode != RET && opcode != HLT) return 0;
+
+    int changed = 0;
+
+    size_t next = NextLive(st, index);
+    while (next < st->count && st->entries[next] == 0) {
+        Kill(st, next);
+        next = NextLive(st, next);
+        changed = 1;
+    }
+
+    return changed;
+}
+
+static int PeepPass(PeepState* st) {
+    ASSERT(st != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int changed = 0;
+
+    for (size_t index = Resolve(st, 0); index < st->count; index = NextLive(st, index)) {
+        if (RulePushPop(st, index) || RuleJumpToNext(st, index)) {
+            changed = 1;
+            continue;
+        }
+
+        changed |= RuleFold(st, index);
+        changed |= RuleScaleRoundTrip(st, index);
+        changed |= RuleFuseCompare(st, index);
+        changed |= RuleThreadJump(st, index);
+        changed |= RuleUnreachable(st, index);
+    }
+
+    return changed;
+}
+
+//* ================================== encoding =================================
+
+/// @brief Writes the live commands back, the new addresses of the dead commands are the ones of the next live command
+static PeepholeReturnCode PeepEncode(PeepState* st, Bytecode* bytecode) {
+    ASSERT(st       != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(bytecode != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int* new_address = (int*) calloc(st->count + 1, sizeof(int));
+    if (!new_address) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return PEEPHOLE_MEMORY_ERROR;
+    }
+
+    int address = 0;
+    for (size_t i = 0; i < st->count; i++) {
+        new_address[i] = address;
+        if (!st->instrs[i].is_dead) address += st->instrs[i].length;
+    }
+    new_address[st->count] = address;
+
+    int* code = bytecode->code;
+    size_t size = 0;
+
+    for (size_t i = 0; i < st->count; i++) {
+        const PeepInstr* instr = &st->instrs[i];
+        if (instr->is_dead) continue;
+
+        code[size++] = instr->opcode;
+
+        if (IsJump(instr->opcode)) {
+            code[size++] = new_address[instr->target];
+        } else if (instr->opcode == PUSH || instr->opcode == POP) {
+            code[size++] = instr->arg_type;
+            if (instr->arg_type & REG_BIT)      code[size++] = instr->reg;
+            if (instr->arg_type & CONSTANT_BIT) code[size++] = instr->constant;
+        }
+    }
+    bytecode->size = size;
+
+    for (size_t i = 0; i < bytecode->symbols_count; i++) {
+        SpuExeSymbol* symbol = &bytecode->symbols[i];
+        symbol->address = new_address[st->index_of[symbol->address]];
+    }
+
+    //* the lines are not entries: a line that starts with a dead command starts with the next live one
+    for (size_t i = 0; i < bytecode->lines_count; i++) {
+        SpuExeLine* line = &bytecode->lines[i];
+        if (line->address >= 0 && (size_t) line->address <= st->code_size && st->index_of[line->address] != -1)
+            line->address = new_address[st->index_of[line->address]];
+    }
+
+    FREE(new_address);
+
+    return PEEPHOLE_SUCCESS;
+}
+
+PeepholeReturnCode PeepholeBytecode(Bytecode* bytecode) {
+    ASSERT(bytecode != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (bytecode->size == 0) return PEEPHOLE_SUCCESS;
+
+    PeepState st = {};
+
+    PeepholeReturnCode result = PeepDecode(&st, bytecode);
+    if (result == PEEPHOLE_SUCCESS) {
+        for (int pass = 0; pass < PEEPHOLE_MAX_PASSES && PeepPass(&st); pass++) {}
+
+        result = PeepEncode(&st, bytecode);
+    }
+
+    FREE(st.instrs);
+    FREE(st.entries);
+    FREE(st.index_of);
+
+    return result;
+}
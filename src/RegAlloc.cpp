@@ -0,0 +1,636 @@
+/*!
+    \file
+    File with the linear scan register allocator (Poletto, Sarkar) of IR values onto the SPU registers
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "RegAlloc.h"
+
+/// @brief Constant for the allocation filename
+const char* REGALLOC_FILENAME = "../Language/regalloc.txt";
+
+/// @brief Constant for the weight multiplier of one loop level
+static const int LOOP_WEIGHT = 10;
+
+/// @brief Constant for the deepest loop level that still raises the weight
+static const int MAX_LOOP_DEPTH = 4;
+
+#define DEF_REGISTER_(name) #name,
+
+/// @brief Constant with the register names
+static const char* const REGISTER_NAMES[] = {
+    #include "registrs.h"
+};
+
+#undef DEF_REGISTER_
+
+//* ==================================== bitsets ===================================
+
+static size_t BitsetWords(size_t bits) {
+    return (bits + 63) / 64;
+}
+
+static int BitsetGet(const uint64_t* set, int bit) {
+    return int((set[bit / 64] >> (bit % 64)) & 1);
+}
+
+static void BitsetSet(uint64_t* set, int bit) {
+    set[bit / 64] |= uint64_t(1) << (bit % 64);
+}
+
+//* ==================================== liveness ==================================
+
+/// @brief Structure with the state of the allocation of one function
+struct AllocContext {
+    const IRFunction*   func;
+    RegAllocation*     alloc;
+    size_t             words;      ///< words in one bitset of values
+    uint64_t*           uses;      ///< per block: values read before they are written
+    uint64_t*           defs;      ///< per block: values written
+    uint64_t*        live_in;
+    uint64_t*       live_out;
+    int*         block_start;      ///< position of the first instruction of the block
+    int*           block_end;      ///< position of the last instruction of the block
+    int*         loop_depth;
+};
+
+static uint64_t* BlockSet(const AllocContext* ctx, uint64_t* sets, int block) {
+    return sets + size_t(block) * ctx->words;
+}
+
+static void ComputeLocalSets(AllocContext* ctx) {
+    ASSERT(ctx != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRFunction* func = ctx->func;
+
+    for (size_t i = 0; i < ctx->alloc->order_count; i++) {
+        int block = ctx->alloc->order[i];
+        uint64_t* uses = BlockSet(ctx, ctx->uses, block);
+        uint64_t* defs = BlockSet(ctx, ctx->defs, block);
+        const IRIntArray* instrs = &func->blocks[block].instrs;
+
+        for (size_t j = 0; j < instrs->size; j++) {
+            const IRInstr* instr = &func->instrs[ instrs->data[j] ];
+
+            for (size_t k = 0; k < instr->args.size; k++) {
+                if (!BitsetGet(defs, instr->args.data[k])) BitsetSet(uses, instr->args.data[k]);
+            }
+
+            int def = IRDefinedValue(func, instrs->data[j]);
+            if (def != -1) BitsetSet(defs, def);
+        }
+    }
+}
+
+static void ComputeLiveness(AllocContext* ctx) {
+    ASSERT(ctx != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int changed = 1;
+
+    //* backward dataflow: out = U in(succ), in = uses U (out - defs)
+    while (changed) {
+        changed = 0;
+
+        for (size_t i = ctx->alloc->order_count; i-- > 0;) {
+            int block = ctx->alloc->order[i];
+            uint64_t* live_in  = BlockSet(ctx, ctx->live_in,  block);
+            uint64_t* live_out = BlockSet(ctx, ctx->live_out, block);
+            const uint64_t* uses = BlockSet(ctx, ctx->uses, block);
+            const uint64_t* defs = BlockSet(ctx, ctx->defs, block);
+
+            int succs[2] = {};
+            int succs_count = IRBlockSuccs(ctx->func, block, succs);
+
+            for (int j = 0; j < succs_count; j++) {
+                const uint64_t* succ_in = BlockSet(ctx, ctx->live_in, succs[j]);
+                for (size_t k = 0; k < ctx->words; k++) live_out[k] |= succ_in[k];
+            }
+
+            for (size_t k = 0; k < ctx->words; k++) {
+                uint64_t new_in = uses[k] | (live_out[k] & ~defs[k]);
+
+                if (new_in != live_in[k]) {
+                    live_in[k] = new_in;
+                    changed = 1;
+                }
+            }
+        }
+    }
+}
+
+/// @brief Finds the loop depth of every block by the natural loops of the back edges
+static RegAllocReturnCode ComputeLoopDepth(AllocContext* ctx) {
+    ASSERT(ctx != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRFunction* func = ctx->func;
+    size_t count = func->blocks_count;
+
+    int* idom     = (int*) calloc(count, sizeof(int));
+    int* in_loop  = (int*) calloc(count, sizeof(int));
+    int* worklist = (int*) calloc(count, sizeof(int));
+    if (!idom || !in_loop || !worklist) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(idom); FREE(in_loop); FREE(worklist);
+        return REGALLOC_MEMORY_ERROR;
+    }
+
+    IRComputeDominators(func, idom);
+
+    for (size_t header = 0; header < count; header++) {
+        if (idom[header] == -1) continue;
+
+        memset(in_loop, 0, count * sizeof(int));
+        size_t worklist_size = 0;
+        int is_header = 0;
+
+        const IRIntArray* preds = &func->blocks[header].preds;
+        for (size_t i = 0; i < preds->size; i++) {
+            int latch = preds->data[i];
+            if (idom[latch] == -1) continue;
+
+            int dominator = latch;
+            while (dominator != int(header) && dominator != 0) dominator = idom[dominator];
+            if (dominator != int(header)) continue;
+
+            //* back edge latch -> header, the loop body is everything reaching the latch inside the header
+            is_header = 1;
+            if (!in_loop[latch] && latch != int(header)) {
+                in_loop[latch] = 1;
+                worklist[worklist_size++] = latch;
+            }
+        }
+
+        if (!is_header) continue;
+
+        in_loop[header] = 1;
+        while (worklist_size > 0) {
+            int block = worklist[--worklist_size];
+            const IRIntArray* block_preds = &func->blocks[block].preds;
+
+            for (size_t i = 0; i < block_preds->size; i++) {
+                int pred = block_preds->data[i];
+                if (in_loop[pred] || idom[pred] == -1) continue;
+
+                in_loop[pred] = 1;
+                worklist[worklist_size++] = pred;
+            }
+        }
+
+        for (size_t i = 0; i < count; i++) ctx->loop_depth[i] += in_loop[i];
+    }
+
+    FREE(idom);
+    FREE(in_loop);
+    FREE(worklist);
+
+    return REGALLOC_SUCCESS;
+}
+
+//* =================================== intervals ==================================
+
+static void Extend(RegAllocation* alloc, int value, int position) {
+    ASSERT(alloc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (alloc->starts[value] == -1 || position < alloc->starts[value]) alloc->starts[value] = position;
+    if (position > alloc->ends[value]) alloc->ends[value] = position;
+}
+
+static int Weight(int depth) {
+    int weight = 1;
+    for (int i = 0; i < depth && i < MAX_LOOP_DEPTH; i++) weight *= LOOP_WEIGHT;
+
+    return weight;
+}
+
+static void BuildIntervals(AllocContext* ctx, int* uses_count) {
+    ASSERT(ctx        != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(uses_count != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRFunction* func = ctx->func;
+    RegAllocation*   alloc = ctx->alloc;
+
+    for (size_t i = 0; i < alloc->order_count; i++) {
+        int block  = alloc->order[i];
+        int weight = Weight(ctx->loop_depth[block]);
+        const uint64_t* live_in  = BlockSet(ctx, ctx->live_in,  block);
+        const uint64_t* live_out = BlockSet(ctx, ctx->live_out, block);
+
+        for (size_t value = 0; value < alloc->values_count; value++) {
+            if (BitsetGet(live_in,  int(value))) Extend(alloc, int(value), ctx->block_start[block]);
+            if (BitsetGet(live_out, int(value))) Extend(alloc, int(value), ctx->block_end[block]);
+        }
+
+        const IRIntArray* instrs = &func->blocks[block].instrs;
+        for (size_t j = 0; j < instrs->size; j++) {
+            int index = instrs->data[j];
+            int position = alloc->positions[index];
+            const IRInstr* instr = &func->instrs[index];
+
+            for (size_t k = 0; k < instr->args.size; k++) {
+                Extend(alloc, instr->args.data[k], position);
+                alloc->weights[ instr->args.data[k] ] += weight;
+                uses_count[ instr->args.data[k] ]++;
+            }
+
+            int def = IRDefinedValue(func, index);
+            if (def != -1) {
+                Extend(alloc, def, position);
+                alloc->weights[def] += weight;
+            }
+        }
+    }
+}
+
+/// @brief Finds the values that need no register: constants, dropped results and fused comparisons
+static void MarkSpecialValues(AllocContext* ctx, const int* uses_count) {
+    ASSERT(ctx        != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(uses_count != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const IRFunction* func = ctx->func;
+    RegAllocation*   alloc = ctx->alloc;
+
+    for (size_t i = 0; i < alloc->order_count; i++) {
+        const IRIntArray* instrs = &func->blocks[ alloc->order[i] ].instrs;
+
+        for (size_t j = 0; j < instrs->size; j++) {
+            int index = instrs->data[j];
+            const IRInstr* instr = &func->instrs[index];
+
+            if (instr->opcode == IR_CONST) {
+                alloc->locations[index].type = LOCATION_CONST;
+                continue;
+            }
+
+            if (IRIsCompare(instr->opcode) && uses_count[index] == 1 && j + 1 < instrs->size) {
+                const IRInstr* next = &func->instrs[ instrs->data[j + 1] ];
+
+                if (next->opcode == IR_BRANCH && next->args.data[0] == index) {
+                    alloc->locations[index].type = LOCATION_FUSED;
+                }
+            }
+        }
+    }
+
+    for (size_t value = 0; value < alloc->values_count; value++) {
+        if (uses_count[value] == 0 && alloc->locations[value].type == LOCATION_NONE) alloc->starts[value] = -1;
+    }
+}
+
+//* ================================== linear scan =================================
+
+static int FindSlot(int* slot_ends, int* frame_size, int start, int end) {
+    ASSERT(slot_ends  != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(frame_size != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int slot = 0;
+    while (slot < *frame_size && slot_ends[slot] >= start) slot++;
+
+    if (slot == *frame_size) (*frame_size)++;
+    if (slot_ends[slot] < end) slot_ends[slot] = end;
+
+    return slot;
+}
+
+static RegAllocReturnCode LinearScan(RegAllocation* alloc) {
+    ASSERT(alloc != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t count = alloc->values_count;
+
+    int* sorted    = (int*) calloc(count + 1, sizeof(int));
+    int* slot_ends = (int*) calloc(count + 1, sizeof(int));
+    if (!sorted || !slot_ends) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(sorted); FREE(slot_ends);
+        return REGALLOC_MEMORY_ERROR;
+    }
+
+    //* counting sort by the interval start: positions are bounded by 2 * (instructions count + 1)
+    size_t positions_count = 2 * count + 4;
+    int* first = (int*) calloc(positions_count + 1, sizeof(int));
+    if (!first) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(sorted); FREE(slot_ends);
+        return REGALLOC_MEMORY_ERROR;
+    }
+
+    for (size_t value = 0; value < count; value++) {
+        if (alloc->starts[value] != -1 && alloc->locations[value].type == LOCATION_NONE) {
+            first[ alloc->starts[value] + 1 ]++;
+        }
+    }
+    for (size_t position = 1; position <= positions_count; position++) first[position] += first[position - 1];
+
+    size_t sorted_count = 0;
+    for (size_t value = 0; value < count; value++) {
+        if (alloc->starts[value] != -1 && alloc->locations[value].type == LOCATION_NONE) {
+            sorted[ first[ alloc->starts[value] ]++ ] = int(value);
+            sorted_count++;
+        }
+    }
+    FREE(first);
+
+    int active[ALLOC_REGS_COUNT] = {};
+    for (int i = 0; i < ALLOC_REGS_COUNT; i++) active[i] = -1;
+
+    for (size_t i = 0; i < sorted_count; i++) {
+        int value = sorted[i];
+        int start = alloc->starts[value];
+        int free_reg = -1;
+
+        for (int reg = 0; reg < ALLOC_REGS_COUNT; reg++) {
+            if (active[reg] != -1 && alloc->ends[ active[reg] ] < start) active[reg] = -1;
+            if (active[reg] == -1 && free_reg == -1) free_reg = reg;
+        }
+
+        if (free_reg != -1) {
+            active[free_reg] = value;
+            alloc->locations[value] = {LOCATION_REG, free_reg};
+            continue;
+        }
+
+        //* no free register: the coldest of the active values and the new one goes to the frame
+        int victim_reg = 0;
+        for (int reg = 1; reg < ALLOC_REGS_COUNT; reg++) {
+            if (alloc->weights[ active[reg] ] < alloc->weights[ active[victim_reg] ]) victim_reg = reg;
+        }
+
+        int victim = active[victim_reg];
+        if (alloc->weights[victim] < alloc->weights[value]) {
+            active[victim_reg] = value;
+            alloc->locations[value] = {LOCATION_REG, victim_reg};
+        } else {
+            victim = value;
+        }
+
+        int slot = FindSlot(slot_ends, &alloc->frame_size, alloc->starts[victim], alloc->ends[victim]);
+        alloc->locations[victim] = {LOCATION_SLOT, slot};
+    }
+
+    FREE(sorted);
+    FREE(slot_ends);
+
+    return REGALLOC_SUCCESS;
+}
+
+//* ================================== allocation ==================================
+
+void RegAllocationDtor(RegAllocation* alloc) {
+    if (!alloc) return;
+
+    FREE(alloc->locations);
+    FREE(alloc->positions);
+    FREE(alloc->starts);
+    FREE(alloc->ends);
+    FREE(alloc->weights);
+    FREE(alloc->order);
+    FREE(alloc);
+}
+
+static void AllocContextDtor(AllocContext* ctx) {
+    ASSERT(ctx != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FREE(ctx->uses);
+    FREE(ctx->defs);
+    FREE(ctx->live_in);
+    FREE(ctx->live_out);
+    FREE(ctx->block_start);
+    FREE(ctx->block_end);
+    FREE(ctx->loop_depth);
+}
+
+static RegAllocation* RegAllocationCtor(const IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    RegAllocation* alloc = (RegAllocation*) calloc(1, sizeof(RegAllocation));
+    if (!alloc) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return NULL;
+    }
+
+    size_t count = func->instrs_count;
+    alloc->values_count = count;
+    alloc->locations = (Location*) calloc(count + 1, sizeof(Location));
+    alloc->positions = (int*)      calloc(count + 1, sizeof(int));
+    alloc->starts    = (int*)      calloc(count + 1, sizeof(int));
+    alloc->ends      = (int*)      calloc(count + 1, sizeof(int));
+    alloc->weights   = (int*)      calloc(count + 1, sizeof(int));
+    alloc->order     = (int*)      calloc(func->blocks_count + 1, sizeof(int));
+
+    if (!alloc->locations || !alloc->positions || !alloc->starts || !alloc->ends || !alloc->weights ||
+        !alloc->order) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        RegAllocationDtor(alloc);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        alloc->positions[i] = -1;
+        alloc->starts[i]    = -1;
+        alloc->ends[i]      = -1;
+    }
+
+    return alloc;
+}
+
+RegAllocation* RegAllocFunction(const IRFunction* func) {
+    ASSERT(func != NULL, "NULL POINTER WAS PASSED!\n");
+
+    RegAllocation* alloc = RegAllocationCtor(func);
+    if (!alloc) return NULL;
+
+    AllocContext ctx = {};
+    ctx.func  = func;
+    ctx.alloc = alloc;
+    ctx.words = BitsetWords(alloc->values_count);
+
+    size_t sets_size = func->blocks_count * ctx.words + 1;
+    ctx.uses        = (uint64_t*) calloc(sets_size, sizeof(uint64_t));
+    ctx.defs        = (uint64_t*) calloc(sets_size, sizeof(uint64_t));
+    ctx.live_in     = (uint64_t*) calloc(sets_size, sizeof(uint64_t));
+    ctx.live_out    = (uint64_t*) calloc(sets_size, sizeof(uint64_t));
+    ctx.block_start = (int*)      calloc(func->blocks_count + 1, sizeof(int));
+    ctx.block_end   = (int*)      calloc(func->blocks_count + 1, sizeof(int));
+    ctx.loop_depth  = (int*)      calloc(func->blocks_count + 1, sizeof(int));
+
+    int* uses_count = (int*) calloc(alloc->values_count + 1, sizeof(int));
+
+    if (!ctx.uses || !ctx.defs || !ctx.live_in || !ctx.live_out || !ctx.block_start || !ctx.block_end ||
+        !ctx.loop_depth || !uses_count) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        AllocContextDtor(&ctx);
+        FREE(uses_count);
+        RegAllocationDtor(alloc);
+        return NULL;
+    }
+
+    //* blocks are laid out in reverse postorder, so loop bodies stay contiguous
+    alloc->order_count = IRComputeRPO(func, alloc->order);
+
+    int position = 2;
+    for (size_t i = 0; i < alloc->order_count; i++) {
+        int block = alloc->order[i];
+        const IRIntArray* instrs = &func->blocks[block].instrs;
+
+        ctx.block_start[block] = position;
+        for (size_t j = 0; j < instrs->size; j++) {
+            alloc->positions[ instrs->data[j] ] = position;
+            position += 2;
+        }
+        ctx.block_end[block] = position - 2;
+    }
+
+    ComputeLocalSets(&ctx);
+    ComputeLiveness(&ctx);
+
+    RegAllocReturnCode result = ComputeLoopDepth(&ctx);
+    if (result == REGALLOC_SUCCESS) {
+        BuildIntervals(&ctx, uses_count);
+        MarkSpecialValues(&ctx, uses_count);
+        result = LinearScan(alloc);
+    }
+
+    AllocContextDtor(&ctx);
+    FREE(uses_count);
+
+    if (result != REGALLOC_SUCCESS) {
+        RegAllocationDtor(alloc);
+        return NULL;
+    }
+
+    return alloc;
+}
+
+void RegAllocModuleDtor(RegAllocation** allocs, size_t count) {
+    if (!allocs) return;
+
+    for (size_t i = 0; i < count; i++) RegAllocationDtor(allocs[i]);
+    FREE(allocs);
+}
+
+RegAllocation** RegAllocModule(IRModule* module) {
+    ASSERT(module != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (IRLeaveSSA(module) != IR_SUCCESS) return NULL;
+
+    RegAllocation** allocs = (RegAllocation**) calloc(module->functions_count + 1, sizeof(RegAllocation*));
+    if (!allocs) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return NULL;
+    }
+
+    for (size_t i = 0; i < module->functions_count; i++) {
+        allocs[i] = RegAllocFunction(module->functions[i]);
+
+        if (!allocs[i]) {
+            RegAllocModuleDtor(allocs, module->functions_count);
+            return NULL;
+        }
+    }
+
+    return allocs;
+}
+
+int RegAllocLiveAcross(const RegAllocation* alloc, int instr, int* regs) {
+    ASSERT(alloc != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(regs  != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int position = alloc->positions[instr];
+    int count = 0;
+
+    for (size_t value = 0; value < alloc->values_count; value++) {
+        if (alloc->locations[value].type != LOCATION_REG) continue;
+
+        if (alloc->starts[value] < position && position < alloc->ends[value]) {
+            regs[count++] = alloc->locations[value].index;
+        }
+    }
+
+    return count;
+}
+
+//* ===================================== dump =====================================
+
+static void DumpLocation(FILE* filename, Location location) {
+    switch (location.type) {
+        case LOCATION_REG:
+            fprintf(filename, "%s", REGISTER_NAMES[location.index]);
+            break;
+        case LOCATION_SLOT:
+            fprintf(filename, "[IX+%d]", location.index);
+            break;
+        case LOCATION_CONST:
+            fprintf(filename, "const");
+            break;
+        case LOCATION_FUSED:
+            fprintf(filename, "fused");
+            break;
+        case LOCATION_NONE:
+        default:
+            fprintf(filename, "-");
+            break;
+    }
+}
+
+void RegAllocDump(FILE* filename, const IRModule* module, RegAllocation* const* allocs) {
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(module   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(allocs   != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < module->functions_count; i++) {
+        const IRFunction*    func = module->functions[i];
+        const RegAllocation* alloc = allocs[i];
+
+        fprintf(filename, "function %s (frame %d)\n", func->name, alloc->frame_size);
+
+        for (size_t j = 0; j < alloc->order_count; j++) {
+            const IRIntArray* instrs = &func->blocks[ alloc->order[j] ].instrs;
+
+            fprintf(filename, "  bb%d:\n", alloc->order[j]);
+            for (size_t k = 0; k < instrs->size; k++) {
+                int index = instrs->data[k];
+
+                fprintf(filename, "%4d ", alloc->positions[index]);
+                IRDumpInstr(filename, module, func, index);
+
+                int def = IRDefinedValue(func, index);
+                if (def != -1) {
+                    fprintf(filename, "\t-> ");
+                    DumpLocation(filename, alloc->locations[def]);
+                }
+                fputc('\n', filename);
+            }
+        }
+
+        fprintf(filename, "  intervals:\n");
+        for (size_t value = 0; value < alloc->values_count; value++) {
+            if (alloc->starts[value] == -1) continue;
+
+            fprintf(filename, "    %%%lu [%d, %d] weight %d: ", value, alloc->starts[value], alloc->ends[value],
+                              alloc->weights[value]);
+            DumpLocation(filename, alloc->locations[value]);
+            fputc('\n', filename);
+        }
+
+        fputc('\n', filename);
+    }
+}
+
+RegAllocReturnCode WriteRegAlloc(const IRModule* module, RegAllocation* const* allocs) {
+    ASSERT(module != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(allocs != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FILE* regalloc_file = fopen(REGALLOC_FILENAME, "wb");
+    if (!regalloc_file) {
+        fprintf(stderr, RED("Error occured while opening %s!\n"), REGALLOC_FILENAME);
+        return REGALLOC_FILE_ERROR;
+    }
+
+    RegAllocDump(regalloc_file, module, allocs);
+    fclose(regalloc_file);
+
+    return REGALLOC_SUCCESS;
+}
@@ -5,28 +5,141 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "Tools.h"
 #include "ReturnCodes.h"
-#include "StackMethods.h"
 #include "Stack.h"
 #include "Config.h"
 #include "SpuMethods.h"
+#include "SpuProfile.h"
+#include "SpuTrace.h"
+
+//* ================================== memory =================================
+
+static size_t RoundUp(size_t size, size_t page_size) {
+    return (size + page_size - 1) / page_size * page_size;
+}
+
+/// @brief Reserves RAM without committing it: the pages are backed on the first access only
+static int SpuMapRam(SPU* spu, int huge_pages) {
+    ASSERT(spu != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t bytes = spu->ram_size * sizeof(int);
+    void*    ram = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (huge_pages) {
+        spu->ram_mapping_size = RoundUp(bytes, SPU_HUGE_PAGE_SIZE);
+        ram = mmap(NULL, spu->ram_mapping_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_HUGETLB, -1, 0);
+    }
+#endif
+
+    if (ram == MAP_FAILED) {
+        spu->ram_mapping_size = RoundUp(bytes, (size_t) sysconf(_SC_PAGESIZE));
+        ram = mmap(NULL, spu->ram_mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (ram == MAP_FAILED) {
+            spu->ram_mapping_size = 0;
+            return 0;
+        }
+
+#ifdef MADV_HUGEPAGE
+        if (huge_pages) madvise(ram, spu->ram_mapping_size, MADV_HUGEPAGE);
+#endif
+    }
+
+    spu->ram = (int*) ram;
+
+    return 1;
+}
 
 /*!
     @brief Function that initialize and create SPU struct
-    \param [out] spu - the pointer on SPU struct
+    \param [in] config - memory parameters (NULL for the defaults)
+    @return The pointer on SPU struct (NULL if there is no memory or the parameters are wrong)
 */
-SPU* SpuInit() {
+SPU* SpuInit(const SpuConfig* config) {
+    SpuConfig defaults = {};
+    if (!config) config = &defaults;
+
+    size_t ram_size = config->ram_size ? config->ram_size : RAM_SIZE;
+    if (ram_size > SPU_MAX_RAM_SIZE) {
+        fprintf(stderr, RED("RAM of %lu words is too big (maximum is %lu)!\n"), ram_size, SPU_MAX_RAM_SIZE);
+        return NULL;
+    }
+
     SPU* spu = (SPU*)calloc(1, sizeof(SPU));
-    ASSERT(spu != NULL, "MEMORY ERROR!\n");
+    if (!spu) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return NULL;
+    }
+
+    spu->ram_size    = ram_size;
+    spu->draw_width  = config->draw_width  ? config->draw_width  : SPU_DRAW_SIDE;
+    spu->draw_height = config->draw_height ? config->draw_height : SPU_DRAW_SIDE;
+    if (spu->draw_width > ram_size) spu->draw_width = ram_size;
+    if (spu->draw_width * spu->draw_height > ram_size) spu->draw_height = ram_size / spu->draw_width;
+
+    if (!SpuMapRam(spu, config->huge_pages)) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(spu);
+        return NULL;
+    }
+
+#ifdef SPU_CHECKED_STACKS
+    //* the stacks are used by CPUWork with SPU_CHECKED_STACKS only, without it they stay empty and allocate nothing
+    if (STACK_CREATE(spu->st) != STACK_SUCCESS || STACK_CREATE(spu->stFunc) != STACK_SUCCESS) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        SpuDtor(spu);
+        return NULL;
+    }
+#endif
 
-    spu->st = STACK_INIT(spu->st);
-    spu->stFunc = STACK_INIT(spu->stFunc);
+    spu->input  = stdin;
+    spu->output = stdout;
+    spu->raw_io = config->raw_io;
 
     return spu;
 }
 
+/*!
+    @brief Function that makes the SPU ready for the next run: zero registers, RAM and ip, empty stacks
+    \param [out] spu - the pointer on SPU struct
+*/
+void SpuReset(SPU* spu) {
+    ASSERT(spu != NULL, "NULL POINTER!\n");
+
+    spu->ip = 0;
+    for (size_t i = 0; i < REGS_SIZE; i++) spu->regs[i] = 0;
+
+    //* the private pages are dropped, they are zero again on the next access
+    madvise(spu->ram, spu->ram_mapping_size, MADV_DONTNEED);
+
+#ifdef SPU_CHECKED_STACKS
+    StackClean(&spu->st);
+    StackClean(&spu->stFunc);
+#endif
+
+    spu->vm_top       = NULL;
+    spu->vm_tos       = 0;
+    spu->vm_calls_top = NULL;
+
+    spu->in_queue.count     = 0;
+    spu->in_queue.next      = 0;
+    spu->in_queue.is_used   = 0;
+    spu->in_queue.is_closed = 0;
+
+    //* the output of the last run is flushed by its runner, the stream can be closed already
+    spu->out_size    = 0;
+    spu->frame_valid = 0;
+
+    if (spu->trace) spu->trace->head = 0;
+}
+
 /*!
     @brief Function that determinate SPU structer
     \param [out] spu - the pointer on SPU struct
@@ -34,8 +147,307 @@ SPU* SpuInit() {
 void SpuDtor(SPU* spu) {
     ASSERT(spu != NULL, "NULL POINTER!\n");
 
-    StackDtor(spu->st);
-    StackDtor(spu->stFunc);
+    if (spu->out_size) SpuFlushOutput(spu);
+
+    StackDestroy(&spu->st);
+    StackDestroy(&spu->stFunc);
 
+    if (spu->ram) munmap(spu->ram, spu->ram_mapping_size);
+
+    if (!spu->decoded_shared) FREE(spu->decoded);
+#ifndef SPU_CHECKED_STACKS
+    if (spu->vm_stack != spu->vm_inline_stack) FREE(spu->vm_stack);
+    if (spu->vm_calls != spu->vm_inline_calls) FREE(spu->vm_calls);
+#endif
+    FREE(spu->in_queue.values);
+    FREE(spu->out_buffer);
+    FREE(spu->frame_cells);
+    FREE(spu->frame_text);
+    SpuProfileDtor(spu->profile);
+    SpuTraceDtor(spu->trace);
     FREE(spu)
-}
\ No newline at end of file
+}
+
+//* ================================== devices =================================
+
+/*!
+    @brief Function that adds the numbers to the input queue of the SPU (IN reads the queue after it)
+    \param [out]    spu - the pointer on SPU struct
+    \param [in]  values - numbers (not scaled)
+    \param [in]   count - count of the numbers
+    @return 1 if the numbers are added, 0 if there is no memory
+*/
+int SpuQueueInput(SPU* spu, const int* values, size_t count) {
+    ASSERT(spu    != NULL, "NULL POINTER!\n");
+    ASSERT(values != NULL || count == 0, "NULL POINTER!\n");
+
+    SpuInputQueue* queue = &spu->in_queue;
+    queue->is_used = 1;
+
+    //* the read numbers are dropped before the queue grows
+    if (queue->next == queue->count) queue->next = queue->count = 0;
+
+    if (queue->count + count > queue->capacity) {
+        size_t capacity = queue->capacity ? queue->capacity : 16;
+        while (capacity < queue->count + count) capacity *= 2;
+
+        int* values_new = (int*) realloc(queue->values, capacity * sizeof(int));
+        if (!values_new) return 0;
+
+        queue->values   = values_new;
+        queue->capacity = capacity;
+    }
+
+    for (size_t i = 0; i < count; i++) queue->values[queue->count++] = values[i];
+
+    return 1;
+}
+
+/*!
+    @brief Function that checks that IN can run without waiting
+    \param [in] spu - the pointer on SPU struct
+    @return 1 if the input stream is used or the queue has a number or it is closed
+*/
+int SpuInputReady(const SPU* spu) {
+    ASSERT(spu != NULL, "NULL POINTER!\n");
+
+    const SpuInputQueue* queue = &spu->in_queue;
+
+    return !queue->is_used || queue->next < queue->count || queue->is_closed;
+}
+
+/// @brief Reads the whole input stream to the input queue and closes the queue (the raw I/O),
+///        the numbers end at the first word that is not a number like scanf stops there
+static void SpuReadInput(SPU* spu) {
+    ASSERT(spu != NULL, "NULL POINTER!\n");
+
+    size_t capacity = SPU_OUTPUT_BUFFER_SIZE;
+    size_t     size = 0;
+    char*      text = (char*) calloc(capacity + 1, sizeof(char));
+
+    while (text) {
+        size += fread(text + size, sizeof(char), capacity - size, spu->input);
+        if (size < capacity) break;
+
+        char* text_new = (char*) realloc(text, capacity * 2 + 1);
+        if (!text_new) FREE(text);
+        text      = text_new;
+        capacity *= 2;
+    }
+
+    spu->in_queue.is_used = 1;
+
+    if (!text) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+    } else {
+        text[size] = '\0';
+
+        const char* c = text;
+        for (;;) {
+            while (isspace((unsigned char) *c)) c++;
+
+            int is_negative = *c == '-';
+            if (*c == '-' || *c == '+') c++;
+            if (!isdigit((unsigned char) *c)) break;
+
+            long value = 0;
+            while (isdigit((unsigned char) *c)) value = value * 10 + (*c++ - '0');
+
+            int number = (int) (is_negative ? -value : value);
+            if (!SpuQueueInput(spu, &number, 1)) {
+                fprintf(stderr, RED("MEMORY ERROR!\n"));
+                break;
+            }
+        }
+
+        FREE(text);
+    }
+
+    spu->in_queue.is_closed = 1;
+}
+
+/*!
+    @brief Function that reads a number for the IN command (from the input queue if it is used)
+    \param [in] spu - the pointer on SPU struct
+    @return The number (not scaled)
+*/
+int SpuIn(SPU* spu) {
+    ASSERT(spu != NULL, "NULL POINTER!\n");
+
+    SpuInputQueue* queue = &spu->in_queue;
+    if (spu->raw_io && !queue->is_used) SpuReadInput(spu);
+
+    int a = 0;
+    if (!spu->raw_io) fprintf(spu->output, YELLOW("Enter a number: "));
+    spu->frame_valid = 0;
+
+    if (!queue->is_used)                fscanf(spu->input, "%d", &a);
+    else if (queue->next < queue->count) a = queue->values[queue->next++];
+
+    return a;
+}
+
+/// @brief Writes the fixed point value as the decimal number without the exponent, the fraction of
+///        CALC_ACCURACY is printed exactly up to SPU_OUTPUT_FRACTION_DIGITS digits
+/// @return Count of the written chars (at most 24)
+static size_t FormatFixed(char* text, int value) {
+    ASSERT(text != NULL, "NULL POINTER!\n");
+
+    size_t length = 0;
+
+    long long magnitude = value;
+    if (magnitude < 0) {
+        text[length++] = '-';
+        magnitude = -magnitude;
+    }
+
+    long long whole = magnitude / CALC_ACCURACY;
+    long long  rest = magnitude % CALC_ACCURACY;
+
+    char digits[24] = {};
+    size_t digits_count = 0;
+    do {
+        digits[digits_count++] = (char) ('0' + whole % 10);
+        whole /= 10;
+    } while (whole);
+
+    while (digits_count) text[length++] = digits[--digits_count];
+
+    if (rest) {
+        text[length++] = '.';
+        for (int i = 0; i < SPU_OUTPUT_FRACTION_DIGITS && rest; i++) {
+            rest *= 10;
+            text[length++] = (char) ('0' + rest / CALC_ACCURACY);
+            rest %= CALC_ACCURACY;
+        }
+    }
+
+    return length;
+}
+
+/*!
+    @brief Function that prints the value for the OUT command
+    \param [in]   spu - the pointer on SPU struct
+    \param [in] value - fixed point value from the stack
+*/
+void SpuOut(SPU* spu, int value) {
+    ASSERT(spu != NULL, "NULL POINTER!\n");
+
+    //* the printed lines are under the frame now
+    spu->frame_valid = 0;
+
+    if (!spu->raw_io) {
+        fprintf(spu->output, GREEN("RESULT: %lg\n"), (double) value / CALC_ACCURACY);
+        return;
+    }
+
+    if (!spu->out_buffer) {
+        spu->out_buffer = (char*) calloc(SPU_OUTPUT_BUFFER_SIZE, sizeof(char));
+        if (!spu->out_buffer) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return;
+        }
+    }
+
+    //* one number with the sign, the point, the fraction and the new line
+    const size_t number_size = 32;
+    if (SPU_OUTPUT_BUFFER_SIZE - spu->out_size < number_size) SpuFlushOutput(spu);
+
+    spu->out_size += FormatFixed(spu->out_buffer + spu->out_size, value);
+    spu->out_buffer[spu->out_size++] = '\n';
+}
+
+/*!
+    @brief Function that writes the buffered output of the raw I/O to the output stream and flushes it
+    \param [out] spu - the pointer on SPU struct
+*/
+void SpuFlushOutput(SPU* spu) {
+    ASSERT(spu != NULL, "NULL POINTER!\n");
+
+    if (spu->out_size) fwrite(spu->out_buffer, sizeof(char), spu->out_size, spu->output);
+    spu->out_size = 0;
+
+    fflush(spu->output);
+}
+
+/*!
+    @brief Function that gives the output stream for the messages of the processor, the buffered output
+           is written before them to keep the order
+    \param [out] spu - the pointer on SPU struct
+    @return The output stream
+*/
+FILE* SpuMessageStream(SPU* spu) {
+    ASSERT(spu != NULL, "NULL POINTER!\n");
+
+    if (spu->out_size) SpuFlushOutput(spu);
+    spu->frame_valid = 0;
+
+    return spu->output;
+}
+
+/// @brief Appends the text of the cell to the frame
+static size_t FormatCell(char* text, int cell) {
+    ASSERT(text != NULL, "NULL POINTER!\n");
+
+    if (cell != 0) return (size_t) sprintf(text, GREEN("%c "), (char) cell);
+
+    memcpy(text, "· ", sizeof("· ") - 1);
+    return sizeof("· ") - 1;
+}
+
+/*!
+    @brief Function that draws RAM for the DRAW command, the frame is written at once: the whole one first,
+           then only the changed cells if the output is a terminal and nothing was printed after the last frame
+    \param [in] spu - the pointer on SPU struct
+*/
+void SpuDraw(SPU* spu) {
+    ASSERT(spu != NULL, "NULL POINTER!\n");
+
+    if (spu->out_size) SpuFlushOutput(spu);
+
+    size_t  width = spu->draw_width;
+    size_t height = spu->draw_height;
+    size_t  cells = width * height;
+
+    if (!spu->frame_text) {
+        spu->frame_cells = (int*)  calloc(cells + 1, sizeof(int));
+        spu->frame_text  = (char*) calloc(cells * SPU_FRAME_CELL_SIZE + height + SPU_FRAME_CELL_SIZE, sizeof(char));
+        if (!spu->frame_cells || !spu->frame_text) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            FREE(spu->frame_cells);
+            FREE(spu->frame_text);
+            return;
+        }
+    }
+
+    char*  text = spu->frame_text;
+    size_t size = 0;
+
+    if (!spu->frame_valid || !isatty(fileno(spu->output))) {
+        for (size_t i = 0; i < cells; i++) {
+            size += FormatCell(text + size, spu->ram[i]);
+            if ((i + 1) % width == 0) text[size++] = '\n';
+        }
+    } else {
+        //* the cursor is at the line under the frame, it goes to the changed cells (two columns each) and back
+        size_t row = height;
+        for (size_t i = 0; i < cells; i++) {
+            if (spu->ram[i] == spu->frame_cells[i]) continue;
+
+            size_t cell_row = i / width;
+            if (cell_row < row) size += (size_t) sprintf(text + size, "\033[%luF", row - cell_row);
+            if (cell_row > row) size += (size_t) sprintf(text + size, "\033[%luE", cell_row - row);
+            row = cell_row;
+
+            size += (size_t) sprintf(text + size, "\033[%luG", i % width * 2 + 1);
+            size += FormatCell(text + size, spu->ram[i]);
+        }
+
+        if (row != height) size += (size_t) sprintf(text + size, "\033[%luE", height - row);
+    }
+
+    if (size) fwrite(text, sizeof(char), size, spu->output);
+
+    memcpy(spu->frame_cells, spu->ram, cells * sizeof(int));
+    spu->frame_valid = 1;
+}
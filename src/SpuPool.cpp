@@ -0,0 +1,288 @@
+/*!
+    \file
+    File with the pool of SPUs: the shared image, the work-stealing workers and the batch of input files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "SpuPool.h"
+#include "processor.h"
+
+//* ================================== image =================================
+
+SpuPoolReturnCode SpuImageInit(SpuImage* image, const int* cmds, size_t cmds_size, int entry,
+                               const int* data, size_t data_size, const SpuConfig* config) {
+    ASSERT(image != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(cmds  != NULL || cmds_size == 0, "NULL POINTER WAS PASSED!\n");
+    ASSERT(data  != NULL || data_size == 0, "NULL POINTER WAS PASSED!\n");
+
+    *image = {};
+    if (config) image->config = *config;
+    if (!image->config.ram_size) image->config.ram_size = RAM_SIZE;
+
+    if (data_size > image->config.ram_size) {
+        fprintf(stderr, RED("Data does not fit in RAM: %lu words (RAM is %lu)!\n"), data_size, image->config.ram_size);
+        return SPU_POOL_DATA_ERROR;
+    }
+
+    image->cmds      = cmds;
+    image->cmds_size = cmds_size;
+    image->entry     = entry;
+    image->data      = data;
+    image->data_size = data_size;
+
+    //* the decoder only reads the code and the size of RAM, the SPU here has no memory of its own
+    SPU decoder = {};
+    decoder.cmds      = cmds;
+    decoder.cmds_size = cmds_size;
+    decoder.ram_size  = image->config.ram_size;
+
+    if (!SpuDecode(&decoder)) return SPU_POOL_MEMORY_ERROR;
+
+    image->decoded = decoder.decoded;
+
+    return SPU_POOL_SUCCESS;
+}
+
+void SpuImageDtor(SpuImage* image) {
+    ASSERT(image != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FREE(image->decoded);
+    *image = {};
+}
+
+//* ================================== workers =================================
+
+struct SpuPoolState;
+
+/// @brief Structure with the worker: its thread and its range of the jobs
+struct SpuWorker {
+    pthread_t           thread;
+    int             is_started;
+    size_t                next; ///< next job of the range, it is taken atomically (by the owner or by the thieves)
+    size_t                 end;
+    size_t               index;
+    SpuPoolState*         pool;
+};
+
+/// @brief Structure with the state shared by the workers
+struct SpuPoolState {
+    const SpuImage*      image;
+    const SpuJob*         jobs;
+    SpuWorker*         workers;
+    size_t       workers_count;
+    int                  error; ///< the first failure of the workers (SpuPoolReturnCode), it is set atomically
+};
+
+/// @brief Records the failure of the job or of the worker, the first one is returned by the pool
+static void SetPoolError(SpuPoolState* pool, SpuPoolReturnCode error) {
+    ASSERT(pool != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int expected = SPU_POOL_SUCCESS;
+    __atomic_compare_exchange_n(&pool->error, &expected, (int) error, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/// @brief Takes the next job of the own range, then of the ranges of the others
+static int TakeJob(SpuWorker* worker, size_t* job) {
+    ASSERT(worker != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(job    != NULL, "NULL POINTER WAS PASSED!\n");
+
+    SpuPoolState* pool = worker->pool;
+
+    for (size_t i = 0; i < pool->workers_count; i++) {
+        SpuWorker* victim = &pool->workers[(worker->index + i) % pool->workers_count];
+        if (__atomic_load_n(&victim->next, __ATOMIC_RELAXED) >= victim->end) continue;
+
+        size_t taken = __atomic_fetch_add(&victim->next, 1, __ATOMIC_RELAXED);
+        if (taken < victim->end) {
+            *job = taken;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/// @brief Runs the job on the SPU of the worker, the streams opened by names are closed after the run
+static SpuPoolReturnCode RunJob(SPU* spu, const SpuImage* image, const SpuJob* job) {
+    ASSERT(spu   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(image != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(job   != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FILE* input  = job->input;
+    FILE* output = job->output;
+    if (!input  && job->input_name)  input  = fopen(job->input_name,  "r");
+    if (!output && job->output_name) output = fopen(job->output_name, "w");
+
+    SpuPoolReturnCode result = SPU_POOL_SUCCESS;
+
+    if ((!input && job->input_name) || (!output && job->output_name)) {
+        fprintf(stderr, RED("Error occured while opening the streams of the job %s!\n"),
+                job->input_name ? job->input_name : job->output_name);
+        result = SPU_POOL_FILE_ERROR;
+    } else {
+        SpuReset(spu);
+        spu->ip     = image->entry;
+        spu->input  = input  ? input  : stdin;
+        spu->output = output ? output : stdout;
+        if (image->data_size) memcpy(spu->ram, image->data, image->data_size * sizeof(int));
+
+        CPUWork(spu);
+        SpuFlushOutput(spu);
+    }
+
+    if (input  && !job->input)  fclose(input);
+    if (output && !job->output) fclose(output);
+
+    return result;
+}
+
+static void* WorkerRun(void* arg) {
+    ASSERT(arg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    SpuWorker*        worker = (SpuWorker*) arg;
+    SpuPoolState*       pool = worker->pool;
+    const SpuImage*    image = pool->image;
+
+    //* the context is made once and reset between the jobs, the code and its decoding are shared
+    //* (if it is not made, the range of the worker is done by the thieves)
+    SPU* spu = SpuInit(&image->config);
+    if (!spu) {
+        SetPoolError(pool, SPU_POOL_MEMORY_ERROR);
+        return NULL;
+    }
+
+    spu->cmds           = image->cmds;
+    spu->cmds_size      = image->cmds_size;
+    spu->decoded        = image->decoded;
+    spu->decoded_shared = 1;
+
+    size_t job = 0;
+    while (TakeJob(worker, &job)) {
+        SpuPoolReturnCode result = RunJob(spu, image, &pool->jobs[job]);
+        if (result != SPU_POOL_SUCCESS) SetPoolError(pool, result);
+    }
+
+    SpuDtor(spu);
+
+    return NULL;
+}
+
+SpuPoolReturnCode SpuPoolRun(const SpuImage* image, const SpuJob* jobs, size_t jobs_count, size_t threads_count) {
+    ASSERT(image != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(jobs  != NULL || jobs_count == 0, "NULL POINTER WAS PASSED!\n");
+
+    if (jobs_count == 0) return SPU_POOL_SUCCESS;
+
+    if (threads_count == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads_count = online > 0 ? (size_t) online : 1;
+    }
+    if (threads_count > jobs_count) threads_count = jobs_count;
+
+    SpuPoolState pool = {image, jobs, NULL, threads_count, SPU_POOL_SUCCESS};
+    pool.workers = (SpuWorker*) calloc(threads_count, sizeof(SpuWorker));
+    if (!pool.workers) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return SPU_POOL_MEMORY_ERROR;
+    }
+
+    for (size_t i = 0; i < threads_count; i++) {
+        pool.workers[i].next  = jobs_count * i       / threads_count;
+        pool.workers[i].end   = jobs_count * (i + 1) / threads_count;
+        pool.workers[i].index = i;
+        pool.workers[i].pool  = &pool;
+    }
+
+    //* if a thread is not created, its range is done by the thieves
+    size_t started = 0;
+    for (size_t i = 0; i < threads_count; i++) {
+        pool.workers[i].is_started = pthread_create(&pool.workers[i].thread, NULL, WorkerRun, &pool.workers[i]) == 0;
+        started += (size_t) pool.workers[i].is_started;
+    }
+
+    if (started == 0) {
+        fprintf(stderr, RED("Error occured while creating the threads of the pool!\n"));
+        FREE(pool.workers);
+        return SPU_POOL_THREAD_ERROR;
+    }
+
+    for (size_t i = 0; i < threads_count; i++) {
+        if (pool.workers[i].is_started) pthread_join(pool.workers[i].thread, NULL);
+    }
+
+    FREE(pool.workers);
+
+    return (SpuPoolReturnCode) pool.error;
+}
+
+//* ================================== batch =================================
+
+char* SpuReadList(const char* filename) {
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FILE* list_file = fopen(filename, "r");
+    if (!list_file) {
+        fprintf(stderr, RED("Error occured while opening %s!\n"), filename);
+        return NULL;
+    }
+
+    fseek(list_file, 0, SEEK_END);
+    long size = ftell(list_file);
+    fseek(list_file, 0, SEEK_SET);
+
+    char* text = size >= 0 ? (char*) calloc((size_t) size + 1, sizeof(char)) : NULL;
+    if (text) fread(text, sizeof(char), (size_t) size, list_file);
+
+    fclose(list_file);
+
+    return text;
+}
+
+SpuPoolReturnCode SpuPoolRunList(const SpuImage* image, const char* list_filename, size_t threads_count) {
+    ASSERT(image         != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(list_filename != NULL, "NULL POINTER WAS PASSED!\n");
+
+    char* text = SpuReadList(list_filename);
+    if (!text) return SPU_POOL_FILE_ERROR;
+
+    size_t lines_count = 1;
+    for (const char* c = text; *c; c++) lines_count += *c == '\n';
+
+    SpuJob*  jobs = (SpuJob*) calloc(lines_count, sizeof(SpuJob));
+    char**  names = (char**)  calloc(lines_count, sizeof(char*));
+    size_t  jobs_count = 0;
+
+    SpuPoolReturnCode result = (jobs && names) ? SPU_POOL_SUCCESS : SPU_POOL_MEMORY_ERROR;
+
+    for (char* line = strtok(text, "\r\n"); line && result == SPU_POOL_SUCCESS; line = strtok(NULL, "\r\n")) {
+        size_t length = strlen(line);
+        if (length == 0) continue;
+
+        names[jobs_count] = (char*) calloc(length + sizeof(".out"), sizeof(char));
+        if (!names[jobs_count]) {
+            result = SPU_POOL_MEMORY_ERROR;
+            break;
+        }
+        memcpy(names[jobs_count], line, length);
+        memcpy(names[jobs_count] + length, ".out", sizeof(".out"));
+
+        jobs[jobs_count].input_name  = line;
+        jobs[jobs_count].output_name = names[jobs_count];
+        jobs_count++;
+    }
+
+    if (result == SPU_POOL_SUCCESS) result = SpuPoolRun(image, jobs, jobs_count, threads_count);
+    else                            fprintf(stderr, RED("MEMORY ERROR!\n"));
+
+    for (size_t i = 0; names && i < jobs_count; i++) FREE(names[i]);
+    FREE(names);
+    FREE(jobs);
+    FREE(text);
+
+    return result;
+}
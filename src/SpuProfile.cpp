@@ -0,0 +1,573 @@
+/*!
+    \file
+    File with the execution profile of the SPU: its creation, the stack samples and the text, JSON and folded reports
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SpuProfile.h"
+#include "Executable.h"
+#include "processor.h"
+
+//* ================================== profile =================================
+
+SpuProfile* SpuProfileCreate(size_t cmds_size) {
+    SpuProfile* profile = (SpuProfile*) calloc(1, sizeof(SpuProfile));
+    if (!profile) return NULL;
+
+    profile->cmds_size   = cmds_size;
+    profile->ip_counts   = (size_t*) calloc(cmds_size + 1, sizeof(size_t));
+    profile->call_counts = (size_t*) calloc(cmds_size + 1, sizeof(size_t));
+    profile->countdown   = SPU_PROFILE_SAMPLE_PERIOD;
+    profile->sampled_op  = -1;
+
+    profile->stack_countdown = SPU_PROFILE_STACK_PERIOD;
+
+    //* the least time of the empty measurement
+    profile->tsc_overhead = UINT64_MAX;
+    for (int i = 0; i < 64; i++) {
+        uint64_t start  = SpuProfileTsc();
+        uint64_t cycles = SpuProfileTsc() - start;
+        if (cycles < profile->tsc_overhead) profile->tsc_overhead = cycles;
+    }
+
+    if (!profile->ip_counts || !profile->call_counts) {
+        SpuProfileDtor(profile);
+        return NULL;
+    }
+
+    return profile;
+}
+
+void SpuProfileDtor(SpuProfile* profile) {
+    if (!profile) return;
+
+    for (size_t i = 0; i < profile->stacks_capacity; i++) FREE(profile->stacks[i].text);
+
+    FREE(profile->ip_counts);
+    FREE(profile->call_counts);
+    FREE(profile->stacks);
+    FREE(profile);
+}
+
+//* ================================== stacks =================================
+
+/// @brief Constant for the longest frame of the folded stack: the name, ":line" and ';'
+static const size_t SPU_PROFILE_FRAME_LEN = SPU_EXE_NAME_LEN + 16;
+
+/// @brief Appends the frame named by the symbol (or by its address) to the folded stack
+static void AppendFrame(char* text, size_t* length, const SpuExeSymbol* symbol, int address) {
+    ASSERT(text   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(length != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (*length) text[(*length)++] = ';';
+
+    int written = 0;
+    if (symbol) {
+        int name_length = (int) strnlen(symbol->name, SPU_EXE_NAME_LEN);
+        written = snprintf(text + *length, SPU_PROFILE_FRAME_LEN, "%.*s", name_length, symbol->name);
+    } else {
+        written = snprintf(text + *length, SPU_PROFILE_FRAME_LEN, "@%d", address);
+    }
+
+    if (written > 0) *length += (size_t) written;
+}
+
+/// @brief FNV-1a hash of the folded stack
+static size_t HashStack(const char* text, size_t length) {
+    ASSERT(text != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char) text[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+/// @brief Doubles the hash table of the stacks, returns 0 if there is no memory
+static int GrowStacks(SpuProfile* profile) {
+    ASSERT(profile != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t new_capacity = profile->stacks_capacity ? profile->stacks_capacity * 2 : 64;
+
+    SpuProfileStack* new_stacks = (SpuProfileStack*) calloc(new_capacity, sizeof(SpuProfileStack));
+    if (!new_stacks) return 0;
+
+    for (size_t i = 0; i < profile->stacks_capacity; i++) {
+        const SpuProfileStack* stack = &profile->stacks[i];
+        if (!stack->text) continue;
+
+        size_t slot = stack->hash & (new_capacity - 1);
+        while (new_stacks[slot].text) slot = (slot + 1) & (new_capacity - 1);
+
+        new_stacks[slot] = *stack;
+    }
+
+    FREE(profile->stacks);
+    profile->stacks          = new_stacks;
+    profile->stacks_capacity = new_capacity;
+
+    return 1;
+}
+
+/// @brief Counts the sample of the folded stack
+static void CountStack(SpuProfile* profile, const char* text, size_t length) {
+    ASSERT(profile != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(text    != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (2 * (profile->stacks_count + 1) > profile->stacks_capacity && !GrowStacks(profile)) return;
+
+    size_t hash = HashStack(text, length);
+    size_t slot = hash & (profile->stacks_capacity - 1);
+
+    for (;;) {
+        SpuProfileStack* stack = &profile->stacks[slot];
+
+        if (!stack->text) break;
+        if (stack->hash == hash && strcmp(stack->text, text) == 0) {
+            stack->count++;
+            return;
+        }
+
+        slot = (slot + 1) & (profile->stacks_capacity - 1);
+    }
+
+    char* copy = strdup(text);
+    if (!copy) return;
+
+    profile->stacks[slot] = {copy, hash, 1};
+    profile->stacks_count++;
+}
+
+void SpuProfileSampleStack(SpuProfile* profile, const SPU* spu, const int* calls, size_t calls_count) {
+    ASSERT(profile != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(spu     != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(calls != NULL || calls_count == 0, "NULL POINTER WAS PASSED!\n");
+
+    const SpuDebugInfo* debug_info = spu->debug_info;
+
+    char   text[(SPU_PROFILE_STACK_DEPTH + 3) * SPU_PROFILE_FRAME_LEN] = "";
+    size_t length = 0;
+
+    //* the root is the function of the outer CALL (or of the current command if there are no calls)
+    const SpuExeSymbol* root = SpuDebugFindSymbol(debug_info, calls_count ? calls[0] - 1 : spu->ip, 1);
+    int function = root ? root->address : 0;
+    AppendFrame(text, &length, root, function);
+
+    size_t first = calls_count > SPU_PROFILE_STACK_DEPTH ? calls_count - SPU_PROFILE_STACK_DEPTH : 0;
+    if (first) length += (size_t) sprintf(text + length, ";...");
+
+    //* the callee of the frame is the target of the CALL right before its return address
+    for (size_t i = first; i < calls_count; i++) {
+        int call = calls[i] - 2;
+
+        function = (call >= 0 && (size_t) call < spu->cmds_size && spu->decoded[call].op == SPU_OP_CALL)
+                 ? spu->decoded[call].target : -1;
+        AppendFrame(text, &length, SpuDebugFindSymbol(debug_info, function, 0), function);
+    }
+
+    int line = SpuDebugFindLine(debug_info, spu->ip, function);
+    if (line) length += (size_t) sprintf(text + length, ":%d", line);
+
+    CountStack(profile, text, length);
+}
+
+//* ================================== report =================================
+
+/// @brief Structure with the hot range: the commands that follow each other and run the same number of times
+struct SpuProfileRange {
+    size_t    begin;
+    size_t      end; ///< the address after the last command
+    size_t    count; ///< executions of every command of the range
+    size_t commands; ///< commands in the range
+};
+
+/// @brief Structure with the executed address
+struct SpuProfileAddress {
+    size_t    ip;
+    size_t count;
+};
+
+/// @brief Constant for the longest sequence of the commands in the report
+static const size_t SPU_PROFILE_SEQUENCE_LENGTH = 3;
+
+/// @brief Structure with the sequence of the commands that follow each other without a jump (a pair or a triple)
+struct SpuProfileSequence {
+    SpuOp    ops[SPU_PROFILE_SEQUENCE_LENGTH];
+    size_t length;
+    size_t  count; ///< executions of the whole sequence
+};
+
+/// @brief Structure with the data of the report that is computed once for both formats
+struct SpuProfileSummary {
+    size_t           total; ///< all executed commands
+    double  cycles_per_cmd[SPU_OPS_COUNT]; ///< average of the samples (0 if the command is not sampled)
+    double    total_cycles; ///< estimation of the cycles of the run
+    SpuProfileRange* ranges;
+    size_t    ranges_count;
+    SpuProfileAddress* addresses; ///< executed addresses by the count
+    size_t addresses_count;
+    SpuProfileSequence* sequences; ///< executed sequences by the count
+    size_t sequences_count;
+};
+
+static int CompareRanges(const void* first, const void* second) {
+    const SpuProfileRange* a = (const SpuProfileRange*) first;
+    const SpuProfileRange* b = (const SpuProfileRange*) second;
+
+    size_t a_executed = a->count * a->commands;
+    size_t b_executed = b->count * b->commands;
+
+    if (a_executed != b_executed) return a_executed < b_executed ? 1 : -1;
+    return a->begin < b->begin ? -1 : (a->begin > b->begin);
+}
+
+static int CompareAddresses(const void* first, const void* second) {
+    const SpuProfileAddress* a = (const SpuProfileAddress*) first;
+    const SpuProfileAddress* b = (const SpuProfileAddress*) second;
+
+    if (a->count != b->count) return a->count < b->count ? 1 : -1;
+    return a->ip < b->ip ? -1 : (a->ip > b->ip);
+}
+
+/// @brief Splits the executed code into the hot ranges, the superinstructions are stepped over by their length
+static SpuProfileReturnCode FindRanges(const SpuProfile* profile, const SpuInstr* decoded, SpuProfileSummary* summary) {
+    ASSERT(profile != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(decoded != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(summary != NULL, "NULL POINTER WAS PASSED!\n");
+
+    summary->ranges    = (SpuProfileRange*)   calloc(profile->cmds_size + 1, sizeof(SpuProfileRange));
+    summary->addresses = (SpuProfileAddress*) calloc(profile->cmds_size + 1, sizeof(SpuProfileAddress));
+    if (!summary->ranges || !summary->addresses) return SPU_PROFILE_MEMORY_ERROR;
+
+    size_t ip = 0;
+    while (ip < profile->cmds_size) {
+        size_t count = profile->ip_counts[ip];
+        if (count == 0) {
+            ip++;
+            continue;
+        }
+
+        SpuProfileRange* range = &summary->ranges[summary->ranges_count++];
+        range->begin = ip;
+        range->count = count;
+
+        while (ip < profile->cmds_size && profile->ip_counts[ip] == count) {
+            summary->addresses[summary->addresses_count++] = {ip, count};
+            range->commands++;
+            ip += (size_t) (decoded[ip].length > 0 ? decoded[ip].length : 1);
+        }
+
+        range->end = ip;
+    }
+
+    qsort(summary->ranges, summary->ranges_count, sizeof(SpuProfileRange), CompareRanges);
+    qsort(summary->addresses, summary->addresses_count, sizeof(SpuProfileAddress), CompareAddresses);
+
+    return SPU_PROFILE_SUCCESS;
+}
+
+static int CompareSequences(const void* first, const void* second) {
+    const SpuProfileSequence* a = (const SpuProfileSequence*) first;
+    const SpuProfileSequence* b = (const SpuProfileSequence*) second;
+
+    if (a->count  != b->count)  return a->count  < b->count  ? 1 : -1;
+    if (a->length != b->length) return a->length < b->length ? 1 : -1;
+    return memcmp(a->ops, b->ops, sizeof(a->ops));
+}
+
+/*!
+    @brief Counts the pairs and the triples of the commands that follow each other in the code: the sequence
+           from the address runs every time the address runs unless a command before its last one ends the run,
+           so the counts are exact. They are the candidates for the superinstructions (the single commands
+           are counted if the fused ones are off by SPU_NO_SUPERINSTRUCTIONS)
+*/
+static SpuProfileReturnCode FindSequences(const SpuProfile* profile, const SpuInstr* decoded,
+                                          SpuProfileSummary* summary) {
+    ASSERT(profile != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(decoded != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(summary != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const size_t ops_count = (size_t) SPU_OPS_COUNT;
+    const size_t pairs     = ops_count * ops_count;
+
+    //* the pairs are indexed by op1 * ops_count + op2, the triples follow them
+    size_t* counts = (size_t*) calloc(pairs + pairs * ops_count, sizeof(size_t));
+    if (!counts) return SPU_PROFILE_MEMORY_ERROR;
+
+    for (size_t ip = 0; ip < profile->cmds_size; ip++) {
+        size_t count = profile->ip_counts[ip];
+        if (count == 0 || SpuIsRunEnd(decoded[ip].op)) continue;
+
+        size_t second = ip + (size_t) decoded[ip].length;
+        if (second >= profile->cmds_size) continue;
+
+        size_t pair = (size_t) decoded[ip].op * ops_count + (size_t) decoded[second].op;
+        counts[pair] += count;
+
+        if (SpuIsRunEnd(decoded[second].op)) continue;
+
+        size_t third = second + (size_t) decoded[second].length;
+        if (third >= profile->cmds_size) continue;
+
+        counts[pairs + pair * ops_count + (size_t) decoded[third].op] += count;
+    }
+
+    size_t found = 0;
+    for (size_t i = 0; i < pairs + pairs * ops_count; i++) found += counts[i] != 0;
+
+    summary->sequences = (SpuProfileSequence*) calloc(found + 1, sizeof(SpuProfileSequence));
+    if (!summary->sequences) {
+        FREE(counts);
+        return SPU_PROFILE_MEMORY_ERROR;
+    }
+
+    for (size_t i = 0; i < pairs + pairs * ops_count; i++) {
+        if (!counts[i]) continue;
+
+        SpuProfileSequence* sequence = &summary->sequences[summary->sequences_count++];
+        size_t index = i < pairs ? i : i - pairs;
+
+        sequence->length = i < pairs ? 2 : 3;
+        sequence->count  = counts[i];
+        for (size_t j = sequence->length; j-- > 0;) {
+            sequence->ops[j] = (SpuOp) (index % ops_count);
+            index /= ops_count;
+        }
+    }
+
+    qsort(summary->sequences, summary->sequences_count, sizeof(SpuProfileSequence), CompareSequences);
+
+    FREE(counts);
+
+    return SPU_PROFILE_SUCCESS;
+}
+
+static void Summarize(const SpuProfile* profile, SpuProfileSummary* summary) {
+    ASSERT(profile != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(summary != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (int op = 0; op < SPU_OPS_COUNT; op++) {
+        summary->total += profile->op_counts[op];
+
+        if (profile->op_samples[op]) {
+            summary->cycles_per_cmd[op] = (double) profile->op_cycles[op] / (double) profile->op_samples[op];
+        }
+        summary->total_cycles += summary->cycles_per_cmd[op] * (double) profile->op_counts[op];
+    }
+}
+
+static double Percent(double part, double total) {
+    return total > 0 ? 100 * part / total : 0;
+}
+
+static void WriteText(FILE* file, const SpuProfile* profile, const SpuInstr* decoded, const SpuProfileSummary* summary) {
+    ASSERT(file    != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(profile != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(decoded != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(summary != NULL, "NULL POINTER WAS PASSED!\n");
+
+    fprintf(file, "SPU PROFILE\n");
+    fprintf(file, "commands: %lu, cycles are sampled on every %lu command\n\n", summary->total, SPU_PROFILE_SAMPLE_PERIOD);
+
+    fprintf(file, "OPCODE MIX\n");
+    fprintf(file, "%-20s %14s %8s %12s %8s\n", "command", "count", "count %", "cycles/cmd", "time %");
+    for (int op = 0; op < SPU_OPS_COUNT; op++) {
+        if (!profile->op_counts[op]) continue;
+
+        double count = (double) profile->op_counts[op];
+        fprintf(file, "%-20s %14lu %8.2lf %12.1lf %8.2lf\n", SPU_OP_NAMES[op], profile->op_counts[op],
+                Percent(count, (double) summary->total), summary->cycles_per_cmd[op],
+                Percent(summary->cycles_per_cmd[op] * count, summary->total_cycles));
+    }
+
+    fprintf(file, "\nHOT RANGES\n");
+    fprintf(file, "%-16s %14s %10s %14s %8s\n", "addresses", "count", "commands", "executed", "%");
+    for (size_t i = 0; i < summary->ranges_count && i < SPU_PROFILE_TOP; i++) {
+        const SpuProfileRange* range = &summary->ranges[i];
+        size_t executed = range->count * range->commands;
+
+        fprintf(file, "[%6lu, %6lu) %14lu %10lu %14lu %8.2lf\n", range->begin, range->end, range->count,
+                range->commands, executed, Percent((double) executed, (double) summary->total));
+    }
+
+    fprintf(file, "\nHOT ADDRESSES\n");
+    fprintf(file, "%-8s %-20s %14s %8s\n", "ip", "command", "count", "%");
+    for (size_t i = 0; i < summary->addresses_count && i < SPU_PROFILE_TOP; i++) {
+        const SpuProfileAddress* address = &summary->addresses[i];
+
+        fprintf(file, "%-8lu %-20s %14lu %8.2lf\n", address->ip, SPU_OP_NAMES[decoded[address->ip].op], address->count,
+                Percent((double) address->count, (double) summary->total));
+    }
+
+    fprintf(file, "\nSEQUENCES\n");
+    fprintf(file, "%-56s %14s %8s\n", "commands", "count", "%");
+    for (size_t i = 0; i < summary->sequences_count && i < SPU_PROFILE_TOP; i++) {
+        const SpuProfileSequence* sequence = &summary->sequences[i];
+
+        char text[SPU_PROFILE_SEQUENCE_LENGTH * 20] = "";
+        size_t length = 0;
+        for (size_t j = 0; j < sequence->length; j++) {
+            length += (size_t) snprintf(text + length, sizeof(text) - length, "%s%s", j ? "; " : "",
+                                        SPU_OP_NAMES[sequence->ops[j]]);
+        }
+
+        fprintf(file, "%-56s %14lu %8.2lf\n", text, sequence->count,
+                Percent((double) sequence->count, (double) summary->total));
+    }
+
+    fprintf(file, "\nCALLS\n");
+    fprintf(file, "%-8s %14s\n", "target", "count");
+    for (size_t ip = 0; ip <= profile->cmds_size; ip++) {
+        if (profile->call_counts[ip]) fprintf(file, "%-8lu %14lu\n", ip, profile->call_counts[ip]);
+    }
+}
+
+static void WriteJson(FILE* file, const SpuProfile* profile, const SpuInstr* decoded, const SpuProfileSummary* summary) {
+    ASSERT(file    != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(profile != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(decoded != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(summary != NULL, "NULL POINTER WAS PASSED!\n");
+
+    fprintf(file, "{\n  \"commands\": %lu,\n  \"sample_period\": %lu,\n", summary->total, SPU_PROFILE_SAMPLE_PERIOD);
+
+    const char* separator = "";
+
+    fprintf(file, "  \"opcodes\": [");
+    for (int op = 0; op < SPU_OPS_COUNT; op++) {
+        if (!profile->op_counts[op]) continue;
+
+        fprintf(file, "%s\n    {\"op\": \"%s\", \"count\": %lu, \"samples\": %lu, \"cycles\": %lu}", separator,
+                SPU_OP_NAMES[op], profile->op_counts[op], profile->op_samples[op], profile->op_cycles[op]);
+        separator = ",";
+    }
+
+    separator = "";
+    fprintf(file, "\n  ],\n  \"ranges\": [");
+    for (size_t i = 0; i < summary->ranges_count; i++) {
+        const SpuProfileRange* range = &summary->ranges[i];
+
+        fprintf(file, "%s\n    {\"begin\": %lu, \"end\": %lu, \"count\": %lu, \"commands\": %lu}", separator,
+                range->begin, range->end, range->count, range->commands);
+        separator = ",";
+    }
+
+    separator = "";
+    fprintf(file, "\n  ],\n  \"addresses\": [");
+    for (size_t i = 0; i < summary->addresses_count; i++) {
+        const SpuProfileAddress* address = &summary->addresses[i];
+
+        fprintf(file, "%s\n    {\"ip\": %lu, \"op\": \"%s\", \"count\": %lu}", separator,
+                address->ip, SPU_OP_NAMES[decoded[address->ip].op], address->count);
+        separator = ",";
+    }
+
+    separator = "";
+    fprintf(file, "\n  ],\n  \"sequences\": [");
+    for (size_t i = 0; i < summary->sequences_count; i++) {
+        const SpuProfileSequence* sequence = &summary->sequences[i];
+
+        fprintf(file, "%s\n    {\"ops\": [", separator);
+        for (size_t j = 0; j < sequence->length; j++) {
+            fprintf(file, "%s\"%s\"", j ? ", " : "", SPU_OP_NAMES[sequence->ops[j]]);
+        }
+        fprintf(file, "], \"count\": %lu}", sequence->count);
+        separator = ",";
+    }
+
+    separator = "";
+    fprintf(file, "\n  ],\n  \"calls\": [");
+    for (size_t ip = 0; ip <= profile->cmds_size; ip++) {
+        if (!profile->call_counts[ip]) continue;
+
+        fprintf(file, "%s\n    {\"target\": %lu, \"count\": %lu}", separator, ip, profile->call_counts[ip]);
+        separator = ",";
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+}
+
+SpuProfileReturnCode SpuProfileReport(const SpuProfile* profile, const SpuInstr* decoded,
+                                      const char* text_filename, const char* json_filename) {
+    ASSERT(profile       != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(decoded       != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(text_filename != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(json_filename != NULL, "NULL POINTER WAS PASSED!\n");
+
+    SpuProfileSummary summary = {};
+    Summarize(profile, &summary);
+
+    SpuProfileReturnCode result = FindRanges(profile, decoded, &summary);
+    if (result == SPU_PROFILE_SUCCESS) result = FindSequences(profile, decoded, &summary);
+    if (result != SPU_PROFILE_SUCCESS) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(summary.ranges);
+        FREE(summary.addresses);
+        FREE(summary.sequences);
+        return result;
+    }
+
+    FILE* text_file = fopen(text_filename, "w");
+    FILE* json_file = fopen(json_filename, "w");
+
+    if (text_file && json_file) {
+        WriteText(text_file, profile, decoded, &summary);
+        WriteJson(json_file, profile, decoded, &summary);
+    } else {
+        fprintf(stderr, RED("Error occured while opening the profile reports!\n"));
+        result = SPU_PROFILE_FILE_ERROR;
+    }
+
+    if (text_file) fclose(text_file);
+    if (json_file) fclose(json_file);
+
+    FREE(summary.ranges);
+    FREE(summary.addresses);
+    FREE(summary.sequences);
+
+    return result;
+}
+
+static int CompareStacks(const void* first, const void* second) {
+    const SpuProfileStack* a = *(const SpuProfileStack* const*) first;
+    const SpuProfileStack* b = *(const SpuProfileStack* const*) second;
+
+    if (a->count != b->count) return a->count < b->count ? 1 : -1;
+    return strcmp(a->text, b->text);
+}
+
+SpuProfileReturnCode SpuProfileWriteFolded(const SpuProfile* profile, const char* filename) {
+    ASSERT(profile  != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const SpuProfileStack** sorted = (const SpuProfileStack**) calloc(profile->stacks_count + 1, sizeof(SpuProfileStack*));
+    if (!sorted) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return SPU_PROFILE_MEMORY_ERROR;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < profile->stacks_capacity; i++) {
+        if (profile->stacks[i].text) sorted[count++] = &profile->stacks[i];
+    }
+
+    qsort(sorted, count, sizeof(SpuProfileStack*), CompareStacks);
+
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, RED("Error occured while opening the profile reports!\n"));
+        FREE(sorted);
+        return SPU_PROFILE_FILE_ERROR;
+    }
+
+    for (size_t i = 0; i < count; i++) fprintf(file, "%s %lu\n", sorted[i]->text, sorted[i]->count);
+
+    fclose(file);
+    FREE(sorted);
+
+    return SPU_PROFILE_SUCCESS;
+}
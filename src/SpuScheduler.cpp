@@ -0,0 +1,500 @@
+/*!
+    \file
+    File with the cooperative scheduler of the SPUs: the ready queue, the input polling and the batch of input files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "SpuScheduler.h"
+#include "processor.h"
+
+//* ================================== ready queue =================================
+
+static void PushReady(SpuScheduler* sched, size_t id) {
+    ASSERT(sched != NULL, "NULL POINTER WAS PASSED!\n");
+
+    sched->tasks[id].is_ready = 1;
+    sched->ready[(sched->ready_head + sched->ready_count++) % sched->tasks_capacity] = id;
+}
+
+static size_t PopReady(SpuScheduler* sched) {
+    ASSERT(sched != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t id = sched->ready[sched->ready_head];
+    sched->ready_head = (sched->ready_head + 1) % sched->tasks_capacity;
+    sched->ready_count--;
+    sched->tasks[id].is_ready = 0;
+
+    return id;
+}
+
+/// @brief Grows the tasks and the ring, the ring is unrolled from its head
+static int GrowTasks(SpuScheduler* sched) {
+    ASSERT(sched != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t capacity = sched->tasks_capacity ? sched->tasks_capacity * 2 : 16;
+
+    SpuTask* tasks = (SpuTask*) realloc(sched->tasks, capacity * sizeof(SpuTask));
+    if (!tasks) return 0;
+    sched->tasks = tasks;
+
+    size_t* ready = (size_t*) calloc(capacity, sizeof(size_t));
+    if (!ready) return 0;
+
+    for (size_t i = 0; i < sched->ready_count; i++) {
+        ready[i] = sched->ready[(sched->ready_head + i) % sched->tasks_capacity];
+    }
+
+    FREE(sched->ready);
+    sched->ready          = ready;
+    sched->ready_head     = 0;
+    sched->tasks_capacity = capacity;
+
+    return 1;
+}
+
+/// @brief The input files that can be open at once by one of the shares schedulers (the window below RLIMIT_NOFILE)
+static size_t OpenLimit(size_t shares) {
+    struct rlimit limit = {};
+    size_t files = 1024;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) files = limit.rlim_cur;
+
+    files = files > 2 * SPU_SCHED_RESERVED_FDS ? files - SPU_SCHED_RESERVED_FDS : files / 2;
+    files /= shares ? shares : 1;
+
+    return files ? files : 1;
+}
+
+//* ================================== tasks =================================
+
+void SpuSchedulerInit(SpuScheduler* sched, const SpuImage* image, long budget) {
+    ASSERT(sched != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(image != NULL, "NULL POINTER WAS PASSED!\n");
+
+    *sched = {};
+    sched->image      = image;
+    sched->budget     = budget > 0 ? budget : SPU_SCHED_BUDGET;
+    sched->open_limit = OpenLimit(1);
+}
+
+void SpuSchedulerDtor(SpuScheduler* sched) {
+    ASSERT(sched != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < sched->tasks_count; i++) {
+        SpuTask* task = &sched->tasks[i];
+
+        if (task->input_fd >= 0) close(task->input_fd);
+        SpuDtor(task->spu);
+        FREE(task->text);
+    }
+
+    FREE(sched->tasks);
+    FREE(sched->ready);
+    *sched = {};
+}
+
+SpuSchedReturnCode SpuSchedulerSpawn(SpuScheduler* sched, int input_fd, const char* input_name, FILE* output, size_t* id) {
+    ASSERT(sched != NULL, "NULL POINTER WAS PASSED!\n");
+
+    if (sched->tasks_count == sched->tasks_capacity && !GrowTasks(sched)) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return SPU_SCHED_MEMORY_ERROR;
+    }
+
+    const SpuImage* image = sched->image;
+
+    SPU* spu = SpuInit(&image->config);
+    if (!spu) return SPU_SCHED_MEMORY_ERROR;
+
+    spu->cmds              = image->cmds;
+    spu->cmds_size         = image->cmds_size;
+    spu->decoded           = image->decoded;
+    spu->decoded_shared    = 1;
+    spu->ip                = image->entry;
+    spu->output            = output ? output : stdout;
+    spu->in_queue.is_used  = 1;
+    if (image->data_size) memcpy(spu->ram, image->data, image->data_size * sizeof(int));
+
+    size_t task_id = sched->tasks_count++;
+    sched->tasks[task_id] = {spu, SPU_STATUS_BUDGET, 0, input_fd, input_name, 0, NULL, 0};
+    PushReady(sched, task_id);
+
+    if (id) *id = task_id;
+
+    return SPU_SCHED_SUCCESS;
+}
+
+/// @brief The task that waits for IN is ready again if it has got the numbers or its input is closed
+static void WakeUp(SpuScheduler* sched, size_t id) {
+    ASSERT(sched != NULL, "NULL POINTER WAS PASSED!\n");
+
+    SpuTask* task = &sched->tasks[id];
+    if (task->status == SPU_STATUS_INPUT && !task->is_ready && SpuInputReady(task->spu)) PushReady(sched, id);
+}
+
+SpuSchedReturnCode SpuSchedulerFeed(SpuScheduler* sched, size_t id, const int* values, size_t count, int is_closed) {
+    ASSERT(sched  != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(values != NULL || count == 0, "NULL POINTER WAS PASSED!\n");
+
+    if (id >= sched->tasks_count) return SPU_SCHED_TASK_ERROR;
+
+    SPU* spu = sched->tasks[id].spu;
+    if (!SpuQueueInput(spu, values, count)) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return SPU_SCHED_MEMORY_ERROR;
+    }
+    if (is_closed) spu->in_queue.is_closed = 1;
+
+    WakeUp(sched, id);
+
+    return SPU_SCHED_SUCCESS;
+}
+
+//* ================================== input =================================
+
+/// @brief Moves the whole numbers of the text to the input queue (the last one is whole only at the end of the input)
+static int ParseInput(SpuTask* task, int is_end) {
+    ASSERT(task != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const char* text = task->text;
+    size_t      size = task->text_size;
+    size_t       pos = 0;
+
+    for (;;) {
+        while (pos < size && isspace((unsigned char) text[pos])) pos++;
+
+        size_t end = pos;
+        while (end < size && !isspace((unsigned char) text[end])) end++;
+
+        if (end == pos || (end == size && !is_end)) break;
+
+        char number[32] = {};
+        memcpy(number, text + pos, (end - pos < sizeof(number) - 1) ? end - pos : sizeof(number) - 1);
+
+        int value = (int) strtol(number, NULL, 10);
+        if (!SpuQueueInput(task->spu, &value, 1)) return 0;
+
+        pos = end;
+    }
+
+    if (pos) memmove(task->text, task->text + pos, size - pos);
+    task->text_size = size - pos;
+
+    return 1;
+}
+
+/// @brief The input is over: the rest is parsed, the descriptor is closed and IN gets 0 from now on
+static void CloseInput(SpuTask* task) {
+    ASSERT(task != NULL, "NULL POINTER WAS PASSED!\n");
+
+    ParseInput(task, 1);
+
+    if (task->input_fd >= 0) close(task->input_fd);
+    task->input_fd   = -1;
+    task->input_name = NULL;
+    task->spu->in_queue.is_closed = 1;
+}
+
+/// @brief Reads all that the descriptor has now, the descriptor is closed at once at the end of the input
+static void ReadInput(SpuTask* task) {
+    ASSERT(task != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (;;) {
+        char* text = (char*) realloc(task->text, task->text_size + SPU_SCHED_CHUNK);
+        if (!text) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            CloseInput(task);
+            return;
+        }
+        task->text = text;
+
+        ssize_t read_size = read(task->input_fd, task->text + task->text_size, SPU_SCHED_CHUNK);
+
+        if (read_size > 0) {
+            task->text_size += (size_t) read_size;
+            if (!ParseInput(task, 0)) {
+                CloseInput(task);
+                return;
+            }
+        } else if (read_size < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (read_size == 0 || errno != EAGAIN) CloseInput(task);
+            return;
+        }
+    }
+}
+
+/// @brief The input file of the task can not be opened: the task is stopped with the error
+static void FailInput(SpuTask* task, int error) {
+    ASSERT(task != NULL, "NULL POINTER WAS PASSED!\n");
+
+    fprintf(stderr, RED("Error occured while opening %s: %s!\n"), task->input_name, strerror(error));
+
+    task->input_error = error;
+    task->input_name  = NULL;
+    task->status      = SPU_STATUS_ERROR;
+}
+
+/// @brief Opens the inputs of the waiting tasks (not more than open_limit at once), waits until one of them
+///        can be read and reads them
+/// @return 1 if there were inputs to wait for
+static int PollInputs(SpuScheduler* sched) {
+    ASSERT(sched != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t opened = 0;
+    for (size_t i = 0; i < sched->tasks_count; i++) opened += sched->tasks[i].input_fd >= 0;
+
+    //* deferred are the tasks whose inputs wait for a free descriptor
+    size_t waiting  = 0;
+    size_t deferred = 0;
+    for (size_t i = 0; i < sched->tasks_count; i++) {
+        SpuTask* task = &sched->tasks[i];
+        if (task->status != SPU_STATUS_INPUT || task->is_ready) continue;
+
+        if (task->input_fd < 0 && task->input_name) {
+            if (opened >= sched->open_limit) {
+                deferred++;
+                continue;
+            }
+
+            task->input_fd = open(task->input_name, O_RDONLY | O_NONBLOCK);
+            if (task->input_fd < 0) {
+                //* the process is out of descriptors: the open is repeated when some of them are closed
+                if (errno == EMFILE || errno == ENFILE) deferred++;
+                else                                    FailInput(task, errno);
+                continue;
+            }
+            opened++;
+        }
+
+        waiting += task->input_fd >= 0;
+    }
+
+    if (sched->ready_count) return 1;
+
+    if (waiting == 0) {
+        if (deferred == 0) return 0;
+
+        //* the descriptors are held by the other schedulers or by the rest of the program
+        poll(NULL, 0, SPU_SCHED_RETRY_MS);
+        return 1;
+    }
+
+    struct pollfd* fds = (struct pollfd*) calloc(waiting, sizeof(struct pollfd));
+    size_t*        ids = (size_t*)        calloc(waiting, sizeof(size_t));
+    if (!fds || !ids) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        FREE(fds);
+        FREE(ids);
+        return 0;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < sched->tasks_count; i++) {
+        SpuTask* task = &sched->tasks[i];
+        if (task->status != SPU_STATUS_INPUT || task->is_ready || task->input_fd < 0) continue;
+
+        fds[count] = {task->input_fd, POLLIN, 0};
+        ids[count++] = i;
+    }
+
+    if (poll(fds, count, deferred ? SPU_SCHED_RETRY_MS : -1) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            if (!fds[i].revents) continue;
+
+            ReadInput(&sched->tasks[ids[i]]);
+            WakeUp(sched, ids[i]);
+        }
+    }
+
+    FREE(fds);
+    FREE(ids);
+
+    return 1;
+}
+
+//* ================================== running =================================
+
+size_t SpuSchedulerRun(SpuScheduler* sched) {
+    ASSERT(sched != NULL, "NULL POINTER WAS PASSED!\n");
+
+    do {
+        while (sched->ready_count) {
+            size_t   id = PopReady(sched);
+            SpuTask* task = &sched->tasks[id];
+
+            task->status = CPUResume(task->spu, sched->budget);
+
+            if      (task->status == SPU_STATUS_BUDGET) PushReady(sched, id);
+            else if (task->status != SPU_STATUS_INPUT) {
+                SpuFlushOutput(task->spu);
+
+                //* the finished task gives its descriptor to the waiting ones
+                if (task->input_fd >= 0) close(task->input_fd);
+                task->input_fd = -1;
+            }
+        }
+    } while (PollInputs(sched));
+
+    size_t waiting = 0;
+    for (size_t i = 0; i < sched->tasks_count; i++) waiting += sched->tasks[i].status == SPU_STATUS_INPUT;
+
+    return waiting;
+}
+
+//* ================================== batch =================================
+
+/// @brief Structure with the part of the batch list that is run by one scheduler
+struct SpuSchedSlice {
+    pthread_t               thread;
+    int                 is_started;
+    const SpuImage*          image;
+    char**                  inputs;
+    size_t                   count;
+    long                    budget;
+    size_t              open_limit; ///< the share of the descriptors of the slice
+    SpuSchedReturnCode      result;
+};
+
+/// @brief Writes the output collected in memory to "<input>.out"
+static void WriteOutput(const char* input_name, const char* output, size_t size) {
+    ASSERT(input_name != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t length = strlen(input_name);
+
+    char* output_name = (char*) calloc(length + sizeof(".out"), sizeof(char));
+    if (!output_name) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return;
+    }
+    memcpy(output_name, input_name, length);
+    memcpy(output_name + length, ".out", sizeof(".out"));
+
+    FILE* output_file = fopen(output_name, "w");
+    if (output_file) {
+        if (size) fwrite(output, sizeof(char), size, output_file);
+        fclose(output_file);
+    } else {
+        fprintf(stderr, RED("Error occured while opening %s!\n"), output_name);
+    }
+
+    FREE(output_name);
+}
+
+/// @brief Runs the slice on its scheduler, the outputs are kept in memory until the tasks end (no descriptor per task)
+static void* RunSlice(void* arg) {
+    ASSERT(arg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    SpuSchedSlice* slice = (SpuSchedSlice*) arg;
+
+    FILE**   streams = (FILE**) calloc(slice->count, sizeof(FILE*));
+    char**   buffers = (char**) calloc(slice->count, sizeof(char*));
+    size_t*    sizes = (size_t*) calloc(slice->count, sizeof(size_t));
+    int*   is_failed = (int*) calloc(slice->count, sizeof(int)); ///< 1 if the input is not opened
+
+    SpuScheduler sched = {};
+    SpuSchedulerInit(&sched, slice->image, slice->budget);
+    sched.open_limit = slice->open_limit;
+
+    slice->result = (streams && buffers && sizes && is_failed) ? SPU_SCHED_SUCCESS : SPU_SCHED_MEMORY_ERROR;
+
+    for (size_t i = 0; i < slice->count && slice->result == SPU_SCHED_SUCCESS; i++) {
+        streams[i] = open_memstream(&buffers[i], &sizes[i]);
+        if (!streams[i]) {
+            slice->result = SPU_SCHED_MEMORY_ERROR;
+            break;
+        }
+
+        slice->result = SpuSchedulerSpawn(&sched, -1, slice->inputs[i], streams[i], NULL);
+    }
+
+    int is_spawned = slice->result == SPU_SCHED_SUCCESS;
+    if (is_spawned) {
+        SpuSchedulerRun(&sched);
+
+        //* the input that is not opened has no output, the batch ends with the error
+        for (size_t i = 0; i < slice->count; i++) {
+            is_failed[i] = sched.tasks[i].input_error != 0;
+            if (is_failed[i]) slice->result = SPU_SCHED_FILE_ERROR;
+        }
+    }
+
+    SpuSchedulerDtor(&sched);
+
+    for (size_t i = 0; streams && i < slice->count; i++) {
+        if (!streams[i]) continue;
+
+        fclose(streams[i]);
+        if (is_spawned && !is_failed[i]) WriteOutput(slice->inputs[i], buffers[i], sizes[i]);
+        FREE(buffers[i]);
+    }
+
+    FREE(streams);
+    FREE(buffers);
+    FREE(sizes);
+    FREE(is_failed);
+
+    return NULL;
+}
+
+SpuSchedReturnCode SpuSchedulerRunList(const SpuImage* image, const char* list_filename, long budget,
+                                       size_t threads_count) {
+    ASSERT(image         != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(list_filename != NULL, "NULL POINTER WAS PASSED!\n");
+
+    char* text = SpuReadList(list_filename);
+    if (!text) return SPU_SCHED_FILE_ERROR;
+
+    size_t lines_count = 1;
+    for (const char* c = text; *c; c++) lines_count += *c == '\n';
+
+    char** inputs = (char**) calloc(lines_count, sizeof(char*));
+    size_t inputs_count = 0;
+
+    for (char* line = inputs ? strtok(text, "\r\n") : NULL; line; line = strtok(NULL, "\r\n")) {
+        if (*line) inputs[inputs_count++] = line;
+    }
+
+    if (threads_count == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads_count = online > 0 ? (size_t) online : 1;
+    }
+    if (threads_count > inputs_count) threads_count = inputs_count ? inputs_count : 1;
+
+    SpuSchedSlice* slices = (SpuSchedSlice*) calloc(threads_count, sizeof(SpuSchedSlice));
+    SpuSchedReturnCode result = (inputs && slices) ? SPU_SCHED_SUCCESS : SPU_SCHED_MEMORY_ERROR;
+
+    for (size_t i = 0; i < threads_count && result == SPU_SCHED_SUCCESS; i++) {
+        size_t begin = inputs_count * i       / threads_count;
+        size_t end   = inputs_count * (i + 1) / threads_count;
+
+        slices[i] = {0, 0, image, inputs + begin, end - begin, budget, OpenLimit(threads_count), SPU_SCHED_SUCCESS};
+        slices[i].is_started = pthread_create(&slices[i].thread, NULL, RunSlice, &slices[i]) == 0;
+
+        //* the slice without the thread is run here
+        if (!slices[i].is_started) RunSlice(&slices[i]);
+    }
+
+    for (size_t i = 0; slices && i < threads_count; i++) {
+        if (slices[i].is_started) pthread_join(slices[i].thread, NULL);
+        if (slices[i].result != SPU_SCHED_SUCCESS) result = slices[i].result;
+    }
+
+    if (result == SPU_SCHED_MEMORY_ERROR) fprintf(stderr, RED("MEMORY ERROR!\n"));
+
+    FREE(slices);
+    FREE(inputs);
+    FREE(text);
+
+    return result;
+}
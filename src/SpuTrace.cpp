@@ -0,0 +1,173 @@
+/*!
+    \file
+    File with the execution trace of the SPU: the ring, its dump on the signals and the viewer of the dumps
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "SpuTrace.h"
+#include "Executable.h"
+
+/// @brief The trace that is dumped by the signals (the last created one)
+static SpuTrace* volatile SIGNAL_TRACE = NULL;
+
+//* ================================== signals =================================
+
+/// @brief Dumps the trace, the program is stopped by the default action of the signal then (except SIGUSR1)
+static void DumpOnSignal(int signal_number) {
+    SpuTrace* trace = SIGNAL_TRACE;
+    if (trace) SpuTraceDump(trace, SPU_TRACE_FILENAME);
+
+    if (signal_number == SIGUSR1) return;
+
+    signal(signal_number, SIG_DFL);
+    raise(signal_number);
+}
+
+static void InstallSignals() {
+    static int is_installed = 0;
+    if (is_installed) return;
+
+    struct sigaction action = {};
+    action.sa_handler = DumpOnSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+
+    sigaction(SIGINT,  &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGUSR1, &action, NULL);
+
+    is_installed = 1;
+}
+
+//* =================================== trace ==================================
+
+SpuTrace* SpuTraceCreate() {
+    SpuTrace* trace = (SpuTrace*) calloc(1, sizeof(SpuTrace));
+    if (!trace) return NULL;
+
+    trace->events = (SpuTraceEvent*) calloc(SPU_TRACE_SIZE, sizeof(SpuTraceEvent));
+    if (!trace->events) {
+        FREE(trace);
+        return NULL;
+    }
+
+    InstallSignals();
+    SIGNAL_TRACE = trace;
+
+    return trace;
+}
+
+void SpuTraceDtor(SpuTrace* trace) {
+    if (!trace) return;
+
+    if (SIGNAL_TRACE == trace) SIGNAL_TRACE = NULL;
+
+    FREE(trace->events);
+    FREE(trace);
+}
+
+/// @brief Writes the whole buffer (write can take a part of it)
+static int WriteAll(int fd, const void* buffer, size_t size) {
+    const char* bytes = (const char*) buffer;
+
+    while (size) {
+        ssize_t written = write(fd, bytes, size);
+        if (written <= 0) return 0;
+
+        bytes += written;
+        size  -= (size_t) written;
+    }
+
+    return 1;
+}
+
+SpuTraceReturnCode SpuTraceDump(const SpuTrace* trace, const char* filename) {
+    ASSERT(trace    != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t head  = trace->head;
+    size_t count = head < SPU_TRACE_SIZE ? head : SPU_TRACE_SIZE;
+    size_t first = (head - count) & (SPU_TRACE_SIZE - 1);
+
+    SpuTraceHeader header = {SPU_TRACE_MAGIC, SPU_TRACE_VERSION, (uint32_t) sizeof(SpuTraceEvent), (uint32_t) count, head};
+
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) return SPU_TRACE_FILE_ERROR;
+
+    //* the oldest events are at the end of the ring if it is wrapped
+    size_t tail_count = first + count > SPU_TRACE_SIZE ? SPU_TRACE_SIZE - first : count;
+
+    int is_written = WriteAll(fd, &header, sizeof(header)) &&
+                     WriteAll(fd, trace->events + first, tail_count * sizeof(SpuTraceEvent)) &&
+                     WriteAll(fd, trace->events, (count - tail_count) * sizeof(SpuTraceEvent));
+
+    close(fd);
+
+    return is_written ? SPU_TRACE_SUCCESS : SPU_TRACE_FILE_ERROR;
+}
+
+//* =================================== viewer =================================
+
+/// @brief Prints the function of the address with the offset in it and the line of the program
+static void PrintLocation(FILE* output, const SpuDebugInfo* debug_info, int ip) {
+    ASSERT(output != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const SpuExeSymbol* symbol = SpuDebugFindSymbol(debug_info, ip, 1);
+    if (!symbol) return;
+
+    int function = symbol->address;
+    fprintf(output, "%.*s", (int) strnlen(symbol->name, SPU_EXE_NAME_LEN), symbol->name);
+    if (ip != function) fprintf(output, "+%d", ip - function);
+
+    int line = SpuDebugFindLine(debug_info, ip, function);
+    if (line) fprintf(output, " (line %d)", line);
+}
+
+SpuTraceReturnCode SpuTraceView(const char* filename, const SpuDebugInfo* debug_info, FILE* output) {
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(output   != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, RED("Error occured while opening the trace \"%s\"!\n"), filename);
+        return SPU_TRACE_FILE_ERROR;
+    }
+
+    SpuTraceHeader header = {};
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != SPU_TRACE_MAGIC ||
+        header.version != SPU_TRACE_VERSION || header.event_size != sizeof(SpuTraceEvent) || header.count > header.total) {
+        fprintf(stderr, RED("\"%s\" is not the SPU trace!\n"), filename);
+        fclose(file);
+        return SPU_TRACE_FORMAT_ERROR;
+    }
+
+    fprintf(output, "SPU TRACE: %lu commands, the last %u of them\n", header.total, header.count);
+    fprintf(output, "%12s %8s %-20s %12s  %s\n", "event", "ip", "command", "tos", "function");
+
+    SpuTraceReturnCode result = SPU_TRACE_SUCCESS;
+    uint64_t event_index = header.total - header.count;
+
+    for (uint32_t i = 0; i < header.count; i++, event_index++) {
+        SpuTraceEvent event = {};
+        if (fread(&event, sizeof(event), 1, file) != 1) {
+            fprintf(stderr, RED("The SPU trace \"%s\" is cut!\n"), filename);
+            result = SPU_TRACE_FORMAT_ERROR;
+            break;
+        }
+
+        const char* name = event.op < (uint32_t) SPU_OPS_COUNT ? SPU_OP_NAMES[event.op] : "?";
+        fprintf(output, "%12lu %8d %-20s %12d  ", event_index, event.ip, name, event.tos);
+        PrintLocation(output, debug_info, event.ip);
+        fputc('\n', output);
+    }
+
+    fclose(file);
+
+    return result;
+}
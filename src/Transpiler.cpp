@@ -0,0 +1,421 @@
+/*!
+    \file
+    File with the ahead-of-time back end: the resolved program is written as C code for the system compiler
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Transpiler.h"
+#include "IR.h"
+
+/// @brief Enum with kinds of the C operands
+enum COperandKind {
+    C_NUMBER = 0,
+    C_SLOT   = 1, ///< local variable s<value>
+    C_TEMP   = 2, ///< temporary t<value>
+};
+
+/// @brief Structure with the operand of the C expression, calls are always moved to temporaries
+struct COperand {
+    COperandKind kind;
+    int         value;
+};
+
+/// @brief Structure with the state of the transpiler
+struct Transpiler {
+    const ExecProgram* program;
+    FILE*                  out;
+    int                  depth; ///< indentation of the current statement
+    int            temps_count;
+    int                  error;
+};
+
+//* ================================== runtime =================================
+
+/// @brief Writes the string as a C string literal (the colors of the messages are kept)
+static void WriteCString(FILE* out, const char* str) {
+    ASSERT(out != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(str != NULL, "NULL POINTER WAS PASSED!\n");
+
+    fputc('"', out);
+
+    for (const char* c = str; *c; c++) {
+        switch (*c) {
+            case '\033': fputs("\\033", out); break;
+            case '\n':   fputs("\\n",   out); break;
+            case '"':    fputs("\\\"",  out); break;
+            case '\\':   fputs("\\\\",  out); break;
+            default:     fputc(*c, out);      break;
+        }
+    }
+
+    fputc('"', out);
+}
+
+/// @brief Writes the helpers with the same arithmetic and messages as the SPU and the interpreter
+static void WriteRuntime(FILE* out) {
+    ASSERT(out != NULL, "NULL POINTER WAS PASSED!\n");
+
+    fprintf(out, "#include <stdio.h>\n"
+                 "#include <stdlib.h>\n"
+                 "#include <math.h>\n\n"
+                 "#define CALC_ACCURACY %d\n\n", CALC_ACCURACY);
+
+    fprintf(out, "static inline void lang_error(const char* message) {\n"
+                 "    printf(\"%%s\", message);\n"
+                 "    exit(1);\n"
+                 "}\n\n");
+
+    fprintf(out, "static inline int lang_trunc(int value) {\n"
+                 "    return value / CALC_ACCURACY * CALC_ACCURACY;\n"
+                 "}\n\n");
+
+    fprintf(out, "static inline int lang_div(int left, int right) {\n"
+                 "    if (right == 0) lang_error(");
+    WriteCString(out, RED("ERROR! DIVISION BY ZERO!!!\n"));
+    fprintf(out, ");\n"
+                 "    return CALC_ACCURACY * left / right;\n"
+                 "}\n\n");
+
+    fprintf(out, "static inline int lang_sqrt(int value) {\n"
+                 "    if (value / CALC_ACCURACY < 0) lang_error(");
+    WriteCString(out, RED("SQRT ERROR!\n"));
+    fprintf(out, ");\n"
+                 "    return (int) sqrt(value / CALC_ACCURACY) * CALC_ACCURACY;\n"
+                 "}\n\n");
+
+    fprintf(out, "static inline void lang_print(int value) {\n"
+                 "    printf(");
+    WriteCString(out, GREEN("RESULT: %lg\n"));
+    fprintf(out, ", (double) value / CALC_ACCURACY);\n"
+                 "}\n\n");
+
+    fprintf(out, "static inline int lang_scan(void) {\n"
+                 "    int value = 0;\n"
+                 "    printf(");
+    WriteCString(out, YELLOW("Enter a number: "));
+    fprintf(out, "); if (scanf(\"%%d\", &value) != 1) value = 0;\n"
+                 "    return value * CALC_ACCURACY;\n"
+                 "}\n\n");
+}
+
+//* ================================== expressions =================================
+
+static void Indent(Transpiler* tr) {
+    ASSERT(tr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (int i = 0; i < tr->depth; i++) fputs("    ", tr->out);
+}
+
+static void WriteOperand(Transpiler* tr, COperand operand) {
+    ASSERT(tr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    switch (operand.kind) {
+        case C_NUMBER:
+            if (operand.value < 0) fprintf(tr->out, "(%d)", operand.value);
+            else                   fprintf(tr->out, "%d",   operand.value);
+            break;
+        case C_SLOT: fprintf(tr->out, "s%d", operand.value); break;
+        case C_TEMP: fprintf(tr->out, "t%d", operand.value); break;
+        default:     break;
+    }
+}
+
+/// @brief Starts the declaration of the new temporary, the caller writes its initializer
+static COperand NewTemp(Transpiler* tr) {
+    ASSERT(tr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    COperand temp = {C_TEMP, tr->temps_count++};
+
+    Indent(tr);
+    fprintf(tr->out, "int t%d = ", temp.value);
+
+    return temp;
+}
+
+static void WriteBinary(Transpiler* tr, IROpcode opcode, COperand left, COperand right) {
+    ASSERT(tr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const char* compare = NULL;
+
+    switch (opcode) {
+        case IR_ADD: WriteOperand(tr, left); fputs(" + ", tr->out); WriteOperand(tr, right); return;
+        case IR_SUB: WriteOperand(tr, left); fputs(" - ", tr->out); WriteOperand(tr, right); return;
+        case IR_MUL:
+            WriteOperand(tr, left); fputs(" * ", tr->out); WriteOperand(tr, right);
+            fputs(" / CALC_ACCURACY", tr->out);
+            return;
+        case IR_DIV:
+            fputs("lang_div(", tr->out); WriteOperand(tr, left); fputs(", ", tr->out); WriteOperand(tr, right);
+            fputs(")", tr->out);
+            return;
+
+        case IR_LESS:       compare = "<";  break;
+        case IR_MORE:       compare = ">";  break;
+        case IR_LESS_EQUAL: compare = "<="; break;
+        case IR_MORE_EQUAL: compare = ">="; break;
+        case IR_EQUAL:      compare = "=="; break;
+        case IR_NOT_EQUAL:  compare = "!="; break;
+
+        case IR_CONST: case IR_PARAM: case IR_PHI: case IR_COPY: case IR_SQRT: case IR_TRUNC: case IR_CALL:
+        case IR_SCAN: case IR_PRINT: case IR_JMP: case IR_BRANCH: case IR_RET:
+        default:
+            fprintf(stderr, RED("Unknown operator in the program!\n"));
+            tr->error = 1;
+            fputs("0", tr->out);
+            return;
+    }
+
+    fputs("(", tr->out); WriteOperand(tr, left); fprintf(tr->out, " %s ", compare); WriteOperand(tr, right);
+    fputs(") * CALC_ACCURACY", tr->out);
+}
+
+/*!
+    @brief Function that writes the temporaries of the expression in the order the interpreter evaluates it
+    \param [in]    tr - pointer on the transpiler
+    \param [in] index - index of the expression node
+    @return The operand with the value of the expression
+*/
+static COperand WriteExpression(Transpiler* tr, int index) {
+    ASSERT(tr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const ExecNode* node = &tr->program->nodes[index];
+
+    switch (node->kind) {
+        case EXEC_NUMBER: return {C_NUMBER, node->value};
+        case EXEC_LOCAL:  return {C_SLOT,   node->value};
+
+        case EXEC_BINARY: {
+            COperand left  = WriteExpression(tr, node->first);
+            COperand right = WriteExpression(tr, node->second);
+
+            COperand temp = NewTemp(tr);
+            WriteBinary(tr, IROpcode(node->value), left, right);
+            fputs(";\n", tr->out);
+
+            return temp;
+        }
+
+        case EXEC_SQRT: {
+            COperand operand = WriteExpression(tr, node->first);
+
+            COperand temp = NewTemp(tr);
+            fputs("lang_sqrt(", tr->out); WriteOperand(tr, operand); fputs(");\n", tr->out);
+
+            return temp;
+        }
+
+        case EXEC_CALL: {
+            //* arguments are evaluated left to right before the call, so each one gets its temporary
+            IRIntArray args = {};
+
+            for (int i = 0; i < node->items_count; i++) {
+                COperand arg = WriteExpression(tr, tr->program->items[node->items + i]);
+
+                COperand temp = NewTemp(tr);
+                fputs("lang_trunc(", tr->out); WriteOperand(tr, arg); fputs(");\n", tr->out);
+
+                if (IRIntArrayPush(&args, temp.value) != IR_SUCCESS) tr->error = 1;
+            }
+
+            COperand temp = NewTemp(tr);
+            fprintf(tr->out, "f%d(", node->value);
+
+            for (size_t i = 0; i < args.size; i++) fprintf(tr->out, "%st%d", i ? ", " : "", args.data[i]);
+
+            fputs(");\n", tr->out);
+            IRIntArrayDtor(&args);
+
+            return temp;
+        }
+
+        case EXEC_ASSIGN: case EXEC_IF: case EXEC_WHILE: case EXEC_RETURN: case EXEC_PRINT: case EXEC_SCAN:
+        case EXEC_BLOCK:
+        default:
+            fprintf(stderr, RED("Statement in expression!\n"));
+            tr->error = 1;
+            return {C_NUMBER, 0};
+    }
+}
+
+//* ================================== statements =================================
+
+static void WriteStatement(Transpiler* tr, int index);
+
+static void WriteBody(Transpiler* tr, int index) {
+    ASSERT(tr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    tr->depth++;
+    WriteStatement(tr, index);
+    tr->depth--;
+}
+
+static void WriteStatement(Transpiler* tr, int index) {
+    ASSERT(tr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const ExecNode* node = &tr->program->nodes[index];
+
+    switch (node->kind) {
+        case EXEC_BLOCK:
+            for (int i = 0; i < node->items_count; i++) WriteStatement(tr, tr->program->items[node->items + i]);
+            return;
+
+        case EXEC_ASSIGN: {
+            COperand value = WriteExpression(tr, node->first);
+
+            Indent(tr);
+            fprintf(tr->out, "s%d = lang_trunc(", node->value); WriteOperand(tr, value); fputs(");\n", tr->out);
+            return;
+        }
+
+        case EXEC_IF: {
+            COperand condition = WriteExpression(tr, node->first);
+
+            Indent(tr);
+            fputs("if (", tr->out); WriteOperand(tr, condition); fputs(" != 0) {\n", tr->out);
+            WriteBody(tr, node->second);
+
+            if (node->third != -1) {
+                Indent(tr);
+                fputs("} else {\n", tr->out);
+                WriteBody(tr, node->third);
+            }
+
+            Indent(tr);
+            fputs("}\n", tr->out);
+            return;
+        }
+
+        case EXEC_WHILE: {
+            //* the condition may need temporaries, so it is checked inside of the loop
+            Indent(tr);
+            fputs("while (1) {\n", tr->out);
+            tr->depth++;
+
+            COperand condition = WriteExpression(tr, node->first);
+
+            Indent(tr);
+            fputs("if (", tr->out); WriteOperand(tr, condition); fputs(" == 0) break;\n", tr->out);
+
+            WriteStatement(tr, node->second);
+            tr->depth--;
+
+            Indent(tr);
+            fputs("}\n", tr->out);
+            return;
+        }
+
+        case EXEC_RETURN: {
+            COperand value = WriteExpression(tr, node->first);
+
+            Indent(tr);
+            fputs("return ", tr->out); WriteOperand(tr, value); fputs(";\n", tr->out);
+            return;
+        }
+
+        case EXEC_PRINT: {
+            COperand value = WriteExpression(tr, node->first);
+
+            Indent(tr);
+            fputs("lang_print(", tr->out); WriteOperand(tr, value); fputs(");\n", tr->out);
+            return;
+        }
+
+        case EXEC_SCAN:
+            Indent(tr);
+            fprintf(tr->out, "s%d = lang_scan();\n", node->value);
+            return;
+
+        case EXEC_NUMBER: case EXEC_LOCAL: case EXEC_BINARY: case EXEC_SQRT: case EXEC_CALL:
+        default: {
+            COperand value = WriteExpression(tr, index);
+
+            Indent(tr);
+            fputs("(void) ", tr->out); WriteOperand(tr, value); fputs(";\n", tr->out);
+            return;
+        }
+    }
+}
+
+//* ================================== functions =================================
+
+static void WritePrototype(Transpiler* tr, int index) {
+    ASSERT(tr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const ExecFunction* func = &tr->program->functions[index];
+
+    fprintf(tr->out, "static int f%d(", index);
+
+    if (func->params_count == 0) fputs("void", tr->out);
+    for (int i = 0; i < func->params_count; i++) fprintf(tr->out, "%sint s%d", i ? ", " : "", i);
+
+    fputs(")", tr->out);
+}
+
+static void WriteFunction(Transpiler* tr, int index) {
+    ASSERT(tr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const ExecFunction* func = &tr->program->functions[index];
+
+    fprintf(tr->out, "/* %s */\n", func->name);
+    WritePrototype(tr, index);
+    fputs(" {\n", tr->out);
+
+    tr->depth       = 1;
+    tr->temps_count = 0;
+
+    for (int slot = func->params_count; slot < func->slots_count; slot++) {
+        Indent(tr);
+        fprintf(tr->out, "int s%d = 0;\n", slot);
+    }
+
+    WriteStatement(tr, func->body);
+
+    //* falling off the end of the function returns 0
+    Indent(tr);
+    fputs("return 0;\n}\n\n", tr->out);
+}
+
+TranspileReturnCode TranspileToC(const ExecProgram* program, FILE* out) {
+    ASSERT(program != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(out     != NULL, "NULL POINTER WAS PASSED!\n");
+
+    Transpiler tr = {};
+    tr.program = program;
+    tr.out     = out;
+
+    WriteRuntime(out);
+
+    for (size_t i = 0; i < program->functions_count; i++) {
+        WritePrototype(&tr, int(i));
+        fputs(";\n", out);
+    }
+    fputs("\n", out);
+
+    for (size_t i = 0; i < program->functions_count; i++) WriteFunction(&tr, int(i));
+
+    fprintf(out, "int main(void) {\n"
+                 "    f%d();\n"
+                 "    return 0;\n"
+                 "}\n", program->entry);
+
+    return tr.error ? TRANSPILE_SEMANTIC_ERROR : TRANSPILE_SUCCESS;
+}
+
+TranspileReturnCode WriteC(const ExecProgram* program, const char* filename) {
+    ASSERT(program  != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(filename != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FILE* c_file = fopen(filename, "wb");
+    if (!c_file) {
+        fprintf(stderr, RED("Error occured while opening %s!\n"), filename);
+        return TRANSPILE_FILE_ERROR;
+    }
+
+    TranspileReturnCode status = TranspileToC(program, c_file);
+    fclose(c_file);
+
+    return status;
+}
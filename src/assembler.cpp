@@ -0,0 +1,530 @@
+/*!
+    \file
+    File with the assembler: the source is read once, mnemonics and labels are hashed,
+    jumps to the labels that are not defined yet are patched at the end
+
+    Syntax: one command per line, "; comment", "name:" defines the label,
+    push/pop take "5", "ax", "ax+5", "[5]", "[ax]" or "[ax+5]", jumps and call take a label or an address.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "assembler.h"
+#include "ReturnCodes.h"
+#include "SpuMethods.h"
+
+/// @brief Constant for the size of the mnemonics hash table (power of two)
+static const size_t ASM_MNEMONICS_TABLE_SIZE = 64;
+
+/// @brief Structure with the label, its name points into the source
+struct AsmLabel {
+    const char*    name;
+    size_t       length;
+    unsigned int   hash;
+    int         address; ///< -1 while the label is not defined
+    int            line; ///< line of the first use (for the error message)
+};
+
+/// @brief Structure with the operand word that waits for the label address
+struct AsmFixup {
+    size_t position;
+    size_t    label;
+};
+
+/// @brief Structure with the state of the assembler
+struct AsmState {
+    Bytecode*         bytecode;
+    AsmLabel*           labels;
+    size_t        labels_count;
+    size_t     labels_capacity;
+    size_t*              table; ///< open addressing: label index + 1, 0 - empty
+    size_t      table_capacity;
+    AsmFixup*           fixups;
+    size_t        fixups_count;
+    size_t     fixups_capacity;
+    int                   line;
+};
+
+/// @brief Structure with the mnemonic of the hash table
+struct AsmMnemonic {
+    const char*    name;
+    size_t       length;
+    int            code;
+};
+
+//* ================================== hashing =================================
+
+/// @brief FNV-1a, the mnemonics are hashed in lower case
+static unsigned int AsmHash(const char* str, size_t length, int fold_case) {
+    ASSERT(str != NULL, "NULL POINTER WAS PASSED!\n");
+
+    unsigned int hash = 2166136261u;
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char) str[i];
+        if (fold_case) c = (unsigned char) tolower(c);
+
+        hash = (hash ^ c) * 16777619u;
+    }
+
+    return hash;
+}
+
+static const AsmMnemonic* GetMnemonicsTable() {
+    static AsmMnemonic table[ASM_MNEMONICS_TABLE_SIZE] = {};
+    static int is_built = 0;
+
+    if (is_built) return table;
+
+    #define DEF_COMMAND_(name) {#name, sizeof(#name) - 1, name},
+    static const AsmMnemonic mnemonics[] = {
+        #include "commands.h"
+    };
+    #undef DEF_COMMAND_
+
+    for (size_t i = 0; i < sizeof(mnemonics) / sizeof(mnemonics[0]); i++) {
+        size_t slot = AsmHash(mnemonics[i].name, mnemonics[i].length, 1) & (ASM_MNEMONICS_TABLE_SIZE - 1);
+        while (table[slot].name) slot = (slot + 1) & (ASM_MNEMONICS_TABLE_SIZE - 1);
+
+        table[slot] = mnemonics[i];
+    }
+
+    is_built = 1;
+
+    return table;
+}
+
+int FromTextToCode(const char* name, size_t length) {
+    ASSERT(name != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const AsmMnemonic* table = GetMnemonicsTable();
+    size_t slot = AsmHash(name, length, 1) & (ASM_MNEMONICS_TABLE_SIZE - 1);
+
+    while (table[slot].name) {
+        if (table[slot].length == length && strncasecmp(table[slot].name, name, length) == 0) return table[slot].code;
+
+        slot = (slot + 1) & (ASM_MNEMONICS_TABLE_SIZE - 1);
+    }
+
+    return 0;
+}
+
+int GetRegValue(const char* name, size_t length) {
+    ASSERT(name != NULL, "NULL POINTER WAS PASSED!\n");
+
+    #define DEF_REGISTER_(reg) if (length == sizeof(#reg) - 1 && strncasecmp(name, #reg, length) == 0) return reg;
+    #include "registrs.h"
+    DEF_REGISTER_(XX)
+    #undef DEF_REGISTER_
+
+    return -1;
+}
+
+//* ================================== labels =================================
+
+static AsmReturnCode GrowTable(AsmState* as) {
+    ASSERT(as != NULL, "NULL POINTER WAS PASSED!\n");
+
+    size_t new_capacity = as->table_capacity ? as->table_capacity * 2 : 64;
+
+    size_t* new_table = (size_t*) calloc(new_capacity, sizeof(size_t));
+    if (!new_table) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return ASM_MEMORY_ERROR;
+    }
+
+    for (size_t i = 0; i < as->labels_count; i++) {
+        size_t slot = as->labels[i].hash & (new_capacity - 1);
+        while (new_table[slot]) slot = (slot + 1) & (new_capacity - 1);
+
+        new_table[slot] = i + 1;
+    }
+
+    FREE(as->table);
+    as->table          = new_table;
+    as->table_capacity = new_capacity;
+
+    return ASM_SUCCESS;
+}
+
+/*!
+    @brief Function that finds the label or adds the undefined one
+    \param [in]     as - pointer on the assembler
+    \param [in]   name - name of the label (points into the source)
+    \param [in] length - length of the name
+    @return The index of the label (-1 on memory error)
+*/
+static long FindLabel(AsmState* as, const char* name, size_t length) {
+    ASSERT(as   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(name != NULL, "NULL POINTER WAS PASSED!\n");
+
+    //* the table is kept at most half full
+    if (2 * (as->labels_count + 1) > as->table_capacity && GrowTable(as) != ASM_SUCCESS) return -1;
+
+    unsigned int hash = AsmHash(name, length, 0);
+    size_t slot = hash & (as->table_capacity - 1);
+
+    while (as->table[slot]) {
+        const AsmLabel* label = &as->labels[ as->table[slot] - 1 ];
+        if (label->hash == hash && label->length == length && strncmp(label->name, name, length) == 0) {
+            return (long) as->table[slot] - 1;
+        }
+
+        slot = (slot + 1) & (as->table_capacity - 1);
+    }
+
+    if (as->labels_count >= as->labels_capacity) {
+        size_t new_capacity = as->labels_capacity ? as->labels_capacity * 2 : 32;
+
+        AsmLabel* new_labels = (AsmLabel*) realloc(as->labels, new_capacity * sizeof(AsmLabel));
+        if (!new_labels) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return -1;
+        }
+
+        as->labels          = new_labels;
+        as->labels_capacity = new_capacity;
+    }
+
+    as->labels[as->labels_count] = {name, length, hash, -1, as->line};
+    as->table[slot] = ++as->labels_count;
+
+    return (long) as->labels_count - 1;
+}
+
+//* ================================== code =================================
+
+static AsmReturnCode EmitWord(AsmState* as, int word) {
+    ASSERT(as != NULL, "NULL POINTER WAS PASSED!\n");
+
+    Bytecode* bytecode = as->bytecode;
+
+    if (bytecode->size >= bytecode->capacity) {
+        size_t new_capacity = bytecode->capacity ? bytecode->capacity * 2 : 256;
+
+        int* new_code = (int*) realloc(bytecode->code, new_capacity * sizeof(int));
+        if (!new_code) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return ASM_MEMORY_ERROR;
+        }
+
+        bytecode->code     = new_code;
+        bytecode->capacity = new_capacity;
+    }
+
+    bytecode->code[bytecode->size++] = word;
+
+    return ASM_SUCCESS;
+}
+
+/// @brief Emits the address of the label: the defined label is written at once, others get a fixup
+static AsmReturnCode EmitLabelAddress(AsmState* as, const char* name, size_t length) {
+    ASSERT(as   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(name != NULL, "NULL POINTER WAS PASSED!\n");
+
+    long label = FindLabel(as, name, length);
+    if (label == -1) return ASM_MEMORY_ERROR;
+
+    if (as->labels[label].address != -1) return EmitWord(as, as->labels[label].address);
+
+    if (as->fixups_count >= as->fixups_capacity) {
+        size_t new_capacity = as->fixups_capacity ? as->fixups_capacity * 2 : 64;
+
+        AsmFixup* new_fixups = (AsmFixup*) realloc(as->fixups, new_capacity * sizeof(AsmFixup));
+        if (!new_fixups) {
+            fprintf(stderr, RED("MEMORY ERROR!\n"));
+            return ASM_MEMORY_ERROR;
+        }
+
+        as->fixups          = new_fixups;
+        as->fixups_capacity = new_capacity;
+    }
+
+    as->fixups[as->fixups_count++] = {as->bytecode->size, (size_t) label};
+
+    return EmitWord(as, -1);
+}
+
+//* ================================== parsing =================================
+
+static int IsTokenEnd(char c) {
+    return c == '\0' || c == ';' || isspace((unsigned char) c);
+}
+
+static const char* SkipSpaces(const char* ptr, const char* end) {
+    while (ptr < end && *ptr != '\n' && isspace((unsigned char) *ptr)) ptr++;
+
+    return ptr;
+}
+
+static AsmReturnCode SyntaxError(const AsmState* as, const char* message, const char* token, size_t length) {
+    ASSERT(as != NULL, "NULL POINTER WAS PASSED!\n");
+
+    fprintf(stderr, RED("Line %d: %s \"%.*s\"!\n"), as->line, message, (int) length, token);
+
+    return ASM_SYNTAX_ERROR;
+}
+
+/// @brief Reads the integer, returns the pointer after it or NULL
+static const char* ReadNumber(const char* ptr, const char* end, int* value) {
+    ASSERT(ptr   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(value != NULL, "NULL POINTER WAS PASSED!\n");
+
+    int sign = 1;
+    if (ptr < end && (*ptr == '-' || *ptr == '+')) sign = (*ptr++ == '-') ? -1 : 1;
+
+    if (ptr >= end || !isdigit((unsigned char) *ptr)) return NULL;
+
+    long number = 0;
+    while (ptr < end && isdigit((unsigned char) *ptr)) {
+        number = number * 10 + (*ptr++ - '0');
+        if (number > 2147483647L) return NULL;
+    }
+
+    *value = (int) (sign * number);
+
+    return ptr;
+}
+
+/*!
+    @brief Function that that generates arguments for Push and Pop: "5", "ax", "ax+5", "5+ax" and the same in []
+    \param [in]     as - pointer on the assembler
+    \param [in]    arg - argument
+    \param [in] length - length of the argument
+    \param [in] is_pop - 1 for POP (the constant alone can not be written)
+    @return The status of the function (return code)
+*/
+static AsmReturnCode PushPopFill(AsmState* as, const char* arg, size_t length, int is_pop) {
+    ASSERT(as  != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(arg != NULL, "NULL POINTER WAS PASSED!\n");
+
+    const char* ptr = arg;
+    const char* end = arg + length;
+    int arg_type = 0;
+
+    if (ptr < end && *ptr == '[') {
+        if (end - ptr < 2 || end[-1] != ']') return SyntaxError(as, "bad memory argument", arg, length);
+
+        arg_type |= MEMORY_BIT;
+        ptr++;
+        end--;
+    }
+
+    int reg = -1;
+    int constant = 0;
+
+    while (ptr < end) {
+        ptr = SkipSpaces(ptr, end);
+
+        const char* part = ptr;
+        while (ptr < end && *ptr != '+' && !(*ptr == '-' && ptr != part) && !isspace((unsigned char) *ptr)) ptr++;
+
+        if (isalpha((unsigned char) *part)) {
+            reg = GetRegValue(part, size_t(ptr - part));
+            if (reg == -1 || (arg_type & REG_BIT)) return SyntaxError(as, "bad register", part, size_t(ptr - part));
+
+            arg_type |= REG_BIT;
+        } else {
+            int value = 0;
+            if (ReadNumber(part, ptr, &value) != ptr || (arg_type & CONSTANT_BIT)) {
+                return SyntaxError(as, "bad number", part, size_t(ptr - part));
+            }
+
+            constant = value;
+            arg_type |= CONSTANT_BIT;
+        }
+
+        //* "ax-5" is "ax" and "-5", "ax+5" is "ax" and "5"
+        ptr = SkipSpaces(ptr, end);
+        if (ptr < end && *ptr == '+') ptr++;
+    }
+
+    if (!(arg_type & (REG_BIT | CONSTANT_BIT))) return SyntaxError(as, "empty argument", arg, length);
+    if (is_pop && arg_type == CONSTANT_BIT)     return SyntaxError(as, "pop to the number", arg, length);
+
+    AsmReturnCode result = EmitWord(as, arg_type);
+    if (result == ASM_SUCCESS && (arg_type & REG_BIT))      result = EmitWord(as, reg);
+    if (result == ASM_SUCCESS && (arg_type & CONSTANT_BIT)) result = EmitWord(as, constant);
+
+    return result;
+}
+
+static int HasLabelArgument(int code) {
+    return code == JMP || code == JNE || code == JE || code == JGE || code == JLZ || code == JGZ ||
+           code == JEP || code == JNEP || code == JGEP || code == CALL;
+}
+
+/// @brief Assembles one line (without the end of line), the label and the command can share the line
+static AsmReturnCode AssembleLine(AsmState* as, const char* ptr, const char* end) {
+    ASSERT(as  != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(ptr != NULL, "NULL POINTER WAS PASSED!\n");
+
+    ptr = SkipSpaces(ptr, end);
+
+    const char* token = ptr;
+    while (ptr < end && !IsTokenEnd(*ptr)) ptr++;
+    size_t length = size_t(ptr - token);
+
+    if (length == 0) return ASM_SUCCESS;
+
+    if (token[length - 1] == ':') {
+        long label = FindLabel(as, token, length - 1);
+        if (label == -1) return ASM_MEMORY_ERROR;
+
+        if (length == 1 || as->labels[label].address != -1) return SyntaxError(as, "bad label", token, length);
+        as->labels[label].address = (int) as->bytecode->size;
+
+        return AssembleLine(as, ptr, end);
+    }
+
+    int code = FromTextToCode(token, length);
+    if (code == 0) return SyntaxError(as, "unknown command", token, length);
+
+    AsmReturnCode result = EmitWord(as, code);
+    if (result != ASM_SUCCESS) return result;
+
+    //* the argument is the rest of the line, it is parsed in place
+    const char* arg = SkipSpaces(ptr, end);
+    const char* arg_end = end;
+    while (arg_end > arg && isspace((unsigned char) arg_end[-1])) arg_end--;
+
+    size_t arg_length = size_t(arg_end - arg);
+
+    if (code == PUSH || code == POP) return PushPopFill(as, arg, arg_length, code == POP);
+
+    if (HasLabelArgument(code)) {
+        if (arg_length == 0) return SyntaxError(as, "no label for", token, length);
+
+        int address = 0;
+        if (ReadNumber(arg, arg_end, &address) == arg_end) return EmitWord(as, address);
+
+        //* "jmp name:" and "jmp :name" are accepted too
+        if (arg_end[-1] == ':') arg_end--;
+        if (arg < arg_end && arg[0] == ':') arg++;
+
+        for (const char* c = arg; c < arg_end; c++) {
+            if (isspace((unsigned char) *c)) return SyntaxError(as, "bad label", arg, arg_length);
+        }
+
+        if (arg == arg_end) return SyntaxError(as, "bad label", token, length);
+
+        return EmitLabelAddress(as, arg, size_t(arg_end - arg));
+    }
+
+    if (arg_length != 0) return SyntaxError(as, "unexpected argument", arg, arg_length);
+
+    return ASM_SUCCESS;
+}
+
+static AsmReturnCode ResolveFixups(AsmState* as) {
+    ASSERT(as != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (size_t i = 0; i < as->fixups_count; i++) {
+        const AsmLabel* label = &as->labels[ as->fixups[i].label ];
+
+        if (label->address == -1) {
+            fprintf(stderr, RED("Line %d: label \"%.*s\" is not defined!\n"), label->line, (int) label->length, label->name);
+            return ASM_LABEL_ERROR;
+        }
+
+        as->bytecode->code[ as->fixups[i].position ] = label->address;
+    }
+
+    return ASM_SUCCESS;
+}
+
+/// @brief Labels become the symbols of the executable
+static AsmReturnCode FillSymbols(AsmState* as) {
+    ASSERT(as != NULL, "NULL POINTER WAS PASSED!\n");
+
+    Bytecode* bytecode = as->bytecode;
+    if (as->labels_count == 0) return ASM_SUCCESS;
+
+    bytecode->symbols = (SpuExeSymbol*) calloc(as->labels_count, sizeof(SpuExeSymbol));
+    if (!bytecode->symbols) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return ASM_MEMORY_ERROR;
+    }
+
+    for (size_t i = 0; i < as->labels_count; i++) {
+        const AsmLabel* label = &as->labels[i];
+        size_t length = label->length < SPU_EXE_NAME_LEN ? label->length : SPU_EXE_NAME_LEN - 1;
+
+        bytecode->symbols[i].address = label->address;
+        memcpy(bytecode->symbols[i].name, label->name, length);
+    }
+
+    bytecode->symbols_count = as->labels_count;
+
+    return ASM_SUCCESS;
+}
+
+AsmReturnCode Assemble(const char* source, size_t source_size, Bytecode* bytecode) {
+    ASSERT(source   != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(bytecode != NULL, "NULL POINTER WAS PASSED!\n");
+
+    AsmState as = {};
+    as.bytecode = bytecode;
+
+    AsmReturnCode result = ASM_SUCCESS;
+    const char* end = source + source_size;
+
+    for (const char* line = source; line < end && result == ASM_SUCCESS; ) {
+        const char* line_end = (const char*) memchr(line, '\n', size_t(end - line));
+        if (!line_end) line_end = end;
+
+        as.line++;
+
+        const char* comment = (const char*) memchr(line, ';', size_t(line_end - line));
+        result = AssembleLine(&as, line, comment ? comment : line_end);
+
+        line = line_end + 1;
+    }
+
+    if (result == ASM_SUCCESS) result = ResolveFixups(&as);
+    if (result == ASM_SUCCESS) result = FillSymbols(&as);
+
+    FREE(as.labels);
+    FREE(as.table);
+    FREE(as.fixups);
+
+    return result;
+}
+
+AsmReturnCode Assembler(const char* input_filename, Bytecode* bytecode) {
+    ASSERT(input_filename != NULL, "NULL POINTER WAS PASSED!\n");
+    ASSERT(bytecode       != NULL, "NULL POINTER WAS PASSED!\n");
+
+    FILE* input_file = fopen(input_filename, "rb");
+    if (!input_file) {
+        fprintf(stderr, RED("Error occured while opening %s!\n"), input_filename);
+        return ASM_FILE_ERROR;
+    }
+
+    fseek(input_file, 0, SEEK_END);
+    long file_size = ftell(input_file);
+    fseek(input_file, 0, SEEK_SET);
+
+    if (file_size < 0) {
+        fclose(input_file);
+        return ASM_FILE_ERROR;
+    }
+
+    char* source = (char*) calloc((size_t) file_size + 1, sizeof(char));
+    if (!source) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        fclose(input_file);
+        return ASM_MEMORY_ERROR;
+    }
+
+    size_t source_size = fread(source, sizeof(char), (size_t) file_size, input_file);
+    fclose(input_file);
+
+    AsmReturnCode result = Assemble(source, source_size, bytecode);
+    FREE(source);
+
+    return result;
+}
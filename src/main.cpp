@@ -1,17 +1,231 @@
 #include <stdio.h>
+#include <strings.h>
 #include <time.h>
 
 #include "Tools.h"
 #include "BinaryTree.h"
 #include "Frontend.h"
 #include "TreeDump.h"
+#include "IR.h"
+#include "RegAlloc.h"
+#include "CodeGen.h"
+#include "Peephole.h"
+#include "Interpreter.h"
+#include "Transpiler.h"
+#include "Executable.h"
+#include "SpuPool.h"
+#include "SpuScheduler.h"
+#include "SpuTrace.h"
+#include "assembler.h"
 
 
 const char* INPUT_FILENAME = "../Language/Programs/square_solver.red";
 
-int main() {
+/// @brief Flag of the run without code generation (-i)
+static int RUN_INTERPRETER = 0;
+
+/// @brief Name of the C file for the native build (-c), the program is not run then
+static const char* OUTPUT_C_FILENAME = NULL;
+
+/// @brief Name of the SPU executable to write (-o), the program is not run then
+static const char* OUTPUT_EXE_FILENAME = NULL;
+
+/// @brief Name of the SPU executable to run without the front end (-x)
+static const char* RUN_EXE_FILENAME = NULL;
+
+/// @brief Name of the SPU assembler source to assemble and run (or write with -o) without the front end (-a)
+static const char* ASSEMBLER_FILENAME = NULL;
+
+/// @brief Flag of the JIT, -nojit runs the bytecode by CPUWork
+static int USE_JIT = 1;
+
+/// @brief Flag of the peephole optimizer, -nopeep keeps the bytecode of the code generator
+static int USE_PEEPHOLE = 1;
+
+/// @brief Parameters of the SPU: -ram words, -width and -height of the DRAW picture, -hugepages,
+///        -rawio for the non-interactive I/O (bulk input, buffered plain output)
+static SpuConfig SPU_CONFIG = {};
+
+/// @brief Name of the file with the input filenames (-batch): the program is run for every input on the pool of SPUs
+static const char* BATCH_FILENAME = NULL;
+
+/// @brief Count of the threads of the pool (-threads, 0 is the count of the processors)
+static size_t THREADS_COUNT = 0;
+
+/// @brief Flag of the green threads (-green): the batch is run by the cooperative schedulers instead of the pool
+static int USE_GREEN = 0;
+
+/// @brief Budget of the green thread in runs (-budget, 0 is the default of the scheduler)
+static long GREEN_BUDGET = 0;
+
+/// @brief Name of the trace file (-trace) that is printed with the symbols of the program, the program is not run then
+///        (it must be built with the same options as the traced one)
+static const char* TRACE_FILENAME = NULL;
+
+/*!
+    @brief Function that get arguments from the command line
+    \param [in] argc - argument count
+    \param [in] argv - argument values
+*/
+static void GetProgramArgs(int argc, char* argv[]) {
+    ASSERT(argv != NULL, "NULL POINTER WAS PASSED!\n");
+
+    for (int i = 1; i < argc; i++) {
+        if (strcasecmp(argv[i], "-f") == 0) {
+            if (i != argc - 1)
+                INPUT_FILENAME = argv[i + 1];
+        }
+
+        if (strcasecmp(argv[i], "-i") == 0) RUN_INTERPRETER = 1;
+
+        if (strcasecmp(argv[i], "-nojit") == 0) USE_JIT = 0;
+
+        if (strcasecmp(argv[i], "-nopeep") == 0) USE_PEEPHOLE = 0;
+
+        if (strcasecmp(argv[i], "-c") == 0) {
+            if (i != argc - 1)
+                OUTPUT_C_FILENAME = argv[i + 1];
+        }
+
+        if (strcasecmp(argv[i], "-o") == 0) {
+            if (i != argc - 1)
+                OUTPUT_EXE_FILENAME = argv[i + 1];
+        }
+
+        if (strcasecmp(argv[i], "-a") == 0) {
+            if (i != argc - 1)
+                ASSEMBLER_FILENAME = argv[i + 1];
+        }
+
+        if (strcasecmp(argv[i], "-x") == 0) {
+            if (i != argc - 1)
+                RUN_EXE_FILENAME = argv[i + 1];
+        }
+
+        if (strcasecmp(argv[i], "-ram") == 0) {
+            if (i != argc - 1)
+                SPU_CONFIG.ram_size = strtoul(argv[i + 1], NULL, 10);
+        }
+
+        if (strcasecmp(argv[i], "-width") == 0) {
+            if (i != argc - 1)
+                SPU_CONFIG.draw_width = strtoul(argv[i + 1], NULL, 10);
+        }
+
+        if (strcasecmp(argv[i], "-height") == 0) {
+            if (i != argc - 1)
+                SPU_CONFIG.draw_height = strtoul(argv[i + 1], NULL, 10);
+        }
+
+        if (strcasecmp(argv[i], "-hugepages") == 0) SPU_CONFIG.huge_pages = 1;
+
+        if (strcasecmp(argv[i], "-rawio") == 0) SPU_CONFIG.raw_io = 1;
+
+        if (strcasecmp(argv[i], "-batch") == 0) {
+            if (i != argc - 1)
+                BATCH_FILENAME = argv[i + 1];
+        }
+
+        if (strcasecmp(argv[i], "-threads") == 0) {
+            if (i != argc - 1)
+                THREADS_COUNT = strtoul(argv[i + 1], NULL, 10);
+        }
+
+        if (strcasecmp(argv[i], "-green") == 0)
+            USE_GREEN = 1;
+
+        if (strcasecmp(argv[i], "-budget") == 0) {
+            if (i != argc - 1)
+                GREEN_BUDGET = strtol(argv[i + 1], NULL, 10);
+        }
+
+        if (strcasecmp(argv[i], "-trace") == 0) {
+            if (i != argc - 1)
+                TRACE_FILENAME = argv[i + 1];
+        }
+    }
+}
+
+/*!
+    @brief Function that runs the code for every input of the batch on the pool of SPUs
+    \param [in]      code - commands
+    \param [in] code_size - count of the words in code
+    \param [in]     entry - address of the first command
+    \param [in]      data - initial RAM (can be NULL if data_size is 0)
+    \param [in] data_size - count of the words in data
+    \param [in]    config - memory parameters of the SPUs
+    @return 1 if every input of the batch is run (0 if the batch or some input can not be read)
+*/
+static int RunBatch(const int* code, size_t code_size, int entry, const int* data, size_t data_size,
+                    const SpuConfig* config) {
+    SpuImage image = {};
+    int is_run = 0;
+
+    if (SpuImageInit(&image, code, code_size, entry, data, data_size, config) == SPU_POOL_SUCCESS) {
+        if (USE_GREEN) is_run = SpuSchedulerRunList(&image, BATCH_FILENAME, GREEN_BUDGET, THREADS_COUNT) == SPU_SCHED_SUCCESS;
+        else           is_run = SpuPoolRunList(&image, BATCH_FILENAME, THREADS_COUNT) == SPU_POOL_SUCCESS;
+    }
+
+    SpuImageDtor(&image);
+
+    return is_run;
+}
+
+/*!
+    @brief Function that prints the trace file with the symbols and the lines of the bytecode
+    \param [in] bytecode - pointer on the bytecode
+*/
+static void ViewTrace(const Bytecode* bytecode) {
+    ASSERT(bytecode != NULL, "NULL POINTER WAS PASSED!\n");
+
+    SpuDebugInfo debug_info = {bytecode->symbols, bytecode->symbols_count, bytecode->lines, bytecode->lines_count};
+    SpuTraceView(TRACE_FILENAME, &debug_info, stdout);
+}
+
+int main(int argc, char* argv[]) {
     srand((unsigned int)time(NULL));
 
+    GetProgramArgs(argc, argv);
+
+    int is_batch_run = 1;
+
+    if (RUN_EXE_FILENAME) {
+        SpuExe exe = {};
+        if (LoadSpuExe(RUN_EXE_FILENAME, &exe) != SPU_EXE_SUCCESS) return 1;
+
+        if (TRACE_FILENAME) {
+            SpuDebugInfo debug_info = {exe.symbols, exe.header->symbols_count, NULL, 0};
+            SpuTraceView(TRACE_FILENAME, &debug_info, stdout);
+        } else if (BATCH_FILENAME) {
+            SpuConfig config = SPU_CONFIG;
+            if (!config.ram_size) config.ram_size = exe.header->ram_size;
+
+            is_batch_run = RunBatch(exe.code, exe.header->code_size, (int) exe.header->entry, exe.data,
+                                    exe.header->data_size, &config);
+        } else {
+            RunSpuExe(&exe, USE_JIT, &SPU_CONFIG);
+        }
+        SpuExeDtor(&exe);
+
+        return is_batch_run ? 0 : 1;
+    }
+
+    if (ASSEMBLER_FILENAME) {
+        Bytecode bytecode = {};
+        AsmReturnCode result = Assembler(ASSEMBLER_FILENAME, &bytecode);
+
+        if (result == ASM_SUCCESS) {
+            if      (OUTPUT_EXE_FILENAME) WriteBytecode(&bytecode, OUTPUT_EXE_FILENAME, SPU_CONFIG.ram_size);
+            else if (TRACE_FILENAME)      ViewTrace(&bytecode);
+            else if (BATCH_FILENAME)      is_batch_run = RunBatch(bytecode.code, bytecode.size, 0, NULL, 0, &SPU_CONFIG);
+            else                          RunBytecode(&bytecode, USE_JIT, &SPU_CONFIG);
+        }
+
+        BytecodeDtor(&bytecode);
+
+        return (result == ASM_SUCCESS && is_batch_run) ? 0 : 1;
+    }
+
     Text* program_text = ReadTextFromProgramFile(INPUT_FILENAME);
 
     Tokens* tokens = GetLexerTokens(program_text);
@@ -33,8 +247,50 @@ int main() {
 
     TREE_DUMP(ast, "End: %s", __func__);
 
+    if (OUTPUT_C_FILENAME) {
+        ExecProgram* program = InterpBuild(ast);
+        if (program) WriteC(program, OUTPUT_C_FILENAME);
+
+        InterpDtor(program);
+    } else if (RUN_INTERPRETER) {
+        ExecProgram* program = InterpBuild(ast);
+        if (program) InterpRun(program);
+
+        InterpDtor(program);
+    }
+
+    IRModule* ir = (RUN_INTERPRETER || OUTPUT_C_FILENAME) ? NULL : IRBuild(ast);
+    if (ir) {
+        IROptimize(ir);
+#ifdef DEBUG
+        WriteIR(ir);
+#endif
+
+        RegAllocation** allocs = RegAllocModule(ir);
+        if (allocs) {
+#ifdef DEBUG
+            WriteRegAlloc(ir, allocs);
+#endif
+
+            Bytecode bytecode = {};
+            if (CodeGenModule(ir, allocs, &bytecode) == CODEGEN_SUCCESS) {
+                if (USE_PEEPHOLE) PeepholeBytecode(&bytecode);
+
+                if      (OUTPUT_EXE_FILENAME) WriteBytecode(&bytecode, OUTPUT_EXE_FILENAME, SPU_CONFIG.ram_size);
+                else if (TRACE_FILENAME)      ViewTrace(&bytecode);
+                else if (BATCH_FILENAME)      is_batch_run = RunBatch(bytecode.code, bytecode.size, 0, NULL, 0, &SPU_CONFIG);
+                else                          RunBytecode(&bytecode, USE_JIT, &SPU_CONFIG);
+            }
+
+            BytecodeDtor(&bytecode);
+            RegAllocModuleDtor(allocs, ir->functions_count);
+        }
+
+        IRModuleDtor(ir);
+    }
+
     TreeDtor(ast);
     TokensDtor(tokens);
 
-    return 0;
+    return is_batch_run ? 0 : 1;
 }
\ No newline at end of file
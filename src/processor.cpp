@@ -10,24 +10,13 @@
 
 #include "Tools.h"
 #include "ReturnCodes.h"
-#include "StackMethods.h"
 #include "Stack.h"
 #include "Config.h"
 #include "SpuMethods.h"
+#include "SpuProfile.h"
+#include "SpuTrace.h"
 #include "processor.h"
 
-/// @brief Constant for the register bit
-const int REG_BIT      = 1;
-
-/// @brief Constant for the memory bit
-const int MEMORY_BIT   = 4;
-
-/// @brief Constant for the constant bit
-const int CONSTANT_BIT = 2;
-
-/// @brief Constant for calculation accuracy
-const int CALC_ACCURACY = 2;
-
 /*!
     @brief Function that get arguments from the command line
     \param [in] argc - argument count
@@ -44,35 +33,620 @@ void GetCommandsArgs(int argc,  char* argv[]) {
     }
 }
 
+/*!
+    @brief Function that reads the word of the code (the words out of the code are zeros)
+    \param [in] spu - the pointer on the spu struct
+    \param [in]  ip - address of the word
+*/
+static int FetchCmd(const SPU* spu, int ip) {
+    return ((size_t) ip < spu->cmds_size) ? spu->cmds[ip] : 0;
+}
+
 /*!
     @brief Function that get argument for the processor commands
     \param [in] spu - the pointer on the spu struct
+    @return The pointer on the argument (NULL if the address is out of RAM or there is no argument, it is printed)
 */
 int* GetArg (SPU* spu) {
     assert(spu != NULL);
 
-    int arg_type  = (spu->cmds)[++(spu->ip)];
+    int arg_type  = FetchCmd(spu, ++(spu->ip));
     int* arg_value = NULL;
 
     if (arg_type & REG_BIT) {
-        arg_value = &(spu->regs[ (spu->cmds)[++(spu->ip)] ]);
+        int reg = FetchCmd(spu, ++(spu->ip));
+        if (reg < 0 || reg >= (int) REGS_SIZE) {
+            fprintf(SpuMessageStream(spu), RED("WRONG ARGUMENT!\n"));
+            return NULL;
+        }
+        arg_value = &(spu->regs[reg]);
     }
 
     if (arg_type & CONSTANT_BIT) {
         if (arg_value != NULL) {
-            spu->regs[XX] = *arg_value + (spu->cmds)[++(spu->ip)];
+            spu->regs[XX] = *arg_value + FetchCmd(spu, ++(spu->ip));
         } else {
-            spu->regs[XX] = (spu->cmds)[++(spu->ip)];
+            spu->regs[XX] = FetchCmd(spu, ++(spu->ip));
         }
         arg_value = &spu->regs[XX];
     }
 
     if (arg_type & MEMORY_BIT) {
+        if (arg_value == NULL || (size_t) *arg_value >= spu->ram_size) {
+            fprintf(SpuMessageStream(spu), RED("RAM ACCESS ERROR!\n"));
+            return NULL;
+        }
         arg_value = &spu->ram[*arg_value];
     }
+
+    if (arg_value == NULL) fprintf(SpuMessageStream(spu), RED("WRONG ARGUMENT!\n"));
+
     return arg_value;
 }
 
+//* ================================== decoding =================================
+
+/// @brief Decodes PUSH or POP, the operand modes that GetArg would not handle safely stay generic (PUSH_ARG, POP_ARG)
+static SpuInstr DecodeOperand(const SPU* spu, int ip, int is_pop) {
+    assert(spu != NULL);
+
+    SpuInstr instr = {is_pop ? SPU_OP_POP_ARG : SPU_OP_PUSH_ARG, 1, 0, 0};
+
+    int arg_type = FetchCmd(spu, ip + 1);
+    int length   = 2;
+    int reg      = 0;
+
+    if (arg_type & REG_BIT) {
+        reg = FetchCmd(spu, ip + length++);
+        if (reg < 0 || reg >= (int) REGS_SIZE) return instr;
+    }
+
+    int value = (arg_type & CONSTANT_BIT) ? FetchCmd(spu, ip + length++) : 0;
+
+    //* the constant address is checked here once, out of RAM it is left to GetArg that reports it
+    if (arg_type == (MEMORY_BIT | CONSTANT_BIT) && (size_t) value >= spu->ram_size) return instr;
+
+    SpuOp op = SPU_OP_UNKNOWN;
+    switch (arg_type) {
+        case REG_BIT:                             op = is_pop ? SPU_OP_POP_REG           : SPU_OP_PUSH_REG;           break;
+        case CONSTANT_BIT:                        op = is_pop ? SPU_OP_POP_XX            : SPU_OP_PUSH_CONST;         break;
+        case REG_BIT | CONSTANT_BIT:              op = is_pop ? SPU_OP_POP_XX            : SPU_OP_PUSH_REG_CONST;     break;
+        case MEMORY_BIT | REG_BIT:                op = is_pop ? SPU_OP_POP_MEM_REG       : SPU_OP_PUSH_MEM_REG;       break;
+        case MEMORY_BIT | CONSTANT_BIT:           op = is_pop ? SPU_OP_POP_MEM_CONST     : SPU_OP_PUSH_MEM_CONST;     break;
+        case MEMORY_BIT | REG_BIT | CONSTANT_BIT: op = is_pop ? SPU_OP_POP_MEM_REG_CONST : SPU_OP_PUSH_MEM_REG_CONST; break;
+        default:                                  return instr;
+    }
+
+    return {op, length, reg, value};
+}
+
+static SpuInstr DecodeCmd(const SPU* spu, int ip) {
+    assert(spu != NULL);
+
+    int target = FetchCmd(spu, ip + 1);
+
+    switch (FetchCmd(spu, ip)) {
+        case PUSH: return DecodeOperand(spu, ip, 0);
+        case POP:  return DecodeOperand(spu, ip, 1);
+        case HLT:  return {SPU_OP_HLT,  1, 0, 0};
+        case ADD:  return {SPU_OP_ADD,  1, 0, 0};
+        case SUB:  return {SPU_OP_SUB,  1, 0, 0};
+        case DIV:  return {SPU_OP_DIV,  1, 0, 0};
+        case MUL:  return {SPU_OP_MUL,  1, 0, 0};
+        case IN:   return {SPU_OP_IN,   1, 0, 0};
+        case OUT:  return {SPU_OP_OUT,  1, 0, 0};
+        case RET:  return {SPU_OP_RET,  1, 0, 0};
+        case SQRT: return {SPU_OP_SQRT, 1, 0, 0};
+        case SQR:  return {SPU_OP_SQR,  1, 0, 0};
+        case MOD:  return {SPU_OP_MOD,  1, 0, 0};
+        case IDIV: return {SPU_OP_IDIV, 1, 0, 0};
+        case DRAW: return {SPU_OP_DRAW, 1, 0, 0};
+        case JMP:  return {SPU_OP_JMP,  2, 0, 0, target};
+        case CALL: return {SPU_OP_CALL, 2, 0, 0, target};
+        case JNE:  return {SPU_OP_JNE,  2, 0, 0, target};
+        case JGE:  return {SPU_OP_JGE,  2, 0, 0, target};
+        case JE:   return {SPU_OP_JE,   2, 0, 0, target};
+        case JLZ:  return {SPU_OP_JLZ,  2, 0, 0, target};
+        case JGZ:  return {SPU_OP_JGZ,  2, 0, 0, target};
+        case JEP:  return {SPU_OP_JEP,  2, 0, 0, target};
+        case JNEP: return {SPU_OP_JNEP, 2, 0, 0, target};
+        case JGEP: return {SPU_OP_JGEP, 2, 0, 0, target};
+        default:   return {SPU_OP_UNKNOWN, 1, 0, 0};
+    }
+}
+
+/// @brief Structure with the stack effect of the decoded command
+struct SpuEffect {
+    int  need; ///< elements popped before anything is pushed
+    int delta;
+};
+
+static SpuEffect GetEffect(SpuOp op) {
+    switch (op) {
+        case SPU_OP_PUSH_REG: case SPU_OP_PUSH_CONST: case SPU_OP_PUSH_REG_CONST: case SPU_OP_PUSH_MEM_REG:
+        case SPU_OP_PUSH_MEM_CONST: case SPU_OP_PUSH_MEM_REG_CONST: case SPU_OP_PUSH_ARG: case SPU_OP_IN:
+        case SPU_OP_ADD_REG_CONST: case SPU_OP_SUB_REG_CONST: case SPU_OP_MUL_REG_CONST: case SPU_OP_ADD_REG_REG:
+        case SPU_OP_SUB_REG_REG: case SPU_OP_MUL_REG_REG:
+            return {0, 1};
+
+        case SPU_OP_PUSH_REG_REG:
+            return {0, 2};
+
+        case SPU_OP_POP_PUSH_REG:
+            return {1, 0};
+
+        case SPU_OP_JEP_REG: case SPU_OP_JNEP_REG: case SPU_OP_JGEP_REG: case SPU_OP_JEP_CONST:
+        case SPU_OP_JNEP_CONST: case SPU_OP_JGEP_CONST:
+            return {1, -1};
+
+        case SPU_OP_POP_REG: case SPU_OP_POP_XX: case SPU_OP_POP_MEM_REG: case SPU_OP_POP_MEM_CONST:
+        case SPU_OP_POP_MEM_REG_CONST: case SPU_OP_POP_ARG: case SPU_OP_OUT:
+            return {1, -1};
+
+        case SPU_OP_ADD: case SPU_OP_SUB: case SPU_OP_DIV: case SPU_OP_MUL: case SPU_OP_MOD: case SPU_OP_IDIV:
+            return {2, -1};
+
+        case SPU_OP_SQRT: case SPU_OP_SQR: case SPU_OP_JLZ: case SPU_OP_JGZ:
+            return {1, 0};
+
+        case SPU_OP_JNE: case SPU_OP_JGE: case SPU_OP_JE:
+            return {2, 0};
+
+        case SPU_OP_JEP: case SPU_OP_JNEP: case SPU_OP_JGEP:
+            return {2, -2};
+
+        case SPU_OP_UNKNOWN: case SPU_OP_HLT: case SPU_OP_JMP: case SPU_OP_CALL: case SPU_OP_RET: case SPU_OP_DRAW:
+        default:
+            return {0, 0};
+    }
+}
+
+/*!
+    @brief Function that tells if the command ends the run: the next command is not the following word
+           (or GetArg decides it)
+    \param [in] op - the decoded command
+    @return 1 if the command ends the run
+*/
+int SpuIsRunEnd(SpuOp op) {
+    switch (op) {
+        case SPU_OP_UNKNOWN: case SPU_OP_HLT: case SPU_OP_JMP: case SPU_OP_CALL: case SPU_OP_RET: case SPU_OP_JNE:
+        case SPU_OP_JGE: case SPU_OP_JE: case SPU_OP_JLZ: case SPU_OP_JGZ: case SPU_OP_JEP: case SPU_OP_JNEP:
+        case SPU_OP_JGEP: case SPU_OP_PUSH_ARG: case SPU_OP_POP_ARG: case SPU_OP_JEP_REG: case SPU_OP_JNEP_REG:
+        case SPU_OP_JGEP_REG: case SPU_OP_JEP_CONST: case SPU_OP_JNEP_CONST: case SPU_OP_JGEP_CONST:
+            return 1;
+
+        case SPU_OP_PUSH_REG: case SPU_OP_PUSH_CONST: case SPU_OP_PUSH_REG_CONST: case SPU_OP_PUSH_MEM_REG:
+        case SPU_OP_PUSH_MEM_CONST: case SPU_OP_PUSH_MEM_REG_CONST: case SPU_OP_POP_REG: case SPU_OP_POP_XX:
+        case SPU_OP_POP_MEM_REG: case SPU_OP_POP_MEM_CONST: case SPU_OP_POP_MEM_REG_CONST: case SPU_OP_ADD:
+        case SPU_OP_SUB: case SPU_OP_DIV: case SPU_OP_MUL: case SPU_OP_IN: case SPU_OP_OUT: case SPU_OP_SQRT:
+        case SPU_OP_SQR: case SPU_OP_MOD: case SPU_OP_IDIV: case SPU_OP_DRAW: case SPU_OP_POP_PUSH_REG:
+        case SPU_OP_PUSH_REG_REG: case SPU_OP_ADD_REG_CONST: case SPU_OP_SUB_REG_CONST: case SPU_OP_MUL_REG_CONST:
+        case SPU_OP_ADD_REG_REG: case SPU_OP_SUB_REG_REG: case SPU_OP_MUL_REG_REG:
+        default:
+            return 0;
+    }
+}
+
+//* ================================== superinstructions =================================
+//* the sequences are taken from the SEQUENCES section of the profile of the compiled programs: the build with
+//* SPU_FLAGS="-DSPU_PROFILE -DSPU_NO_SUPERINSTRUCTIONS" counts the single commands, the top pairs and triples
+//* are fused here (POP r; PUSH r is the top one in the loops); only the command at the first address is replaced,
+//* a jump into the sequence runs the single commands
+
+#ifndef SPU_NO_SUPERINSTRUCTIONS
+
+static SpuOp FuseArithmetic(SpuOp push, SpuOp operation) {
+    int is_const = push == SPU_OP_PUSH_CONST;
+
+    if (operation == SPU_OP_ADD) return is_const ? SPU_OP_ADD_REG_CONST : SPU_OP_ADD_REG_REG;
+    if (operation == SPU_OP_SUB) return is_const ? SPU_OP_SUB_REG_CONST : SPU_OP_SUB_REG_REG;
+    if (operation == SPU_OP_MUL) return is_const ? SPU_OP_MUL_REG_CONST : SPU_OP_MUL_REG_REG;
+
+    return SPU_OP_UNKNOWN;
+}
+
+static SpuOp FuseCompare(SpuOp push, SpuOp jump) {
+    int is_const = push == SPU_OP_PUSH_CONST;
+
+    if (jump == SPU_OP_JEP)  return is_const ? SPU_OP_JEP_CONST  : SPU_OP_JEP_REG;
+    if (jump == SPU_OP_JNEP) return is_const ? SPU_OP_JNEP_CONST : SPU_OP_JNEP_REG;
+    if (jump == SPU_OP_JGEP) return is_const ? SPU_OP_JGEP_CONST : SPU_OP_JGEP_REG;
+
+    return SPU_OP_UNKNOWN;
+}
+
+/// @brief The superinstruction that starts with the commands (UNKNOWN if there is none)
+static SpuInstr FuseInstrs(const SpuInstr* first, const SpuInstr* second, const SpuInstr* third) {
+    assert(first  != NULL);
+    assert(second != NULL);
+    assert(third  != NULL);
+
+    SpuInstr fused = {SPU_OP_UNKNOWN, first->length + second->length, first->reg, 0, 0};
+
+    int is_push_reg  = first->op  == SPU_OP_PUSH_REG;
+    int is_push_pair = is_push_reg && (second->op == SPU_OP_PUSH_REG || second->op == SPU_OP_PUSH_CONST);
+
+    if (is_push_pair && FuseArithmetic(second->op, third->op) != SPU_OP_UNKNOWN) {
+        fused.op      = FuseArithmetic(second->op, third->op);
+        fused.length += third->length;
+        fused.value   = second->op == SPU_OP_PUSH_CONST ? second->value : second->reg;
+    } else if (first->op == SPU_OP_POP_REG && second->op == SPU_OP_PUSH_REG) {
+        fused.op      = SPU_OP_POP_PUSH_REG;
+        fused.value   = second->reg;
+    } else if (is_push_reg && second->op == SPU_OP_PUSH_REG) {
+        fused.op      = SPU_OP_PUSH_REG_REG;
+        fused.value   = second->reg;
+    } else if ((is_push_reg || first->op == SPU_OP_PUSH_CONST) && FuseCompare(first->op, second->op) != SPU_OP_UNKNOWN) {
+        fused.op      = FuseCompare(first->op, second->op);
+        fused.value   = first->value;
+        fused.target  = second->target;
+    }
+
+    return fused;
+}
+
+/// @brief Replaces the commands that start the sequences, the following addresses are not changed yet when they are read
+static void FuseSuperinstructions(SPU* spu) {
+    assert(spu != NULL);
+
+    SpuInstr* decoded = spu->decoded;
+    size_t       size = spu->cmds_size;
+
+    for (size_t ip = 0; ip < size; ip++) {
+        size_t second = ip     + (size_t) decoded[ip].length;
+        if (second >= size) continue;
+
+        size_t third  = second + (size_t) decoded[second].length;
+        if (third > size) third = size;
+
+        SpuInstr fused = FuseInstrs(&decoded[ip], &decoded[second], &decoded[third]);
+        if (fused.op != SPU_OP_UNKNOWN) decoded[ip] = fused;
+    }
+}
+#endif
+
+/// @brief Fills need and grow from the end of the code: the run from the address is the command and the run after it
+static void ComputeRuns(SPU* spu) {
+    assert(spu != NULL);
+
+    for (size_t ip = spu->cmds_size; ip-- > 0;) {
+        SpuInstr* instr = &spu->decoded[ip];
+        SpuEffect effect = GetEffect(instr->op);
+
+        instr->need = effect.need;
+        instr->grow = effect.delta > 0 ? effect.delta : 0;
+
+        size_t next = ip + (size_t) instr->length;
+        if (SpuIsRunEnd(instr->op) || next >= spu->cmds_size) continue;
+
+        const SpuInstr* rest = &spu->decoded[next];
+        if (rest->need - effect.delta > instr->need) instr->need = rest->need - effect.delta;
+        if (rest->grow + effect.delta > instr->grow) instr->grow = rest->grow + effect.delta;
+    }
+}
+
+/*!
+    @brief Function that decodes the code of the SPU at every address (a jump into the operands runs the same way
+           as the raw words would), the result is kept in spu->decoded
+    \param [out] spu - the pointer on the spu struct
+    @return 1 if the code is decoded, 0 if there is no memory
+*/
+int SpuDecode(SPU* spu) {
+    assert(spu != NULL);
+
+    FREE(spu->decoded);
+
+    spu->decoded = (SpuInstr*) calloc(spu->cmds_size + 1, sizeof(SpuInstr));
+    if (!spu->decoded) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return 0;
+    }
+
+    for (size_t ip = 0; ip < spu->cmds_size; ip++) spu->decoded[ip] = DecodeCmd(spu, (int) ip);
+    spu->decoded[spu->cmds_size] = {SPU_OP_UNKNOWN, 1, 0, 0};
+
+#ifndef SPU_NO_SUPERINSTRUCTIONS
+    FuseSuperinstructions(spu);
+#endif
+    ComputeRuns(spu);
+
+    return 1;
+}
+
+//* ================================== stacks =================================
+//* with SPU_CHECKED_STACKS the operand and call stacks are the guarded Stack (every access is checked),
+//* otherwise they are flat arrays that start in the SPU and move to the heap when a run needs more room;
+//* the limits of a run of the commands are checked once when it is entered
+
+//* the top of the operand stack is cached in tos: TAKE reads the operands, KEEP leaves them on the stack,
+//* DROP removes them, REPLACE puts the result in their place (with the checked stacks they are popped and pushed again)
+
+#ifdef SPU_CHECKED_STACKS
+    #define SPU_PUSH_VALUE_(value)   StackPush(&spu->st, value);
+    #define SPU_TAKE1_(a)            int a = StackPop(&spu->st);
+    #define SPU_TAKE2_(a, b)         int a = StackPop(&spu->st); int b = StackPop(&spu->st);
+    #define SPU_KEEP1_(a)            StackPush(&spu->st, a);
+    #define SPU_KEEP2_(a, b)         StackPush(&spu->st, b); StackPush(&spu->st, a);
+    #define SPU_DROP1_
+    #define SPU_DROP2_
+    #define SPU_REPLACE1_(value)     StackPush(&spu->st, value);
+    #define SPU_REPLACE2_(value)     StackPush(&spu->st, value);
+    #define SPU_SAVE_STACKS_
+    #define SPU_CALLS_               spu->stFunc.data, spu->stFunc.size
+    #define SPU_TOS_                 (spu->st.size ? spu->st.data[spu->st.size - 1] : 0)
+
+    //* the errors of the program are reported as by the flat stacks, the guards catch the damage of the stacks only
+    #define SPU_PUSH_CALL_(address) {                                       \
+        if (spu->stFunc.size == SPU_CALL_DEPTH) {                           \
+            fprintf(SpuMessageStream(spu), RED("SPU CALL STACK OVERFLOW!\n"));        \
+            return SPU_STATUS_ERROR;                                        \
+        }                                                                   \
+        StackPush(&spu->stFunc, address);                                   \
+    }
+
+    #define SPU_POP_CALL_(address) {                                        \
+        if (spu->stFunc.size == 0) {                                        \
+            fprintf(SpuMessageStream(spu), RED("SPU CALL STACK IS EMPTY!\n"));        \
+            return SPU_STATUS_ERROR;                                        \
+        }                                                                   \
+        (address) = StackPop(&spu->stFunc);                                 \
+    }
+
+    #define SPU_CHECK_RUN_ {                                                \
+        if (spu->st.size < (size_t) instr->need) {                          \
+            fprintf(SpuMessageStream(spu), RED("SPU STACK IS EMPTY!\n"));             \
+            return SPU_STATUS_ERROR;                                        \
+        }                                                                   \
+        if (SPU_STACK_SIZE - spu->st.size < (size_t) instr->grow) {         \
+            fprintf(SpuMessageStream(spu), RED("SPU STACK OVERFLOW!\n"));             \
+            return SPU_STATUS_ERROR;                                        \
+        }                                                                   \
+    }
+#else
+    //* top points to the slot for the spill of tos, vm_stack[0] gets the garbage tos of the empty stack
+    #define SPU_PUSH_VALUE_(value)   { *top++ = tos; tos = (value); }
+    #define SPU_TAKE1_(a)            int a = tos;
+    #define SPU_TAKE2_(a, b)         int a = tos; int b = top[-1];
+    #define SPU_KEEP1_(a)
+    #define SPU_KEEP2_(a, b)
+    #define SPU_DROP1_               tos = *--top;
+    #define SPU_DROP2_               { tos = top[-2]; top -= 2; }
+    #define SPU_REPLACE1_(value)     tos = (value);
+    #define SPU_REPLACE2_(value)     { tos = (value); top--; }
+    #define SPU_SAVE_STACKS_         { spu->vm_top = top; spu->vm_tos = tos; spu->vm_calls_top = calls_top; }
+    #define SPU_CALLS_               spu->vm_calls, (size_t) (calls_top - spu->vm_calls)
+    #define SPU_TOS_                 (top == spu->vm_stack ? 0 : tos)
+
+    #define SPU_PUSH_CALL_(address) {                                       \
+        if (calls_top == calls_end) {                                       \
+            if (!SpuGrowCalls(spu, &calls_top)) return SPU_STATUS_ERROR;    \
+            calls_end = spu->vm_calls + spu->vm_calls_size;                 \
+        }                                                                   \
+        *calls_top++ = (address);                                           \
+    }
+
+    #define SPU_POP_CALL_(address) {                                        \
+        if (calls_top == spu->vm_calls) {                                   \
+            fprintf(SpuMessageStream(spu), RED("SPU CALL STACK IS EMPTY!\n"));        \
+            return SPU_STATUS_ERROR;                                        \
+        }                                                                   \
+        (address) = *--calls_top;                                           \
+    }
+
+    #define SPU_CHECK_RUN_ {                                                \
+        if (top - spu->vm_stack < instr->need) {                            \
+            fprintf(SpuMessageStream(spu), RED("SPU STACK IS EMPTY!\n"));             \
+            return SPU_STATUS_ERROR;                                        \
+        }                                                                   \
+        if (stack_end - top < instr->grow) {                                \
+            if (!SpuGrowStack(spu, &top, (size_t) instr->grow))             \
+                return SPU_STATUS_ERROR;                                    \
+            stack_end = spu->vm_stack + spu->vm_stack_size;                 \
+        }                                                                   \
+    }
+
+/// @brief Puts the empty flat stacks into the inline buffers of the SPU
+static void SpuInitStacks(SPU* spu) {
+    assert(spu != NULL);
+
+    if (!spu->vm_stack) {
+        spu->vm_stack      = spu->vm_inline_stack;
+        spu->vm_stack_size = SPU_INLINE_STACK_SIZE;
+    }
+    if (!spu->vm_calls) {
+        spu->vm_calls      = spu->vm_inline_calls;
+        spu->vm_calls_size = SPU_INLINE_CALL_DEPTH;
+    }
+}
+
+/// @brief Moves the flat stack to the bigger buffer (the inline one is left for the heap), NULL if there is no memory
+static int* SpuGrowFlat(int* data, const int* inline_data, size_t used, size_t* size, size_t needed, size_t limit) {
+    assert(size != NULL);
+
+    size_t new_size = *size;
+    while (new_size < needed) new_size *= 2;
+    if (new_size > limit) new_size = limit;
+
+    int* grown = NULL;
+    if (data == inline_data) {
+        grown = (int*) malloc(new_size * sizeof(int));
+        if (grown) memcpy(grown, data, used * sizeof(int));
+    }
+    else grown = (int*) realloc(data, new_size * sizeof(int));
+
+    if (!grown) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return NULL;
+    }
+
+    *size = new_size;
+
+    return grown;
+}
+
+/// @brief Grows the operand stack for the run that pushes grow elements above top (top is moved with the stack)
+static int SpuGrowStack(SPU* spu, int** top, size_t grow) {
+    assert(spu != NULL);
+    assert(top != NULL);
+
+    size_t used = (size_t) (*top - spu->vm_stack);
+    if (used + grow > SPU_STACK_SIZE) {
+        fprintf(SpuMessageStream(spu), RED("SPU STACK OVERFLOW!\n"));
+        return 0;
+    }
+
+    int* grown = SpuGrowFlat(spu->vm_stack, spu->vm_inline_stack, used, &spu->vm_stack_size, used + grow,
+                             SPU_STACK_SIZE);
+    if (!grown) return 0;
+
+    spu->vm_stack = grown;
+    *top = grown + used;
+
+    return 1;
+}
+
+/// @brief Grows the call stack that is full (calls_top is moved with the stack)
+static int SpuGrowCalls(SPU* spu, int** calls_top) {
+    assert(spu       != NULL);
+    assert(calls_top != NULL);
+
+    size_t used = (size_t) (*calls_top - spu->vm_calls);
+    if (used == SPU_CALL_DEPTH) {
+        fprintf(SpuMessageStream(spu), RED("SPU CALL STACK OVERFLOW!\n"));
+        return 0;
+    }
+
+    int* grown = SpuGrowFlat(spu->vm_calls, spu->vm_inline_calls, used, &spu->vm_calls_size, used + 1, SPU_CALL_DEPTH);
+    if (!grown) return 0;
+
+    spu->vm_calls = grown;
+    *calls_top = grown + used;
+
+    return 1;
+}
+#endif
+
+//* ================================== dispatch =================================
+//* with GCC labels as values every handler jumps to the next one through the table (direct threading),
+//* -DSPU_SWITCH_DISPATCH or another compiler gives the portable switch in the loop
+#if defined(__GNUC__) && !defined(SPU_SWITCH_DISPATCH)
+    #define SPU_THREADED_DISPATCH
+#endif
+
+/// @brief The decoded command at spu->ip (UNKNOWN out of the code)
+#define SPU_FETCH_ (&decoded[((size_t) spu->ip < cmds_size) ? (size_t) spu->ip : cmds_size])
+
+#ifdef SPU_THREADED_DISPATCH
+    #define SPU_HANDLER_(op) op_##op:
+    #define SPU_DISPATCH_    goto *dispatch[instr->op];
+#else
+    #define SPU_HANDLER_(op) case SPU_OP_##op:
+    #define SPU_DISPATCH_    continue;
+#endif
+
+/// @brief Goes to the next command of the run
+#define SPU_NEXT_      { instr = SPU_FETCH_; SPU_PROFILE_ SPU_TRACE_ SPU_DISPATCH_ }
+
+/// @brief Goes to the first command of the new run, the budget is spent by the runs (the yield is at the run start)
+#define SPU_NEXT_RUN_  { instr = SPU_FETCH_; SPU_CHECK_BUDGET_ SPU_CHECK_RUN_ SPU_PROFILE_ SPU_TRACE_ SPU_DISPATCH_ }
+
+//* -DSPU_PROFILE counts every command before it runs, samples the call stack and writes the reports on HLT
+//* (see SpuProfile.h)
+#ifdef SPU_PROFILE
+    #define SPU_PROFILE_ {                                                                                  \
+        if (SpuProfileCount(profile, instr->op, spu->ip)) SpuProfileSampleStack(profile, spu, SPU_CALLS_);  \
+    }
+    #define SPU_PROFILE_CALL_(target) SpuProfileCall(profile, target);
+    #define SPU_PROFILE_REPORT_ {                                                                           \
+        SpuProfileReport(profile, decoded, SPU_PROFILE_TEXT_FILENAME, SPU_PROFILE_JSON_FILENAME);           \
+        SpuProfileWriteFolded(profile, SPU_PROFILE_FOLDED_FILENAME);                                        \
+    }
+#else
+    #define SPU_PROFILE_
+    #define SPU_PROFILE_CALL_(target)
+    #define SPU_PROFILE_REPORT_
+#endif
+
+//* -DSPU_TRACE records every command to the ring before it runs, CPUResume dumps the ring when the program ends
+//* (see SpuTrace.h)
+#ifdef SPU_TRACE
+    #define SPU_TRACE_ SpuTraceRecord(trace, spu->ip, instr->op, SPU_TOS_);
+#else
+    #define SPU_TRACE_
+#endif
+
+#define SPU_CHECK_BUDGET_                                                   \
+    if (--budget < 0) {                                                     \
+        SPU_SAVE_STACKS_                                                    \
+        return SPU_STATUS_BUDGET;                                           \
+    }
+
+/// @brief Conditional jump to the decoded target, otherwise the command is skipped
+#define SPU_JUMP_IF_(condition) {                                           \
+    if (condition) spu->ip = instr->target;                                 \
+    else           spu->ip += instr->length;                                \
+}
+
+/// @brief Checks the address of RAM computed at run time, -DSPU_UNCHECKED_RAM drops the check for the programs
+///        that are known to stay in RAM (the constant addresses are checked by the decoder anyway)
+#ifdef SPU_UNCHECKED_RAM
+    #define SPU_CHECK_RAM_(address)
+#else
+    #define SPU_CHECK_RAM_(address)                                         \
+        if ((address) >= ram_size) {                                        \
+            fprintf(SpuMessageStream(spu), RED("RAM ACCESS ERROR!\n"));               \
+            return SPU_STATUS_ERROR;                                        \
+        }
+#endif
+
+/// @brief Pushes the operand value scaled, the command is done
+#define SPU_PUSH_(value) {                                                  \
+    SPU_PUSH_VALUE_((value) * CALC_ACCURACY)                                \
+    spu->ip += instr->length;                                               \
+    SPU_NEXT_                                                               \
+}
+
+/// @brief Pops the value unscaled into the location, the command is done
+#define SPU_POP_(location) {                                                \
+    SPU_TAKE1_(value_)                                                      \
+    SPU_DROP1_                                                              \
+    (location) = value_ / CALC_ACCURACY;                                    \
+    spu->ip += instr->length;                                               \
+    SPU_NEXT_                                                               \
+}
+
+/// @brief Pushes the word of RAM at the address computed at run time
+#define SPU_PUSH_MEM_(address) {                                            \
+    size_t address_ = (size_t) (address);                                   \
+    SPU_CHECK_RAM_(address_)                                                \
+    SPU_PUSH_(ram[address_])                                                \
+}
+
+/// @brief Pops into the word of RAM at the address computed at run time
+#define SPU_POP_MEM_(address) {                                             \
+    size_t address_ = (size_t) (address);                                   \
+    SPU_CHECK_RAM_(address_)                                                \
+    SPU_POP_(ram[address_])                                                 \
+}
+
+/// @brief PUSH reg; PUSH operand; operation: the result is pushed
+#define SPU_ARITHMETIC_(operand, result) {                                  \
+    int b = regs[instr->reg] * CALC_ACCURACY;                               \
+    int a = (operand) * CALC_ACCURACY;                                      \
+    SPU_PUSH_VALUE_(result)                                                 \
+    spu->ip += instr->length;                                               \
+    SPU_NEXT_                                                               \
+}
+
+/// @brief PUSH operand; JEP (JNEP, JGEP): the operand is compared with the top that is dropped
+#define SPU_COMPARE_(operand, condition) {                                  \
+    int a = (operand) * CALC_ACCURACY;                                      \
+    SPU_TAKE1_(b)                                                           \
+    SPU_DROP1_                                                              \
+    SPU_JUMP_IF_(condition)                                                 \
+    SPU_NEXT_RUN_                                                           \
+}
+
 /*!
     @brief Function that launched processor
     \param [in] spu - the pointer on SPU struct
@@ -80,228 +654,354 @@ int* GetArg (SPU* spu) {
 void CPUWork(SPU* spu) {
     assert(spu != NULL);
 
-    int DoFlag = 1;
+    CPUResume(spu, SPU_NO_BUDGET);
+}
 
-    while (DoFlag) {
-        switch(spu->cmds[ spu->ip ]) {
-            case PUSH: {
-                int* push_elem_ptr = GetArg(spu);
-                StackPush(spu->st, *push_elem_ptr * CALC_ACCURACY);
-                (spu->ip)++;
-                break;
-            }
+/// @brief The interpreter of CPUResume
+static SpuStatus SpuExecute(SPU* spu, long budget) {
+    assert(spu != NULL);
 
-            case POP: {
-                int* pop_ptr = GetArg(spu);
-                *pop_ptr = StackPop(spu->st) / CALC_ACCURACY;
-                (spu->ip)++;
-                break;
-            }
+    if (!spu->decoded && !SpuDecode(spu)) return SPU_STATUS_ERROR;
+
+    const SpuInstr* decoded = spu->decoded;
+    const size_t  cmds_size = spu->cmds_size;
+    int*               regs = spu->regs;
+    int*                ram = spu->ram;
+#ifndef SPU_UNCHECKED_RAM
+    const size_t   ram_size = spu->ram_size;
+#endif
+
+#ifndef SPU_CHECKED_STACKS
+    SpuInitStacks(spu);
+
+    int*             top = spu->vm_top       ? spu->vm_top       : spu->vm_stack;
+    int              tos = spu->vm_tos;
+    const int* stack_end = spu->vm_stack + spu->vm_stack_size;
+    int*       calls_top = spu->vm_calls_top ? spu->vm_calls_top : spu->vm_calls;
+    const int* calls_end = spu->vm_calls + spu->vm_calls_size;
+
+    //* the saved state is valid until the next yield only
+    spu->vm_top       = NULL;
+    spu->vm_calls_top = NULL;
+#endif
+
+#ifdef SPU_PROFILE
+    if (!spu->profile) spu->profile = SpuProfileCreate(cmds_size);
+    if (!spu->profile) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return SPU_STATUS_ERROR;
+    }
 
-            case ADD: {
-                StackPush(spu->st, StackPop(spu->st) + StackPop(spu->st));
-                (spu->ip)++;
-                break;
-            }
+    SpuProfile* profile = spu->profile;
+#endif
 
-            case SUB: {
-                int a = StackPop(spu->st);
-                StackPush(spu->st, StackPop(spu->st) - a);
-                (spu->ip)++;
-                break;
-            }
+#ifdef SPU_TRACE
+    if (!spu->trace) spu->trace = SpuTraceCreate();
+    if (!spu->trace) {
+        fprintf(stderr, RED("MEMORY ERROR!\n"));
+        return SPU_STATUS_ERROR;
+    }
 
-            case DIV: {
-                int a = StackPop(spu->st);
-                if (a != 0)
-                    StackPush(spu->st, CALC_ACCURACY * StackPop(spu->st) / a);
-                else {
-                    printf(RED("ERROR! DIVISION BY ZERO!!!\n"));
-                    DoFlag = 0;
-                }
-                (spu->ip)++;
-                break;
-            }
+    SpuTrace* trace = spu->trace;
+#endif
+
+    const SpuInstr* instr = SPU_FETCH_;
+    SPU_CHECK_RUN_
+    SPU_PROFILE_
+    SPU_TRACE_
+
+#ifdef SPU_THREADED_DISPATCH
+    static const void* const dispatch[SPU_OPS_COUNT] = {
+        #define DEF_SPU_OP_(op) &&op_##op,
+        #include "spu_ops.h"
+        #undef DEF_SPU_OP_
+    };
+
+    SPU_DISPATCH_
+#else
+    for (;;) switch (instr->op)
+#endif
+    {
+        SPU_HANDLER_(PUSH_REG)           SPU_PUSH_(regs[instr->reg])
+        SPU_HANDLER_(PUSH_CONST)         SPU_PUSH_(regs[XX] = instr->value)
+        SPU_HANDLER_(PUSH_REG_CONST)     SPU_PUSH_(regs[XX] = regs[instr->reg] + instr->value)
+        SPU_HANDLER_(PUSH_MEM_REG)       SPU_PUSH_MEM_(regs[instr->reg])
+        SPU_HANDLER_(PUSH_MEM_CONST)     SPU_PUSH_(ram[regs[XX] = instr->value])
+        SPU_HANDLER_(PUSH_MEM_REG_CONST) SPU_PUSH_MEM_(regs[XX] = regs[instr->reg] + instr->value)
+
+        SPU_HANDLER_(POP_REG)            SPU_POP_(regs[instr->reg])
+        SPU_HANDLER_(POP_XX)             SPU_POP_(regs[XX])
+        SPU_HANDLER_(POP_MEM_REG)        SPU_POP_MEM_(regs[instr->reg])
+        SPU_HANDLER_(POP_MEM_CONST)      SPU_POP_(ram[regs[XX] = instr->value])
+        SPU_HANDLER_(POP_MEM_REG_CONST)  SPU_POP_MEM_(regs[XX] = regs[instr->reg] + instr->value)
+
+        SPU_HANDLER_(PUSH_ARG) {
+            int* push_elem_ptr = GetArg(spu);
+            if (!push_elem_ptr) return SPU_STATUS_ERROR;
+            SPU_PUSH_VALUE_(*push_elem_ptr * CALC_ACCURACY)
+            (spu->ip)++;
+            SPU_NEXT_RUN_
+        }
 
-            case MUL: {
-                StackPush(spu->st, StackPop(spu->st) * StackPop(spu->st) / CALC_ACCURACY);
-                (spu->ip)++;
-                break;
-            }
+        SPU_HANDLER_(POP_ARG) {
+            int* pop_ptr = GetArg(spu);
+            if (!pop_ptr) return SPU_STATUS_ERROR;
+            SPU_TAKE1_(a)
+            SPU_DROP1_
+            *pop_ptr = a / CALC_ACCURACY;
+            (spu->ip)++;
+            SPU_NEXT_RUN_
+        }
 
-            case IN: {
-                int a = 0;
-                printf(YELLOW("Enter a number: ")); scanf("%d", &a);
-                StackPush(spu->st, a * CALC_ACCURACY);
-                (spu->ip)++;
-                break;
-            }
+        SPU_HANDLER_(ADD) {
+            SPU_TAKE2_(a, b)
+            SPU_REPLACE2_(b + a)
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-            case OUT: {
-                printf(GREEN("RESULT: %lg\n"), (double) StackPop(spu->st) / CALC_ACCURACY);
-                (spu->ip)++;
-                break;
-            }
+        SPU_HANDLER_(SUB) {
+            SPU_TAKE2_(a, b)
+            SPU_REPLACE2_(b - a)
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-            case HLT: {
-                DoFlag = 0;
-                break;
+        SPU_HANDLER_(DIV) {
+            SPU_TAKE2_(a, b)
+            if (a == 0) {
+                fprintf(SpuMessageStream(spu), RED("ERROR! DIVISION BY ZERO!!!\n"));
+                return SPU_STATUS_ERROR;
             }
+            SPU_REPLACE2_(CALC_ACCURACY * b / a)
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-            case JMP: {
-                int next_ip = spu->cmds[ ++(spu->ip) ];
-                spu->ip = next_ip;
-                break;
-            }
+        SPU_HANDLER_(MUL) {
+            SPU_TAKE2_(a, b)
+            SPU_REPLACE2_(b * a / CALC_ACCURACY)
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-            case CALL: {
-                StackPush(spu->stFunc, spu->ip + 2);
-                int next_ip = spu->cmds[ ++(spu->ip) ];
-                spu->ip = next_ip;
-                break;
+        SPU_HANDLER_(IN) {
+            if (!SpuInputReady(spu)) {
+                SPU_SAVE_STACKS_
+                return SPU_STATUS_INPUT;
             }
+            SPU_PUSH_VALUE_(SpuIn(spu) * CALC_ACCURACY)
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-            case RET: {
-                int next_ip = StackPop(spu->stFunc);
-                spu->ip = next_ip;
-                break;
-            }
+        SPU_HANDLER_(OUT) {
+            SPU_TAKE1_(a)
+            SPU_DROP1_
+            SpuOut(spu, a);
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-            case SQRT: {
-                int a = StackPop(spu->st) / CALC_ACCURACY;
-                if (a >= 0) {
-                    StackPush(spu->st, (int)sqrt(a) * CALC_ACCURACY);
-                } else {
-                    printf(RED("SQRT ERROR!\n"));
-                    DoFlag = 0;
-                }
-                (spu->ip)++;
-                break;
-            }
+        SPU_HANDLER_(HLT) {
+            if (spu->raw_io) SpuFlushOutput(spu);
+            SPU_PROFILE_REPORT_
+            return SPU_STATUS_HALTED;
+        }
 
-            case SQR: {
-                int a = StackPop(spu->st) / CALC_ACCURACY;
-                StackPush(spu->st, a * a * CALC_ACCURACY);
-                (spu->ip)++;
-                break;
-            }
+        SPU_HANDLER_(JMP) {
+            spu->ip = instr->target;
+            SPU_NEXT_RUN_
+        }
 
-            case MOD: {
-                int a = StackPop(spu->st) / CALC_ACCURACY;
-                int b = StackPop(spu->st) / CALC_ACCURACY;
-
-                if (a != 0) {
-                    StackPush(spu->st, (b % a) * CALC_ACCURACY);
-                } else {
-                    printf(RED("ZERO DIVISION!\n"));
-                    DoFlag = 0;
-                }
-                (spu->ip)++;
-                break;
-            }
+        SPU_HANDLER_(CALL) {
+            SPU_PROFILE_CALL_(instr->target)
+            SPU_PUSH_CALL_(spu->ip + instr->length)
+            spu->ip = instr->target;
+            SPU_NEXT_RUN_
+        }
 
-            case IDIV: {
-                int a = StackPop(spu->st) / CALC_ACCURACY;
-                int b = StackPop(spu->st) / CALC_ACCURACY;
-
-                if (a != 0) {
-                    StackPush(spu->st, (b / a) * CALC_ACCURACY);
-                } else {
-                    printf(RED("ZERO DIVISION!\n"));
-                    DoFlag = 0;
-                }
-                (spu->ip)++;
-                break;
+        SPU_HANDLER_(RET) {
+            int next_ip = 0;
+            SPU_POP_CALL_(next_ip)
+            spu->ip = next_ip;
+            SPU_NEXT_RUN_
+        }
+
+        SPU_HANDLER_(SQRT) {
+            SPU_TAKE1_(value)
+            int a = value / CALC_ACCURACY;
+            if (a < 0) {
+                fprintf(SpuMessageStream(spu), RED("SQRT ERROR!\n"));
+                return SPU_STATUS_ERROR;
             }
+            SPU_REPLACE1_((int)sqrt(a) * CALC_ACCURACY)
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-            case JNE: {
-                int a = StackPop(spu->st);
-                int b = StackPop(spu->st);
+        SPU_HANDLER_(SQR) {
+            SPU_TAKE1_(value)
+            int a = value / CALC_ACCURACY;
+            SPU_REPLACE1_(a * a * CALC_ACCURACY)
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-                if (a != b) {
-                    int next_ip = spu->cmds[ ++(spu->ip) ];
-                    spu->ip = next_ip;
-                } else spu->ip += 2;
+        SPU_HANDLER_(MOD) {
+            SPU_TAKE2_(value_a, value_b)
+            int a = value_a / CALC_ACCURACY;
+            int b = value_b / CALC_ACCURACY;
 
-                StackPush(spu->st, b);
-                StackPush(spu->st, a);
-                break;
+            if (a == 0) {
+                fprintf(SpuMessageStream(spu), RED("ZERO DIVISION!\n"));
+                return SPU_STATUS_ERROR;
             }
+            SPU_REPLACE2_((b % a) * CALC_ACCURACY)
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-            case JGE: {
-                int a = StackPop(spu->st);
-                int b = StackPop(spu->st);
-
-                if (a >= b) {
-                    int next_ip = spu->cmds[ ++(spu->ip) ];
-                    spu->ip = next_ip;
-                } else spu->ip += 2;
+        SPU_HANDLER_(IDIV) {
+            SPU_TAKE2_(value_a, value_b)
+            int a = value_a / CALC_ACCURACY;
+            int b = value_b / CALC_ACCURACY;
 
-                StackPush(spu->st, b);
-                StackPush(spu->st, a);
-                break;
+            if (a == 0) {
+                fprintf(SpuMessageStream(spu), RED("ZERO DIVISION!\n"));
+                return SPU_STATUS_ERROR;
             }
+            SPU_REPLACE2_((b / a) * CALC_ACCURACY)
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-            case JLZ: {
-                int a = StackPop(spu->st);
+        SPU_HANDLER_(JNE) {
+            SPU_TAKE2_(a, b)
+            SPU_JUMP_IF_(a != b)
+            SPU_KEEP2_(a, b)
+            SPU_NEXT_RUN_
+        }
 
-                if (a < 0) {
-                    int next_ip = spu->cmds[ ++(spu->ip) ];
-                    spu->ip = next_ip;
-                } else spu->ip += 2;
+        SPU_HANDLER_(JGE) {
+            SPU_TAKE2_(a, b)
+            SPU_JUMP_IF_(a >= b)
+            SPU_KEEP2_(a, b)
+            SPU_NEXT_RUN_
+        }
 
-                StackPush(spu->st, a);
-                break;
-            }
+        SPU_HANDLER_(JE) {
+            SPU_TAKE2_(a, b)
+            SPU_JUMP_IF_(a == b)
+            SPU_KEEP2_(a, b)
+            SPU_NEXT_RUN_
+        }
 
-            case JGZ: {
-                int a = StackPop(spu->st);
+        SPU_HANDLER_(JLZ) {
+            SPU_TAKE1_(a)
+            SPU_JUMP_IF_(a < 0)
+            SPU_KEEP1_(a)
+            SPU_NEXT_RUN_
+        }
 
-                if (a > 0) {
-                    int next_ip = spu->cmds[ ++(spu->ip) ];
-                    spu->ip = next_ip;
-                } else spu->ip += 2;
+        SPU_HANDLER_(JGZ) {
+            SPU_TAKE1_(a)
+            SPU_JUMP_IF_(a > 0)
+            SPU_KEEP1_(a)
+            SPU_NEXT_RUN_
+        }
 
-                StackPush(spu->st, a);
-                break;
-            }
+        SPU_HANDLER_(JEP) {
+            SPU_TAKE2_(a, b)
+            SPU_DROP2_
+            SPU_JUMP_IF_(a == b)
+            SPU_NEXT_RUN_
+        }
 
-            case DRAW: {
-                for (size_t i = 0; i < RAM_SIZE; i++) {
-                    if (spu->ram[i] != 0) {
-                        printf(GREEN("%c "), spu->ram[i]);
-                    } else {
-                        printf("· ");
-                    }
-
-                    if ((i + 1) % (size_t)sqrt(RAM_SIZE) == 0) {
-                        printf("\n");
-                    }
-                }
-                (spu->ip)++;
-                break;
-            }
+        SPU_HANDLER_(JNEP) {
+            SPU_TAKE2_(a, b)
+            SPU_DROP2_
+            SPU_JUMP_IF_(a != b)
+            SPU_NEXT_RUN_
+        }
 
-            case JE: {
-                int a = StackPop(spu->st);
-                int b = StackPop(spu->st);
+        SPU_HANDLER_(JGEP) {
+            SPU_TAKE2_(a, b)
+            SPU_DROP2_
+            SPU_JUMP_IF_(a >= b)
+            SPU_NEXT_RUN_
+        }
 
-                if (a == b) {
-                    int next_ip = spu->cmds[ ++(spu->ip) ];
-                    spu->ip = next_ip;
-                } else spu->ip += 2;
+        SPU_HANDLER_(DRAW) {
+            SpuDraw(spu);
+            (spu->ip)++;
+            SPU_NEXT_
+        }
 
-                StackPush(spu->st, b);
-                StackPush(spu->st, a);
-                break;
-            }
+        //* superinstructions: b is the value pushed first, a is the second one (the top)
 
-            default: {
-                printf("%d %d ", spu->ip, spu->cmds[ spu->ip ]);
-                printf(RED("UNKNOWN CODE!!!\n"));
-                DoFlag = 0;
-                break;
-            }
+        SPU_HANDLER_(POP_PUSH_REG) {
+            SPU_TAKE1_(a)
+            regs[instr->reg] = a / CALC_ACCURACY;
+            SPU_REPLACE1_(regs[instr->value] * CALC_ACCURACY)
+            spu->ip += instr->length;
+            SPU_NEXT_
+        }
+
+        SPU_HANDLER_(PUSH_REG_REG) {
+            SPU_PUSH_VALUE_(regs[instr->reg]   * CALC_ACCURACY)
+            SPU_PUSH_VALUE_(regs[instr->value] * CALC_ACCURACY)
+            spu->ip += instr->length;
+            SPU_NEXT_
         }
+
+        SPU_HANDLER_(ADD_REG_CONST) SPU_ARITHMETIC_(regs[XX] = instr->value,           b + a)
+        SPU_HANDLER_(SUB_REG_CONST) SPU_ARITHMETIC_(regs[XX] = instr->value,           b - a)
+        SPU_HANDLER_(MUL_REG_CONST) SPU_ARITHMETIC_(regs[XX] = instr->value,           b * a / CALC_ACCURACY)
+        SPU_HANDLER_(ADD_REG_REG)   SPU_ARITHMETIC_(regs[instr->value],                b + a)
+        SPU_HANDLER_(SUB_REG_REG)   SPU_ARITHMETIC_(regs[instr->value],                b - a)
+        SPU_HANDLER_(MUL_REG_REG)   SPU_ARITHMETIC_(regs[instr->value],                b * a / CALC_ACCURACY)
+
+        SPU_HANDLER_(JEP_REG)       SPU_COMPARE_(regs[instr->reg],                     a == b)
+        SPU_HANDLER_(JNEP_REG)      SPU_COMPARE_(regs[instr->reg],                     a != b)
+        SPU_HANDLER_(JGEP_REG)      SPU_COMPARE_(regs[instr->reg],                     a >= b)
+        SPU_HANDLER_(JEP_CONST)     SPU_COMPARE_(regs[XX] = instr->value,              a == b)
+        SPU_HANDLER_(JNEP_CONST)    SPU_COMPARE_(regs[XX] = instr->value,              a != b)
+        SPU_HANDLER_(JGEP_CONST)    SPU_COMPARE_(regs[XX] = instr->value,              a >= b)
+
+        SPU_HANDLER_(UNKNOWN) {
+            fprintf(SpuMessageStream(spu), "%d %d ", spu->ip, FetchCmd(spu, spu->ip));
+            fprintf(SpuMessageStream(spu), RED("UNKNOWN CODE!!!\n"));
+            return SPU_STATUS_ERROR;
+        }
+
+#ifndef SPU_THREADED_DISPATCH
+        default: {
+            fprintf(SpuMessageStream(spu), "%d %d ", spu->ip, FetchCmd(spu, spu->ip));
+            fprintf(SpuMessageStream(spu), RED("UNKNOWN CODE!!!\n"));
+            return SPU_STATUS_ERROR;
+        }
+#endif
     }
-}
\ No newline at end of file
+}
+
+/*!
+    @brief Function that runs the processor from spu->ip until HLT, an error, the end of the budget or IN
+           that waits for the input queue (the stacks are kept in the SPU then and the next call continues)
+    \param [in]    spu - the pointer on SPU struct
+    \param [in] budget - count of the runs (the commands between the jumps) before the yield
+    @return The state of the SPU
+*/
+SpuStatus CPUResume(SPU* spu, long budget) {
+    assert(spu != NULL);
+
+    SpuStatus status = SpuExecute(spu, budget);
+
+#ifdef SPU_TRACE
+    //* the yields keep the ring, it is dumped when the program ends
+    if (spu->trace && (status == SPU_STATUS_HALTED || status == SPU_STATUS_ERROR))
+        SpuTraceDump(spu->trace, SPU_TRACE_FILENAME);
+#endif
+
+    return status;
+}